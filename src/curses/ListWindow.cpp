@@ -13,19 +13,12 @@ ListWindow::ListWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t he
 void ListWindow::DrawContent() {
     Window::DrawContent();
 
-    for (uint32_t i = 0; i < GetWidth(); i++) {
-        for (uint32_t j = 0; j < GetHeight(); j++) {
-            PrintCharAt(i, j, ' ');
-        }
-    }
-
-    for (uint32_t i = 0; i + m_scrollOffset < m_items.size() && i < GetHeight(); i++) {
-        if (i == m_highlight) {
-            EnableAttribute(A_REVERSE);
-            PrintStringAt(0, i, m_items[i + m_scrollOffset].c_str());
-            DisableAttribute(A_REVERSE);
+    // Lines, that have not changed since the last frame, are skipped by PrintLineAt()
+    for (uint32_t i = 0; i < GetHeight(); i++) {
+        if (i + m_scrollOffset < m_items.size()) {
+            PrintLineAt(i, m_items[i + m_scrollOffset].c_str(), i == m_highlight ? A_REVERSE : A_NORMAL);
         } else {
-            PrintStringAt(0, i, m_items[i + m_scrollOffset].c_str());
+            PrintLineAt(i, "");
         }
     }
 }
@@ -54,7 +47,7 @@ void ListWindow::HandleKey(int c) {
 
     Window::HandleKey(c);
 
-    WindowManager::GetInstance()->RequestRefresh();
+    Invalidate();
 }
 
 }
\ No newline at end of file
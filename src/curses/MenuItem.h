@@ -28,6 +28,9 @@ namespace Curses {
 /**
  * An item used in MenuWindows.
  *
+ * The MenuWindow copies the item and its subitems into its own compact representation, when it is added.
+ * Menus with many items should rather be built with MenuWindow::AddItem(const char*, void*, bool).
+ *
  * @author Fabian Ruhland, Fabian.Ruhland@hhu.de
  * @date May 2018
  */
@@ -35,6 +38,8 @@ class MenuItem {
 
 public:
 
+    friend class MenuWindow;
+
     /**
      * Constructor.
      *
@@ -16,70 +16,346 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
 #include "WindowManager.h"
 #include "MenuWindow.h"
 
 namespace Curses {
 
+const uint32_t MenuWindow::NONE;
+const uint32_t MenuWindow::ROOT;
+const uint8_t MenuWindow::FLAG_EXPANDED;
+const uint8_t MenuWindow::FLAG_MARKED;
+const uint8_t MenuWindow::FLAG_LAZY;
+
 MenuWindow::MenuWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, const char *title) :
-        ListWindow(posX, posY, width, height, title) {
+        ListWindow(posX, posY, width, height, title),
+        m_nodeIndex(64, NONE),
+        m_indexedNodeCount(0),
+        m_isIndexValid(true),
+        m_searchOrigin(nullptr),
+        m_isSearching(false) {
+    m_nodes.push_back(Node{nullptr, StoreName(""), NONE, NONE, NONE, NONE, NONE, NONE, FLAG_EXPANDED});
+}
+
+void MenuWindow::AddItem(MenuItem item) {
+    CreateNodes(ROOT, item);
+    m_isIndexValid = false;
+
+    Invalidate();
+}
+
+void MenuWindow::AddItem(const char *name, void *data, bool hasSubitems) {
+    CreateNode(ROOT, name, data, NONE, hasSubitems ? FLAG_LAZY : 0);
+    m_isIndexValid = false;
+
+    Invalidate();
+}
+
+bool MenuWindow::AddSubitem(const void *parentData, const char *name, void *data) {
+    uint32_t parent = FindNode(parentData);
+
+    if (parent == NONE) {
+        return false;
+    }
+
+    if (!(m_nodes[parent].flags & FLAG_LAZY)) {
+        CreateNode(parent, name, data, NONE, 0);
+
+        // The rows only change, if the parent is expanded
+        if (m_nodes[parent].flags & FLAG_EXPANDED) {
+            m_isIndexValid = false;
+        }
+
+        Invalidate();
+    }
+
+    return true;
+}
+
+bool MenuWindow::SetName(const void *data, const char *name) {
+    uint32_t node = FindNode(data);
+
+    if (node == NONE) {
+        return false;
+    }
+
+    m_nodes[node].name = StoreName(name);
+
+    Invalidate();
+
+    return true;
+}
+
+bool MenuWindow::RemoveItem(const void *data) {
+    uint32_t node = FindNode(data);
+
+    if (node == NONE) {
+        return false;
+    }
+
+    Node &removed = m_nodes[node];
+    Node &parent = m_nodes[removed.parent];
+
+    (removed.previous != NONE ? m_nodes[removed.previous].next : parent.firstChild) = removed.next;
+    (removed.next != NONE ? m_nodes[removed.next].previous : parent.lastChild) = removed.previous;
+
+    // An item without subitems cannot be expanded
+    if (parent.firstChild == NONE && removed.parent != ROOT) {
+        parent.flags &= ~FLAG_EXPANDED;
+    }
+
+    ReleaseNode(node);
+    m_isIndexValid = false;
+
+    Invalidate();
+
+    return true;
+}
+
+void MenuWindow::SetMarked(const std::function<bool(const void*)> &isMarked) {
+    for (uint32_t node = m_nodes[ROOT].firstChild; node != NONE; node = m_nodes[node].next) {
+        SetMarked(node, isMarked);
+    }
+
+    Invalidate();
+}
+
+bool MenuWindow::SetMarked(uint32_t node, const std::function<bool(const void*)> &isMarked) {
+    bool isChildMarked = false;
+
+    // The children are always visited, so that all of them are updated
+    for (uint32_t child = m_nodes[node].firstChild; child != NONE; child = m_nodes[child].next) {
+        isChildMarked = SetMarked(child, isMarked) || isChildMarked;
+    }
+
+    if (isChildMarked || isMarked(m_nodes[node].data)) {
+        m_nodes[node].flags |= FLAG_MARKED;
+    } else {
+        m_nodes[node].flags &= ~FLAG_MARKED;
+    }
+
+    return (m_nodes[node].flags & FLAG_MARKED) != 0;
+}
+
+void *MenuWindow::GetSelectedData() {
+    UpdateIndex();
+
+    return m_rows.empty() ? nullptr : m_nodes[m_rows[m_highlight + m_scrollOffset].node].data;
+}
+
+const char *MenuWindow::GetSelectedName() {
+    UpdateIndex();
+
+    return m_rows.empty() ? "" : GetName(m_rows[m_highlight + m_scrollOffset].node);
+}
+
+uint32_t MenuWindow::CreateNode(uint32_t parent, const char *name, void *data, uint32_t onClick, uint8_t flags) {
+    uint32_t node;
+
+    if (m_freeNodes.empty()) {
+        node = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    } else {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    }
+
+    m_nodes[node] = Node{data, StoreName(name), parent, NONE, NONE, NONE, m_nodes[parent].lastChild, onClick, flags};
+
+    (m_nodes[parent].lastChild != NONE ? m_nodes[m_nodes[parent].lastChild].next : m_nodes[parent].firstChild) = node;
+    m_nodes[parent].lastChild = node;
+
+    if (data != nullptr) {
+        IndexNode(node);
+    }
+
+    return node;
+}
+
+void MenuWindow::CreateNodes(uint32_t parent, MenuItem &item) {
+    m_clickFunctions.push_back(std::move(item.m_onClick));
+
+    uint32_t node = CreateNode(parent, item.GetName(), item.GetData(),
+                               static_cast<uint32_t>(m_clickFunctions.size() - 1),
+                               item.IsExpanded() ? FLAG_EXPANDED : 0);
+
+    for (auto &child : item.GetChildren()) {
+        CreateNodes(node, child);
+    }
+}
+
+void MenuWindow::ReleaseNode(uint32_t node) {
+    for (uint32_t child = m_nodes[node].firstChild; child != NONE; child = m_nodes[child].next) {
+        ReleaseNode(child);
+    }
+
+    if (m_nodes[node].data != nullptr) {
+        UnindexNode(m_nodes[node].data);
+    }
+
+    m_freeNodes.push_back(node);
+}
+
+uint32_t MenuWindow::FindNode(const void *data) const {
+    if (data == nullptr) {
+        return NONE;
+    }
+
+    auto mask = static_cast<uint32_t>(m_nodeIndex.size() - 1);
+
+    for (uint32_t slot = GetHomeSlot(data); m_nodeIndex[slot] != NONE; slot = (slot + 1) & mask) {
+        if (m_nodes[m_nodeIndex[slot]].data == data) {
+            return m_nodeIndex[slot];
+        }
+    }
+
+    return NONE;
+}
+
+void MenuWindow::IndexNode(uint32_t node) {
+    // The table is kept at most half full, so that probing stays short
+    if ((m_indexedNodeCount + 1) * 2 > m_nodeIndex.size()) {
+        std::vector<uint32_t> oldIndex(m_nodeIndex.size() * 2, NONE);
+        oldIndex.swap(m_nodeIndex);
+        m_indexedNodeCount = 0;
+
+        for (uint32_t indexed : oldIndex) {
+            if (indexed != NONE) {
+                IndexNode(indexed);
+            }
+        }
+    }
+
+    auto mask = static_cast<uint32_t>(m_nodeIndex.size() - 1);
+    uint32_t slot = GetHomeSlot(m_nodes[node].data);
+
+    for (; m_nodeIndex[slot] != NONE; slot = (slot + 1) & mask) {
+        if (m_nodes[m_nodeIndex[slot]].data == m_nodes[node].data) {
+            m_nodeIndex[slot] = node;
+            return;
+        }
+    }
+
+    m_nodeIndex[slot] = node;
+    m_indexedNodeCount++;
+}
+
+void MenuWindow::UnindexNode(const void *data) {
+    auto mask = static_cast<uint32_t>(m_nodeIndex.size() - 1);
+    uint32_t slot = GetHomeSlot(data);
 
+    for (; m_nodeIndex[slot] != NONE; slot = (slot + 1) & mask) {
+        if (m_nodes[m_nodeIndex[slot]].data == data) {
+            break;
+        }
+    }
+
+    if (m_nodeIndex[slot] == NONE) {
+        return;
+    }
+
+    // Move the following entries back into the gap, unless their home slot lies behind it (no tombstones needed)
+    for (uint32_t next = (slot + 1) & mask; m_nodeIndex[next] != NONE; next = (next + 1) & mask) {
+        uint32_t home = GetHomeSlot(m_nodes[m_nodeIndex[next]].data);
+
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            m_nodeIndex[slot] = m_nodeIndex[next];
+            slot = next;
+        }
+    }
+
+    m_nodeIndex[slot] = NONE;
+    m_indexedNodeCount--;
+}
+
+uint32_t MenuWindow::StoreName(const char *name) {
+    auto offset = static_cast<uint32_t>(m_names.size());
+
+    m_names.insert(m_names.end(), name, name + strlen(name) + 1);
+
+    return offset;
 }
 
 void MenuWindow::DrawContent() {
     Window::DrawContent();
 
-    uint32_t posY = 0;
-    int32_t scrollOffsetBackup = m_scrollOffset;
+    UpdateIndex();
 
-    for (uint32_t i = 0; i < GetWidth(); i++) {
-        for (uint32_t j = 0; j < GetHeight(); j++) {
-            PrintCharAt(i, j, ' ');
+    for (uint32_t i = 0; i < GetPageSize(); i++) {
+        if (i + m_scrollOffset < m_rows.size()) {
+            DrawRow(i + m_scrollOffset);
+        } else {
+            PrintLineAt(i, "");
         }
     }
 
-    for (auto &m_item : m_items) {
-        posY += PrintItem(m_item, 0, posY);
-    }
+    if (m_isSearching && GetPageSize() < GetHeight()) {
+        char matches[32];
+        snprintf(matches, sizeof(matches), m_query.empty() ? "" : "  (%zu matches)", m_matches.size());
 
-    m_scrollOffset = scrollOffsetBackup;
+        PrintLineAt(GetPageSize(), ("/" + m_query + "_" + matches).c_str(), A_BOLD);
+    }
 }
 
 void MenuWindow::HandleKey(int c) {
-    uint32_t counter = 0;
-    MenuItem *item = CalcSelectedItem(counter, m_items, m_highlight + m_scrollOffset);
+    UpdateIndex();
+
+    if (HandleSearchKey(c)) {
+        Invalidate();
+        return;
+    }
+
+    if (m_rows.empty()) {
+        Window::HandleKey(c);
+        return;
+    }
+
+    uint32_t position = m_highlight + m_scrollOffset;
+    const Node &node = m_nodes[m_rows[position].node];
 
     switch (c) {
         case KEY_UP :
-            if (m_highlight > 0) {
-                m_highlight--;
-            } else if (m_scrollOffset > 0) {
-                m_scrollOffset--;
+            if (position > 0) {
+                Select(position - 1);
             }
             break;
         case KEY_DOWN:
-            if (m_highlight + m_scrollOffset < CalcMenuHeight(m_items) - 1) {
-                if (m_highlight < GetHeight() - 1) {
-                    m_highlight++;
-                } else {
-                    m_scrollOffset++;
-                }
-            }
+            Select(position + 1);
+            break;
+        case KEY_PPAGE:
+            Select(position > GetPageSize() ? position - GetPageSize() : 0);
+            break;
+        case KEY_NPAGE:
+            Select(position + GetPageSize());
+            break;
+        case KEY_HOME:
+            Select(0);
+            break;
+        case KEY_END:
+            Select(static_cast<uint32_t>(m_rows.size() - 1));
             break;
         case KEY_RIGHT:
-            if (!item->IsExpanded()) {
-                item->ToggleExpanded();
+            if (!(node.flags & FLAG_EXPANDED)) {
+                ToggleExpanded(position);
             }
             break;
         case KEY_LEFT:
-            if (item->IsExpanded()) {
-                item->ToggleExpanded();
+            if (node.flags & FLAG_EXPANDED) {
+                ToggleExpanded(position);
             }
             break;
         case KEY_ENTER:
         case 10:
         case ' ':
-            item->PerformClick();
+            if (node.onClick != NONE) {
+                m_clickFunctions[node.onClick]();
+            } else if (m_clickHandler) {
+                m_clickHandler(node.data);
+            }
             break;
         default:
             break;
@@ -87,107 +363,224 @@ void MenuWindow::HandleKey(int c) {
 
     Window::HandleKey(c);
 
-    WindowManager::GetInstance()->RequestRefresh();
+    Invalidate();
 }
 
-uint32_t MenuWindow::PrintItem(MenuItem &item, const uint32_t posX, uint32_t posY) {
-    uint32_t ret = 0;
+void MenuWindow::DrawRow(uint32_t row) {
+    const Row &entry = m_rows[row];
+    const Node &node = m_nodes[entry.node];
+    chtype attr = row - m_scrollOffset == m_highlight ? A_REVERSE : A_NORMAL;
 
-    if (posY > GetHeight() - 1) {
-        return 0;
+    if (node.flags & FLAG_MARKED) {
+        attr |= A_BOLD;
     }
 
-    if (m_scrollOffset <= 0) {
-        if (posX > 0) {
-            for (uint32_t i = 0; i < posX; i++) {
-                if ((i - 1) % 4 == 0) {
-                    PrintCharAt(i, posY, ACS_VLINE);
-                } else {
-                    PrintCharAt(i, posY, ' ');
-                }
-            }
-            PrintCharAt(posX - 3, posY, ACS_LTEE);
-            PrintCharAt(posX - 2, posY, ACS_HLINE);
-            PrintCharAt(posX - 1, posY, ACS_HLINE);
-        }
+    m_lineBuffer.clear();
 
-        if (posY == m_highlight) {
-            EnableAttribute(A_REVERSE);
-        }
+    // Each level of the tree is indented by 4 columns, which contain the branches of the item's ancestors
+    for (uint32_t level = 1; level < entry.depth; level++) {
+        bool isLast = level >= 64 || (entry.isLastMask & (1ull << level)) != 0;
 
-        if (item.GetChildren().empty()) {
-            PrintStringAt(posX, posY, "[ ]");
-        } else {
-            PrintStringAt(posX, posY, item.IsExpanded() ? "[-]" : "[+]");
-        }
+        m_lineBuffer.push_back(' ');
+        m_lineBuffer.push_back(isLast ? ' ' : ACS_VLINE);
+        m_lineBuffer.push_back(' ');
+        m_lineBuffer.push_back(' ');
+    }
 
-        PrintStringAt(posX + 3, posY, item.GetName());
-        DisableAttribute(A_REVERSE);
+    if (entry.depth > 0) {
+        bool isLast = entry.depth >= 64 || (entry.isLastMask & (1ull << entry.depth)) != 0;
 
-        ret++;
+        m_lineBuffer.push_back(' ');
+        m_lineBuffer.push_back(isLast ? ACS_LLCORNER : ACS_LTEE);
+        m_lineBuffer.push_back(ACS_HLINE);
+        m_lineBuffer.push_back(ACS_HLINE);
     }
 
-    m_scrollOffset--;
+    bool hasChildren = node.firstChild != NONE || (node.flags & FLAG_LAZY);
+    const char *prefix = !hasChildren ? "[ ]" : (node.flags & FLAG_EXPANDED ? "[-]" : "[+]");
 
-    if (item.IsExpanded()) {
-        for (MenuItem &subItem : item.GetChildren()) {
-            uint32_t printed = PrintItem(subItem, posX + 4, ++posY);
+    for (const char *c = prefix; *c != '\0'; c++) {
+        m_lineBuffer.push_back(static_cast<unsigned char>(*c) | attr);
+    }
 
-            posY += printed - 1;
-            ret += printed;
+    for (const char *c = GetName(entry.node); *c != '\0'; c++) {
+        m_lineBuffer.push_back(static_cast<unsigned char>(*c) | attr);
+    }
+
+    if (node.flags & FLAG_MARKED) {
+        for (const char *c = " (!)"; *c != '\0'; c++) {
+            m_lineBuffer.push_back(static_cast<unsigned char>(*c) | attr);
         }
+    }
 
-        if (posY < GetHeight() - 1) {
-            if (item.GetChildren().back().IsExpanded()) {
-                PrintCharAt(posX + 1, posY - 1, ACS_LLCORNER);
-                PrintCharAt(posX + 1, posY, ' ');
-            } else {
-                PrintCharAt(posX + 1, posY, ACS_LLCORNER);
-            }
+    PrintLineAt(row - m_scrollOffset, m_lineBuffer.data(), static_cast<uint32_t>(m_lineBuffer.size()));
+}
+
+bool MenuWindow::HandleSearchKey(int c) {
+    if (!m_isSearching) {
+        if (c != '/' || !m_searchFunction) {
+            return false;
         }
+
+        m_isSearching = true;
+        m_query.clear();
+        m_matches.clear();
+        m_searchOrigin = m_rows.empty() ? nullptr : m_nodes[m_rows[m_highlight + m_scrollOffset].node].data;
+
+        // The bottom row is now occupied by the query
+        Select(m_highlight + m_scrollOffset);
+
+        return true;
     }
 
-    return ret;
+    switch (c) {
+        case 27:
+            EndSearch(m_searchOrigin);
+            return true;
+        case KEY_ENTER:
+        case 10:
+            EndSearch(m_rows.empty() ? m_searchOrigin : m_nodes[m_rows[m_highlight + m_scrollOffset].node].data);
+            return true;
+        case KEY_BACKSPACE:
+        case 127:
+        case 8:
+            if (!m_query.empty()) {
+                m_query.pop_back();
+            }
+            break;
+        default:
+            if (c < 32 || c >= 127) {
+                // Navigation keys work on the matches
+                return false;
+            }
+
+            m_query.push_back(static_cast<char>(c));
+            break;
+    }
+
+    m_matches.clear();
+
+    if (!m_query.empty()) {
+        m_searchFunction(m_query, m_matches);
+    }
+
+    m_isIndexValid = false;
+    UpdateIndex();
+
+    Select(0u);
+
+    return true;
 }
 
-uint32_t MenuWindow::CalcMenuHeight(std::vector<MenuItem> &items) {
-    uint32_t height = 0;
+void MenuWindow::EndSearch(const void *data) {
+    m_isSearching = false;
+    m_query.clear();
+    m_matches.clear();
 
-    for (auto &item : items) {
-        height++;
+    m_isIndexValid = false;
+    UpdateIndex();
 
-        if (item.IsExpanded()) {
-            height += CalcMenuHeight(item.GetChildren());
-        }
+    SelectItem(data);
+}
+
+void MenuWindow::AppendRows(uint32_t node, uint32_t depth, uint64_t isLastMask, std::vector<Row> &rows) const {
+    if (m_nodes[node].next == NONE && depth < 64) {
+        isLastMask |= 1ull << depth;
     }
 
-    return height;
+    rows.push_back(Row{node, depth, isLastMask});
+
+    if (m_nodes[node].flags & FLAG_EXPANDED) {
+        for (uint32_t child = m_nodes[node].firstChild; child != NONE; child = m_nodes[child].next) {
+            AppendRows(child, depth + 1, isLastMask, rows);
+        }
+    }
 }
 
-MenuItem *MenuWindow::CalcSelectedItem(uint32_t &counter, std::vector<MenuItem> &items, uint32_t selection) {
-    for (auto &item : items) {
-        if (counter == selection) {
-            return &item;
+void MenuWindow::UpdateIndex() {
+    if (m_isIndexValid) {
+        return;
+    }
+
+    bool isFiltered = m_isSearching && !m_query.empty();
+
+    m_rows.clear();
+
+    for (uint32_t node = m_nodes[ROOT].firstChild; node != NONE; node = m_nodes[node].next) {
+        if (!isFiltered || m_matches.count(m_nodes[node].data) > 0) {
+            AppendRows(node, 0, 0, m_rows);
         }
+    }
 
-        counter++;
+    m_isIndexValid = true;
 
-        if (item.IsExpanded()) {
-            MenuItem *tmp = CalcSelectedItem(counter, item.GetChildren(), selection);
+    // The highlighted row may not exist anymore
+    if (m_highlight + m_scrollOffset >= m_rows.size()) {
+        uint32_t last = m_rows.empty() ? 0 : static_cast<uint32_t>(m_rows.size() - 1);
 
-            if (tmp != nullptr) {
-                return tmp;
-            }
+        m_scrollOffset = std::min<int32_t>(m_scrollOffset, last);
+        m_highlight = last - m_scrollOffset;
+    }
+}
+
+void MenuWindow::ToggleExpanded(uint32_t row) {
+    uint32_t node = m_rows[row].node;
+    uint32_t depth = m_rows[row].depth;
+
+    if (m_nodes[node].flags & FLAG_LAZY) {
+        m_nodes[node].flags &= ~FLAG_LAZY;
+
+        if (m_expandHandler) {
+            m_expandHandler(m_nodes[node].data);
         }
     }
 
-    return nullptr;
+    // An item without subitems cannot be expanded
+    if (m_nodes[node].firstChild == NONE) {
+        return;
+    }
+
+    m_nodes[node].flags ^= FLAG_EXPANDED;
+
+    if (m_nodes[node].flags & FLAG_EXPANDED) {
+        std::vector<Row> rows;
+
+        for (uint32_t child = m_nodes[node].firstChild; child != NONE; child = m_nodes[child].next) {
+            AppendRows(child, depth + 1, m_rows[row].isLastMask, rows);
+        }
+
+        m_rows.insert(m_rows.begin() + row + 1, rows.begin(), rows.end());
+    } else {
+        // The item's descendants are all rows below it, up to the next row on the same or a higher level
+        auto begin = m_rows.begin() + row + 1;
+        auto end = std::find_if(begin, m_rows.end(), [depth](const Row &entry) { return entry.depth <= depth; });
+
+        m_rows.erase(begin, end);
+    }
 }
 
-MenuItem &MenuWindow::GetSelectedItem()  {
-    uint32_t counter = 0;
+void MenuWindow::Select(uint32_t row) {
+    if (row >= m_rows.size()) {
+        row = m_rows.empty() ? 0 : static_cast<uint32_t>(m_rows.size() - 1);
+    }
+
+    // Scroll as little as possible
+    if (row < static_cast<uint32_t>(m_scrollOffset)) {
+        m_scrollOffset = row;
+    } else if (row >= m_scrollOffset + GetPageSize()) {
+        m_scrollOffset = row - GetPageSize() + 1;
+    }
 
-    return *CalcSelectedItem(counter, m_items, m_highlight + m_scrollOffset);
+    m_highlight = row - m_scrollOffset;
 }
 
-}
\ No newline at end of file
+void MenuWindow::SelectItem(const void *data) {
+    for (uint32_t row = 0; row < m_rows.size(); row++) {
+        if (m_nodes[m_rows[row].node].data == data) {
+            Select(row);
+            return;
+        }
+    }
+}
+
+}
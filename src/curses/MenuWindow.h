@@ -19,6 +19,9 @@
 #ifndef IBSCANNER_MENULIST_H
 #define IBSCANNER_MENULIST_H
 
+#include <cstdint>
+#include <string>
+#include <unordered_set>
 #include <vector>
 #include <ncurses.h>
 #include "Window.h"
@@ -30,10 +33,24 @@ namespace Curses {
 /**
  * A ListWindow, which contains a scrollable list of item, that can have subitems.
  *
- * The list can be navigated through with the up and down arrow keys.
+ * The list can be navigated through with the up and down arrow keys, PageUp/PageDown and Home/End.
  * Items can be expanded/collapsed by using the left/right keys.
  * An item can be chosen by pressing the Enter key. This will trigger a callback function.
  *
+ * The items are stored in a single vector of small nodes, which refer to each other by their indices, and their
+ * names in a single character buffer. Nodes are found by their data via a hash table of node indices.
+ * Items, that are added by their name and data, do not have their own callback function; Their clicks are passed to
+ * a click handler, which is shared by all of them. The subitems of such an item can be created by an expand handler,
+ * when the item is expanded for the first time.
+ *
+ * The visible (i.e. not collapsed) items are kept in a flat index of rows, so that selecting and drawing an item
+ * does not need to walk the tree. Expanding/collapsing an item only inserts/erases the rows of its subitems;
+ * Adding or removing visible items rebuilds the index once, before it is used the next time.
+ *
+ * If a search function has been set, '/' starts a search: While the query is typed (shown in the bottom row), only
+ * the matching top level items are shown. Enter jumps to the highlighted match in the entire menu, Escape returns to
+ * the item, that has been highlighted before the search.
+ *
  * @author Fabian Ruhland, Fabian.Ruhland@hhu.de
  * @date May 2018
  */
@@ -58,16 +75,94 @@ public:
     ~MenuWindow() override = default;
 
     /**
-     * Add an item.
+     * Add an item and all of its subitems.
+     */
+    void AddItem(MenuItem item);
+
+    /**
+     * Add an item, whose clicks are passed to the click handler.
+     *
+     * @param name The name
+     * @param data The data, that identifies the item (must be unique inside the menu)
+     * @param hasSubitems true, if the item's subitems are created by the expand handler
+     */
+    void AddItem(const char *name, void *data, bool hasSubitems = false);
+
+    /**
+     * Add a subitem, whose clicks are passed to the click handler, to an item (or subitem).
+     *
+     * Nothing is added to an item, whose subitems are created by the expand handler, but which has not been expanded
+     * yet, because the expand handler will create all of them.
+     *
+     * @param parentData The data, that has been associated with the parent item
+     * @param name The subitem's name
+     * @param data The data, that identifies the subitem (must be unique inside the menu)
+     *
+     * @return true, if the parent item has been found
+     */
+    bool AddSubitem(const void *parentData, const char *name, void *data);
+
+    /**
+     * Rename an item (or subitem).
+     *
+     * @param data The data, that has been associated with the item
+     * @param name The new name
+     *
+     * @return true, if the item has been found
+     */
+    bool SetName(const void *data, const char *name);
+
+    /**
+     * Remove an item (or subitem) and all of its subitems.
+     *
+     * @param data The data, that has been associated with the item
+     *
+     * @return true, if the item has been found
+     */
+    bool RemoveItem(const void *data);
+
+    /**
+     * Mark all items, whose data matches a predicate, and all items, that contain a marked subitem.
+     *
+     * @param isMarked The predicate, which is called once for each item's data
+     */
+    void SetMarked(const std::function<bool(const void*)> &isMarked);
+
+    /**
+     * Set the function, that is called with an item's data, when an item without its own callback function is chosen.
+     */
+    void SetClickHandler(std::function<void(void*)> clickHandler) {
+        m_clickHandler = std::move(clickHandler);
+    }
+
+    /**
+     * Set the function, that is called with an item's data, when an item, that has been added with hasSubitems,
+     * is expanded for the first time. The function is supposed to add the item's subitems with AddSubitem().
+     */
+    void SetExpandHandler(std::function<void(void*)> expandHandler) {
+        m_expandHandler = std::move(expandHandler);
+    }
+
+    /**
+     * Set the function, that is called with the query for each change of the search.
+     *
+     * The function receives the query and inserts the data of all matching top level items into a set.
+     *
+     * @param searchFunction The function
      */
-    void AddItem(MenuItem item) {
-        m_items.emplace_back(item);
+    void SetSearchFunction(std::function<void(const std::string&, std::unordered_set<const void*>&)> searchFunction) {
+        m_searchFunction = std::move(searchFunction);
     }
 
     /**
-     * Get the selected item.
+     * Get the data of the selected item (nullptr, if the menu is empty).
+     */
+    void *GetSelectedData();
+
+    /**
+     * Get the name of the selected item (an empty string, if the menu is empty).
      */
-    MenuItem& GetSelectedItem();
+    const char *GetSelectedName();
 
 protected:
 
@@ -84,38 +179,192 @@ protected:
 private:
 
     /**
-     * Print an item and its subitems, if it is expanded.
+     * An item, as it is stored inside the menu.
+     *
+     * The items form a tree below a root node, whose children are the top level items.
+     */
+    struct Node {
+        void *data;
+        // The offset of the name inside m_names
+        uint32_t name;
+        uint32_t parent;
+        uint32_t firstChild;
+        uint32_t lastChild;
+        uint32_t next;
+        uint32_t previous;
+        // The index of the item's own callback function inside m_clickFunctions (NONE for the click handler)
+        uint32_t onClick;
+        uint8_t flags;
+    };
+
+    /**
+     * A visible item, as it is shown in one row of the menu.
+     */
+    struct Row {
+        uint32_t node;
+        uint32_t depth;
+        // Bit n is set, if the item's ancestor at depth n (or the item itself) is the last one of its siblings
+        uint64_t isLastMask;
+    };
+
+    static const uint32_t NONE = UINT32_MAX;
+    static const uint32_t ROOT = 0;
+
+    static const uint8_t FLAG_EXPANDED = 0x01;
+    static const uint8_t FLAG_MARKED = 0x02;
+    // The subitems are created by the expand handler, when the item is expanded for the first time
+    static const uint8_t FLAG_LAZY = 0x04;
+
+    /**
+     * Create a node and append it to its parent's children.
+     *
+     * @return The node's index
+     */
+    uint32_t CreateNode(uint32_t parent, const char *name, void *data, uint32_t onClick, uint8_t flags);
+
+    /**
+     * Create the nodes of an item and its subitems.
+     */
+    void CreateNodes(uint32_t parent, MenuItem &item);
+
+    /**
+     * Release a node and all of its descendants, after it has been unlinked from its parent.
+     */
+    void ReleaseNode(uint32_t node);
+
+    /**
+     * Find a node by its data.
+     *
+     * @return The node's index or NONE, if there is none
+     */
+    uint32_t FindNode(const void *data) const;
+
+    /**
+     * Get the slot of the node index, at which the search for a node's data starts.
+     */
+    uint32_t GetHomeSlot(const void *data) const {
+        return static_cast<uint32_t>((reinterpret_cast<uintptr_t>(data) * 0x9e3779b97f4a7c15ull) >> 32u) &
+               static_cast<uint32_t>(m_nodeIndex.size() - 1);
+    }
+
+    /**
+     * Add a node to the node index (replacing a node with the same data).
+     */
+    void IndexNode(uint32_t node);
+
+    /**
+     * Remove the node with the given data from the node index.
+     */
+    void UnindexNode(const void *data);
+
+    /**
+     * Store a name inside the character buffer.
+     *
+     * @return The name's offset
+     */
+    uint32_t StoreName(const char *name);
+
+    const char *GetName(uint32_t node) const {
+        return &m_names[m_nodes[node].name];
+    }
+
+    /**
+     * Draw a single row.
+     *
+     * @param row The row's index inside the entire menu
+     */
+    void DrawRow(uint32_t row);
+
+    /**
+     * Append the row of a node and the rows of its expanded descendants.
+     *
+     * @param node The node
+     * @param depth The node's depth inside the tree (0 for top level items)
+     * @param isLastMask The mask of the node's parent (see Row)
+     * @param rows Receives the rows
+     */
+    void AppendRows(uint32_t node, uint32_t depth, uint64_t isLastMask, std::vector<Row> &rows) const;
+
+    /**
+     * Rebuild the index of rows, if visible items have been added or removed since it has been built.
+     *
+     * The highlighted row is moved up, if it does not exist anymore.
+     */
+    void UpdateIndex();
+
+    /**
+     * Expand/collapse the item in a row and insert/erase the rows of its subitems.
+     *
+     * @param row The row's index
+     */
+    void ToggleExpanded(uint32_t row);
+
+    /**
+     * Mark a node and its descendants.
      *
-     * @param item The item
-     * @param posX The x-coordinate inside the window
-     * @param posY The y-coordinate inside the window
-     * @return
+     * @return true, if the node has been marked
      */
-    uint32_t PrintItem(MenuItem &item, uint32_t posX, uint32_t posY);
+    bool SetMarked(uint32_t node, const std::function<bool(const void*)> &isMarked);
 
     /**
-     * Calculate the menu's height at its current state (regarding expanded/collapsed items).
+     * Highlight a row and scroll as little as possible to keep it visible.
      *
-     * @param items The menu items
+     * @param row The row's index; Is limited to the last row
+     */
+    void Select(uint32_t row);
+
+    /**
+     * Highlight the row of a shown item.
      *
-     * @return The calculated height
+     * @param data The data, that has been associated with the item
      */
-    uint32_t CalcMenuHeight(std::vector<MenuItem> &items);
+    void SelectItem(const void *data);
+
+    /**
+     * Get the amount of rows, that fit into the window (the bottom row shows the query during a search).
+     */
+    uint32_t GetPageSize() const {
+        return m_isSearching && GetHeight() > 1 ? GetHeight() - 1 : GetHeight();
+    }
 
     /**
-     * Calculate which item is currently selected.
+     * Handle a key during a search.
      *
-     * @param counter Internal use; Should be set to 0 befor the first call
-     * @param items The menu items
-     * @param selection The highlighted position
+     * @return true, if the key has been consumed by the search
+     */
+    bool HandleSearchKey(int c);
+
+    /**
+     * Leave the search and show all items again.
      *
-     * @return The calculated item
+     * @param data The data of the item, that is highlighted afterwards
      */
-    MenuItem *CalcSelectedItem(uint32_t &counter, std::vector<MenuItem> &items, uint32_t selection);
+    void EndSearch(const void *data);
 
 private:
 
-    std::vector<MenuItem> m_items;
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_freeNodes;
+    // The names of removed or renamed items are not reclaimed
+    std::vector<char> m_names;
+    // Open addressing with linear probing over the indices of all nodes with data (NONE marks an empty slot)
+    std::vector<uint32_t> m_nodeIndex;
+    uint32_t m_indexedNodeCount;
+
+    std::vector<std::function<void()>> m_clickFunctions;
+    std::function<void(void*)> m_clickHandler;
+    std::function<void(void*)> m_expandHandler;
+
+    std::vector<Row> m_rows;
+    bool m_isIndexValid;
+
+    std::function<void(const std::string&, std::unordered_set<const void*>&)> m_searchFunction;
+    std::string m_query;
+    std::unordered_set<const void*> m_matches;
+    const void *m_searchOrigin;
+    bool m_isSearching;
+
+    std::vector<chtype> m_lineBuffer;
 };
 
 }
@@ -55,8 +55,9 @@ void OkMessageWindow::HandleKey(int c) {
     Window::HandleKey(c);
 
     if (c == 10) {
-        m_onClick();
+        // The callback may release a thread, that deletes this window, so it must not be shown anymore
         WindowManager::GetInstance()->DeregisterWindow(this);
+        m_onClick();
     }
 }
 
@@ -10,7 +10,10 @@ Window::Window(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, co
         m_posY(posY),
         m_width(width),
         m_height(height),
-        m_posChanged(true) {
+        m_posChanged(true),
+        m_dirty(true),
+        m_frameDirty(true),
+        m_hasFocus(false) {
     m_title = title;
 
     if (m_width < m_title.length()) {
@@ -26,6 +29,16 @@ Window::~Window() {
 
 void Window::SetTitle(const char *title) {
     m_title = title;
+    m_frameDirty = true;
+
+    Invalidate();
+}
+
+void Window::Invalidate() {
+    // A window, that is already dirty, has not been drawn since its refresh has been requested
+    if (!m_dirty.exchange(true)) {
+        WindowManager::GetInstance()->RequestRefresh();
+    }
 }
 
 void Window::Move(uint32_t posX, uint32_t posY) {
@@ -33,6 +46,8 @@ void Window::Move(uint32_t posX, uint32_t posY) {
     m_posY = posY;
 
     m_posChanged = true;
+
+    Invalidate();
 }
 
 void Window::Resize(uint32_t width, uint32_t height) {
@@ -40,6 +55,8 @@ void Window::Resize(uint32_t width, uint32_t height) {
     m_height = height;
 
     m_posChanged = true;
+
+    Invalidate();
 }
 
 void Window::EnableAttribute(uint32_t attr) {
@@ -59,12 +76,75 @@ void Window::PrintCharAt(uint32_t x, uint32_t y, const chtype c) {
     waddch(m_window, c);
 }
 
+chtype *Window::GetCachedLine(uint32_t y) {
+    size_t size = static_cast<size_t>(GetWidth()) * GetHeight();
+
+    if (m_lineCache.size() != size) {
+        m_lineCache.assign(size, 0);
+    }
+
+    return &m_lineCache[static_cast<size_t>(y) * GetWidth()];
+}
+
+void Window::PrintLineAt(uint32_t y, const chtype *line, uint32_t length) {
+    if (y >= GetHeight()) {
+        return;
+    }
+
+    uint32_t width = GetWidth();
+    chtype *cached = GetCachedLine(y);
+    bool changed = false;
+
+    for (uint32_t x = 0; x < width; x++) {
+        chtype c = x < length ? line[x] : ' ';
+
+        if (cached[x] != c) {
+            cached[x] = c;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        mvwaddchnstr(m_window, y + 1, 1, cached, width);
+    }
+}
+
+void Window::PrintLineAt(uint32_t y, const char *text, chtype attr) {
+    if (y >= GetHeight()) {
+        return;
+    }
+
+    uint32_t width = GetWidth();
+    chtype *cached = GetCachedLine(y);
+    bool changed = false;
+    bool end = false;
+
+    for (uint32_t x = 0; x < width; x++) {
+        end = end || text[x] == '\0';
+
+        chtype c = end ? ' ' : static_cast<unsigned char>(text[x]) | attr;
+
+        if (cached[x] != c) {
+            cached[x] = c;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        mvwaddchnstr(m_window, y + 1, 1, cached, width);
+    }
+}
+
 void Window::DrawContent() {
     if (m_posChanged) {
         wresize(m_window, m_height, m_width);
         mvwin(m_window, m_posY, m_posX);
         werase(m_window);
 
+        // Everything has to be drawn again
+        m_lineCache.clear();
+        m_frameDirty = true;
+
         m_posChanged = false;
     }
 }
@@ -1,9 +1,11 @@
 #ifndef IBSCANNER_WINDOW_H
 #define IBSCANNER_WINDOW_H
 
+#include <atomic>
 #include <cstdint>
 #include <ncurses.h>
 #include <string>
+#include <vector>
 #include <unordered_map>
 #include <functional>
 
@@ -17,6 +19,7 @@ class WindowManager;
  * Implementations MUST NOT perform any ncurses-calls outside of DrawContent()!
  * To show a window, call WindowManager::GetInstance()->RegisterWindow(window).
  * To hide a window, call WindowManager::GetInstance()->DeregisterWindow(window).
+ * When the window's content changes, call Invalidate(). Only invalidated windows are redrawn.
  *
  * @author Fabian Ruhland, Fabian.Ruhland@hhu.de
  * @date May 2018
@@ -92,6 +95,13 @@ public:
      */
     void Resize(uint32_t width, uint32_t height);
 
+    /**
+     * Mark the window's content as changed and advise the WindowManager to redraw it as soon as possible.
+     *
+     * May be called from any thread.
+     */
+    void Invalidate();
+
     /**
      * Add a handler function, that is called, when a specified key is pressed an the windows is focused.
      *
@@ -150,6 +160,26 @@ protected:
      */
     void PrintStringAt(uint32_t x, uint32_t y, const char *format...);
 
+    /**
+     * Print an entire line inside the window. The line is padded with spaces to the window's width.
+     *
+     * The window remembers the content of each line, so that ncurses is only called, if the line has changed.
+     *
+     * @param y The line's y-coordinate
+     * @param line The characters (including attributes)
+     * @param length The amount of characters
+     */
+    void PrintLineAt(uint32_t y, const chtype *line, uint32_t length);
+
+    /**
+     * Print an entire line of text inside the window. The line is padded with spaces to the window's width.
+     *
+     * @param y The line's y-coordinate
+     * @param text The text (not a format string)
+     * @param attr The attributes to be applied to the text
+     */
+    void PrintLineAt(uint32_t y, const char *text, chtype attr = A_NORMAL);
+
 protected:
 
     /**
@@ -174,6 +204,22 @@ protected:
     bool m_posChanged;
 
     std::string m_title;
+
+private:
+    /**
+     * Get the cached content of a line and make sure, that the cache fits the window's size.
+     *
+     * @param y The line's y-coordinate
+     */
+    chtype *GetCachedLine(uint32_t y);
+
+private:
+
+    std::vector<chtype> m_lineCache;
+
+    std::atomic<bool> m_dirty;
+    bool m_frameDirty;
+    bool m_hasFocus;
 };
 
 }
@@ -1,18 +1,39 @@
 #include <algorithm>
 #include <clocale>
+#include <csignal>
+#include <future>
+#include <memory>
 #include <ncurses.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
 #include "WindowManager.h"
 
 namespace Curses {
 
 WindowManager *WindowManager::instance = nullptr;
 
+/**
+ * The maximum amount of frames per second, if none has been set via SetMaxFrameRate().
+ */
+static const uint32_t DEFAULT_MAX_FRAME_RATE = 30;
+
 WindowManager::WindowManager() :
         m_terminalWidth(0),
         m_terminalHeight(0),
         m_isRunning(false),
+        m_wakeupFd(-1),
+        m_signalFd(-1),
         m_refresh(false),
-        m_erase(false) {
+        m_erase(false),
+        m_restack(false),
+        m_menuDirty(true),
+        m_postedFunctions(nullptr),
+        m_hasInput(false),
+        m_frameInterval(std::chrono::nanoseconds(1000000000 / DEFAULT_MAX_FRAME_RATE)),
+        m_isInputFrame(false) {
 
 }
 
@@ -25,11 +46,24 @@ WindowManager *WindowManager::GetInstance() {
 }
 
 void WindowManager::Initialize() {
+    // SIGWINCH is received via a file descriptor by the UI-thread.
+    // The signal needs to be blocked before any other thread is started, because the mask is inherited.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGWINCH);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    m_signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    m_wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
     initscr();
     cbreak();
     noecho();
     keypad(stdscr, true);
+    // A single Escape key (e.g. to cancel a search) should not wait for the rest of an escape sequence for a second
+    set_escdelay(25);
     curs_set(0);
+    // getch() is only called after poll() has reported input, until all pending keys are read
     timeout(0);
     setlocale(LC_ALL, "");
     fwide(stdout, 1);
@@ -46,66 +80,158 @@ void WindowManager::Start() {
 void WindowManager::Stop() {
     m_isRunning = false;
 
-    m_uiThread.join();
+    Wakeup();
+
+    if (std::this_thread::get_id() == m_uiThread.get_id()) {
+        // Called from a callback inside the UI-thread
+        m_uiThread.detach();
+    } else {
+        m_uiThread.join();
+    }
+
+    DiscardPostedFunctions();
 
     endwin();
 
+    close(m_signalFd);
+    close(m_wakeupFd);
+
     // Restore buffering behaviour of std-streams
     setvbuf(stdout, nullptr, _IOLBF, 0);
     setvbuf(stderr, nullptr, _IONBF, 0);
 }
 
 void WindowManager::Run() {
+    pollfd fds[3] = {
+            {STDIN_FILENO, POLLIN, 0},
+            {m_wakeupFd, POLLIN, 0},
+            {m_signalFd, POLLIN, 0}
+    };
+
+    m_uiThreadId = std::this_thread::get_id();
+
     DrawWindows();
 
     while (m_isRunning) {
-        if (m_refresh) {
-            m_refresh = false;
-            DrawWindows();
+        if (poll(fds, 3, GetPollTimeout()) < 0) {
+            continue;
         }
 
-        uint32_t width, height;
-        getmaxyx(stdscr, height, width);
+        if (fds[2].revents & POLLIN) {
+            signalfd_siginfo info{};
 
-        if(m_terminalWidth != width || m_terminalHeight != height) {
-            m_terminalWidth = width;
-            m_terminalHeight = height;
+            while (read(m_signalFd, &info, sizeof(info)) == sizeof(info));
 
-            m_erase = true;
-            m_refresh = true;
+            HandleResize();
         }
 
-        int c = getch();
+        if (fds[1].revents & POLLIN) {
+            uint64_t value;
 
-        if (c == ERR) {
-            continue;
-        } else if (c >= KEY_F(1) && c <= KEY_F(12)) {
-            ExecuteMenuFunction(static_cast<uint8_t>(c - KEY_F(1)));
-        } else if (c == 9) {
-            if (!m_windows.empty()) {
-                Window *lastWindow = m_windows.back();
-                m_windows.pop_back();
-                m_windows.insert(m_windows.begin(), lastWindow);
-
-                DrawWindows();
+            if (read(m_wakeupFd, &value, sizeof(value)) < 0) {
+                // Nothing to do; The eventfd has already been reset by another read
             }
-        } else {
-            if (!m_windows.empty()) {
-                m_windows.back()->HandleKey(c);
+
+            RunPostedFunctions();
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int c;
+
+            if (!m_hasInput) {
+                m_inputTime = std::chrono::steady_clock::now();
+                m_hasInput = true;
             }
+
+            while (m_isRunning && (c = getch()) != ERR) {
+                HandleKey(c);
+            }
+        }
+
+        // Refresh requests, that arrive until the frame is drawn, are handled by this frame
+        if (m_refresh && m_isRunning && IsFrameDue()) {
+            m_refresh = false;
+            DrawWindows();
         }
     }
 }
 
+void WindowManager::HandleResize() {
+    winsize size{};
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0) {
+        resizeterm(size.ws_row, size.ws_col);
+    }
+
+    uint32_t width, height;
+    getmaxyx(stdscr, height, width);
+
+    if (m_terminalWidth != width || m_terminalHeight != height) {
+        m_terminalWidth = width;
+        m_terminalHeight = height;
+
+        m_erase = true;
+        m_refresh = true;
+    }
+}
+
+void WindowManager::HandleKey(int c) {
+    if (c >= KEY_F(1) && c <= KEY_F(12)) {
+        ExecuteMenuFunction(static_cast<uint8_t>(c - KEY_F(1)));
+    } else if (c == 9) {
+        if (!m_windows.empty()) {
+            Window *lastWindow = m_windows.back();
+            m_windows.pop_back();
+            m_windows.insert(m_windows.begin(), lastWindow);
+
+            m_restack = true;
+            DrawWindows();
+        }
+    } else {
+        if (!m_windows.empty()) {
+            m_windows.back()->HandleKey(c);
+        }
+    }
+}
+
+bool WindowManager::IsUiThread() const {
+    return !m_isRunning || std::this_thread::get_id() == m_uiThreadId.load();
+}
+
 void WindowManager::RegisterWindow(Window *window) {
+    if (!IsUiThread()) {
+        Post([this, window] { RegisterWindow(window); });
+
+        return;
+    }
+
     if (std::find(m_windows.begin(), m_windows.end(), window) == m_windows.end()) {
         m_windows.emplace_back(window);
 
+        // The window's content is still valid, but it has to be flushed on top of the other windows
+        m_restack = true;
+
         RequestRefresh();
     }
 }
 
 void WindowManager::DeregisterWindow(Window *window) {
+    if (!IsUiThread()) {
+        // The caller may delete the window afterwards, so it must not be drawn anymore, when this function returns.
+        // If the command is discarded, because the UI-thread is stopped, the promise is broken and wakes up the caller.
+        auto isRemoved = std::make_shared<std::promise<void>>();
+        std::future<void> removal = isRemoved->get_future();
+
+        Post([this, window, isRemoved] {
+            DeregisterWindow(window);
+            isRemoved->set_value();
+        });
+
+        removal.wait();
+
+        return;
+    }
+
     if (std::find(m_windows.begin(), m_windows.end(), window) != m_windows.end()) {
         m_windows.erase(std::remove(m_windows.begin(), m_windows.end(), window), m_windows.end());
 
@@ -116,27 +242,147 @@ void WindowManager::DeregisterWindow(Window *window) {
 }
 
 void WindowManager::SetFocus(Window *window) {
+    if (!IsUiThread()) {
+        Post([this, window] { SetFocus(window); });
+
+        return;
+    }
+
     if (std::find(m_windows.begin(), m_windows.end(), window) != m_windows.end()) {
         m_windows.erase(std::remove(m_windows.begin(), m_windows.end(), window), m_windows.end());
 
         m_windows.emplace_back(window);
 
+        m_restack = true;
+
         RequestRefresh();
     }
 }
 
 void WindowManager::RequestRefresh() {
-    m_refresh = true;
+    // A pending frame is drawn anyway, so the UI-thread only needs to be woken up by the first request
+    if (!m_refresh.exchange(true)) {
+        Wakeup();
+    }
+}
+
+int WindowManager::GetPollTimeout() const {
+    if (!m_refresh) {
+        return -1;
+    }
+
+    auto remaining = m_nextFrameTime - std::chrono::steady_clock::now();
+
+    if (remaining <= std::chrono::steady_clock::duration::zero()) {
+        return 0;
+    }
+
+    // Rounded up, so that the UI-thread does not wake up shortly before the frame is due and poll again and again
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            remaining + std::chrono::milliseconds(1) - std::chrono::nanoseconds(1)).count());
+}
+
+bool WindowManager::IsFrameDue() const {
+    // The first frame after a key press is not delayed, so that input always feels immediate
+    return (m_hasInput && !m_isInputFrame) || std::chrono::steady_clock::now() >= m_nextFrameTime;
+}
+
+void WindowManager::Wakeup() {
+    uint64_t value = 1;
+
+    if (write(m_wakeupFd, &value, sizeof(value)) < 0) {
+        // The eventfd's counter is saturated, so the UI-thread is going to wake up anyway
+    }
 }
 
 void WindowManager::AddMenuFunction(std::string name, std::function<void()> function) {
+    if (!IsUiThread()) {
+        Post([this, name, function] { AddMenuFunction(name, function); });
+
+        return;
+    }
+
     if (m_menuFunctions.size() < 12) {
         m_menuFunctions.emplace_back(std::pair<std::string, std::function<void()>>(name, function));
     }
 
+    m_menuDirty = true;
+
     RequestRefresh();
 }
 
+void WindowManager::SetStatus(const std::string &status) {
+    if (!IsUiThread()) {
+        Post([this, status] { SetStatus(status); });
+
+        return;
+    }
+
+    if (status == m_status) {
+        return;
+    }
+
+    m_status = status;
+    m_menuDirty = true;
+
+    RequestRefresh();
+}
+
+void WindowManager::Post(std::function<void()> function) {
+    auto *posted = new PostedFunction{std::move(function), m_postedFunctions.load(std::memory_order_relaxed)};
+
+    while (!m_postedFunctions.compare_exchange_weak(posted->next, posted, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+
+    Wakeup();
+}
+
+void WindowManager::RunPostedFunctions() {
+    // Taking the entire list at once leaves nothing behind for other threads to interfere with, so there is no ABA
+    PostedFunction *posted = m_postedFunctions.exchange(nullptr, std::memory_order_acquire);
+    PostedFunction *first = nullptr;
+
+    // The list has been built in reverse order
+    while (posted != nullptr) {
+        PostedFunction *next = posted->next;
+        posted->next = first;
+        first = posted;
+        posted = next;
+    }
+
+    // Functions, that are posted by these functions, are executed after the next wakeup
+    while (first != nullptr) {
+        PostedFunction *next = first->next;
+
+        first->function();
+        delete first;
+
+        first = next;
+    }
+}
+
+void WindowManager::DiscardPostedFunctions() {
+    PostedFunction *posted = m_postedFunctions.exchange(nullptr, std::memory_order_acquire);
+
+    while (posted != nullptr) {
+        PostedFunction *next = posted->next;
+        delete posted;
+        posted = next;
+    }
+}
+
+void WindowManager::SetMaxFrameRate(uint32_t maxFrameRate) {
+    if (maxFrameRate == 0) {
+        m_frameInterval = std::chrono::steady_clock::duration::zero();
+    } else {
+        m_frameInterval = std::chrono::nanoseconds(1000000000 / maxFrameRate);
+    }
+}
+
+void WindowManager::SetFrameObserver(std::function<void(uint64_t, uint64_t)> frameObserver) {
+    m_frameObserver = std::move(frameObserver);
+}
+
 void WindowManager::ExecuteMenuFunction(uint8_t functionNumber) {
     if (functionNumber < m_menuFunctions.size()) {
         m_menuFunctions[functionNumber].second();
@@ -144,53 +390,125 @@ void WindowManager::ExecuteMenuFunction(uint8_t functionNumber) {
 }
 
 void WindowManager::DrawWindows() {
+    auto frameStart = std::chrono::steady_clock::now();
+    bool touchAll = false;
+
     if (m_erase) {
         m_erase = false;
-        erase();
+        werase(stdscr);
+
+        m_menuDirty = true;
+        touchAll = true;
+    }
+
+    if (m_restack) {
+        m_restack = false;
+        touchAll = true;
+    }
+
+    if (m_menuDirty) {
+        m_menuDirty = false;
+
+        DrawMenu();
+        wnoutrefresh(stdscr);
     }
 
+    m_damagedWindows.clear();
+
     for (Window *window : m_windows) {
-        window->DrawContent();
+        bool hasFocus = m_windows.back() == window;
+
+        // Only windows with changed content are drawn; Unchanged lines are skipped by the windows themselves
+        if (window->m_dirty.exchange(false) || window->m_posChanged || window->m_hasFocus != hasFocus) {
+            window->DrawContent();
+
+            if (window->m_frameDirty || window->m_hasFocus != hasFocus) {
+                DrawFrame(window, hasFocus);
+            }
+        }
+
+        // A window, that overlaps a window below it, which has just been flushed, needs to be flushed again
+        if (touchAll || IsDamaged(window)) {
+            touchwin(window->m_window);
+        }
 
-        if (m_windows.back() == window) {
-            wborder(window->m_window, 0, 0, 0, 0, '+', '+', '+', '+');
-        } else {
-            wborder(window->m_window, 0, 0, 0, 0, 0, 0, 0, 0);
+        if (is_wintouched(window->m_window)) {
+            wnoutrefresh(window->m_window);
+            m_damagedWindows.push_back(window);
         }
+    }
+
+    doupdate();
+
+    if (m_frameObserver) {
+        auto frameEnd = std::chrono::steady_clock::now();
+        auto frameTime = std::chrono::duration_cast<std::chrono::nanoseconds>(frameEnd - frameStart).count();
+        auto inputLatency = m_hasInput ?
+                std::chrono::duration_cast<std::chrono::nanoseconds>(frameEnd - m_inputTime).count() : 0;
 
-        window->EnableAttribute(A_BOLD);
-        mvwprintw(window->m_window, 0, static_cast<uint32_t>((window->m_width - window->m_title.length()) / 2),
-                  window->m_title.c_str());
-        window->DisableAttribute(A_BOLD);
+        m_frameObserver(static_cast<uint64_t>(frameTime), static_cast<uint64_t>(inputLatency));
     }
 
-    refresh();
+    m_nextFrameTime = frameStart + m_frameInterval;
+    m_isInputFrame = m_hasInput;
+    m_hasInput = false;
+}
 
-    for (Window *window : m_windows) {
-        wrefresh(window->m_window);
+void WindowManager::DrawFrame(Window *window, bool hasFocus) {
+    if (hasFocus) {
+        wborder(window->m_window, 0, 0, 0, 0, '+', '+', '+', '+');
+    } else {
+        wborder(window->m_window, 0, 0, 0, 0, 0, 0, 0, 0);
     }
 
+    window->EnableAttribute(A_BOLD);
+    mvwaddstr(window->m_window, 0, static_cast<uint32_t>((window->m_width - window->m_title.length()) / 2),
+              window->m_title.c_str());
+    window->DisableAttribute(A_BOLD);
+
+    window->m_frameDirty = false;
+    window->m_hasFocus = hasFocus;
+}
+
+void WindowManager::DrawMenu() {
     uint32_t posX = 0;
 
     for (uint32_t i = 0; i < m_menuFunctions.size(); i++) {
         mvprintw(m_terminalHeight - 1, posX, "F%d", i + 1);
-        posX += i < 10 ? 2 : 3;
+        posX += i < 9 ? 2 : 3;
 
         attron(A_REVERSE);
-        mvprintw(m_terminalHeight - 1, posX, m_menuFunctions[i].first.c_str());
+        mvaddstr(m_terminalHeight - 1, posX, m_menuFunctions[i].first.c_str());
         posX += m_menuFunctions[i].first.length();
         attroff(A_REVERSE);
     }
 
-    if (!m_menuFunctions.empty()) {
+    if (!m_menuFunctions.empty() || !m_status.empty()) {
         attron(A_REVERSE);
-        for (; posX < m_terminalWidth; posX++) {
-            mvprintw(m_terminalHeight - 1, posX, " ");
+        for (uint32_t i = posX; i < m_terminalWidth; i++) {
+            mvaddch(m_terminalHeight - 1, i, ' ');
+        }
+
+        // The status is only shown, if it fits next to the functions
+        if (!m_status.empty() && posX + m_status.length() + 2 <= m_terminalWidth) {
+            mvaddstr(m_terminalHeight - 1, static_cast<int>(m_terminalWidth - m_status.length() - 1),
+                     m_status.c_str());
         }
         attroff(A_REVERSE);
     }
+}
+
+bool WindowManager::IsDamaged(const Window *window) const {
+    for (const Window *damaged : m_damagedWindows) {
+        if (window->m_posX < damaged->m_posX + damaged->m_width &&
+            damaged->m_posX < window->m_posX + window->m_width &&
+            window->m_posY < damaged->m_posY + damaged->m_height &&
+            damaged->m_posY < window->m_posY + window->m_height) {
+            return true;
+        }
+    }
 
-    refresh();
+    return false;
 }
 
-}
\ No newline at end of file
+}
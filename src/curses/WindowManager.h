@@ -1,6 +1,7 @@
 #ifndef IBSCANNER_WINDOWMANAGER_H
 #define IBSCANNER_WINDOWMANAGER_H
 
+#include <chrono>
 #include <vector>
 #include <thread>
 #include <functional>
@@ -24,13 +25,27 @@ namespace Curses {
  *
  * To hide a window, call WindowManager::GetInstance()->DeregisterWindow(Window*).
  *
+ * The windows, the focus and the function menu are only changed by the UI-thread. If other threads (e.g. the
+ * scanner's threads) call one of the functions, that change them, the change is sent to the UI-thread as a command
+ * via the same lock-free queue as Post(). The UI-thread drains the queue before drawing the next frame, so it never
+ * iterates the windows, while they are changed, and threads, that post commands, never wait for a frame.
+ *
  * To get back to the normal console, call WindowManager::GetInstance()-> Stop().
  * Don't forget to deregister your windows before calling Stop()!
  *
+ * The UI-thread sleeps in poll() until a key is pressed, the terminal is resized or another thread calls
+ * RequestRefresh() or Post(), so that an idle TUI does not consume any CPU time.
+ *
+ * Frames are limited to a maximum frame rate. All refresh requests, that arrive before the next frame is due, are
+ * coalesced into that frame, so windows can be invalidated as often as their data changes, without the terminal being
+ * redrawn more often than the frame rate allows. The first frame after a key press is drawn right away, unless the
+ * previous frame has also responded to a key press (e.g. while a key is held down).
+ *
  * The WindowManager also shows a function menu at the terminal's bottom line.
  * To register a function call WindowManager::GetInstance->AddMenuFunction(std::string, std::function).
  * The functions will use the F-keys consecutively (e.g. the first registered function will use F1, the second F2, etc.)
  * The maximum amount of registered functions is 12.
+ * A short status text (e.g. the progress of a background task) can be shown at the right end of the function menu.
  *
  * @author Fabian Ruhland, Fabian.Ruhland@hhu.de
  * @date May 2018
@@ -73,6 +88,7 @@ public:
      * Register a window.
      *
      * The UI-thread will refresh all windows as soon as possible, in order for the newly registered window to be shown.
+     * May be called from any thread.
      *
      * @param window The window
      */
@@ -82,6 +98,8 @@ public:
      * Deregister a window.
      *
      * The UI-thread will refresh all windows as soon as possible, in order for the deregistered window to disappear.
+     * May be called from any thread. Other threads wait until the UI-thread has removed the window, so that the window
+     * can be deleted afterwards.
      *
      * @param window The window
      */
@@ -90,7 +108,7 @@ public:
     /**
      * Set the focus to a specified window.
      *
-     * The window has to be registered beforehand.
+     * The window has to be registered beforehand. May be called from any thread.
      *
      * @param window The window
      */
@@ -119,14 +137,72 @@ public:
      * Add a function to the function menu.
      *
      * The functions will use the F-keys consecutively(e.g. the first registered function will use F1,
-     * the second F2, etc.). The maximum amount of registered function is 12.
+     * the second F2, etc.). The maximum amount of registered function is 12. May be called from any thread.
      *
      * @param name The name to be shown in the function menu
      * @param function The function
      */
     void AddMenuFunction(std::string name, std::function<void()> function);
 
+    /**
+     * Set the status text, that is shown at the right end of the function menu.
+     *
+     * May be called from any thread.
+     *
+     * @param status The text (empty to hide the status)
+     */
+    void SetStatus(const std::string &status);
+
+    /**
+     * Execute a function inside the UI-thread as soon as possible.
+     *
+     * May be called from any thread without blocking. Functions are executed in the order, in which they have been
+     * posted. Functions, that are still pending when the UI-thread is stopped, are discarded.
+     *
+     * @param function The function
+     */
+    void Post(std::function<void()> function);
+
+    /**
+     * Set the maximum amount of frames per second (Default: 30).
+     *
+     * Must be called before Start().
+     *
+     * @param maxFrameRate The maximum frame rate (0 to draw a frame for every refresh request)
+     */
+    void SetMaxFrameRate(uint32_t maxFrameRate);
+
+    /**
+     * Set a function, that is called by the UI-thread after each frame has been flushed to the terminal.
+     *
+     * The function receives the time needed to draw the frame and the time since the first key press, that the frame
+     * responds to (0, if no key has been pressed since the last frame), both in nanoseconds.
+     * Must be called before Start().
+     *
+     * @param frameObserver The function
+     */
+    void SetFrameObserver(std::function<void(uint64_t, uint64_t)> frameObserver);
+
 private:
+    /**
+     * A function, that has been posted to the UI-thread.
+     */
+    struct PostedFunction {
+        std::function<void()> function;
+        PostedFunction *next;
+    };
+
+    /**
+     * Check, if the calling thread may change the windows directly. This is only the case for the UI-thread itself
+     * and for any thread, while the UI-thread is not running.
+     */
+    bool IsUiThread() const;
+
+    /**
+     * Delete all functions, that have been posted, without executing them.
+     */
+    void DiscardPostedFunctions();
+
     /**
      * Execute a function from the function menu.
      *
@@ -135,10 +211,64 @@ private:
     void ExecuteMenuFunction(uint8_t functionNumber);
 
     /**
-     * Refresh all windows.
+     * Redraw all invalidated windows and flush the changes to the terminal with a single doupdate().
      */
     void DrawWindows();
 
+    /**
+     * Draw a window's border and title.
+     *
+     * @param window The window
+     * @param hasFocus true, if the window is focused
+     */
+    void DrawFrame(Window *window, bool hasFocus);
+
+    /**
+     * Draw the function menu into the terminal's bottom line.
+     */
+    void DrawMenu();
+
+    /**
+     * Check if a window overlaps one of the windows, that have already been flushed in the current frame.
+     *
+     * @param window The window
+     */
+    bool IsDamaged(const Window *window) const;
+
+    /**
+     * Wake up the UI-thread, if it is waiting for events.
+     */
+    void Wakeup();
+
+    /**
+     * Adapt to the new terminal size after a SIGWINCH has been received.
+     */
+    void HandleResize();
+
+    /**
+     * Process a key, that has been read from the terminal.
+     *
+     * @param c The key
+     */
+    void HandleKey(int c);
+
+    /**
+     * Execute all functions, that have been posted since the last call.
+     */
+    void RunPostedFunctions();
+
+    /**
+     * Get the time in milliseconds, that poll() may wait for events, before the next frame has to be drawn.
+     *
+     * @return The timeout (-1, if no frame is pending)
+     */
+    int GetPollTimeout() const;
+
+    /**
+     * Check if a pending frame may be drawn now without exceeding the maximum frame rate.
+     */
+    bool IsFrameDue() const;
+
     /**
      * The UI-thread.
      */
@@ -147,15 +277,37 @@ private:
 private:
 
     uint32_t m_terminalWidth, m_terminalHeight;
-    bool m_isRunning;
+    std::atomic<bool> m_isRunning;
+
+    int m_wakeupFd;
+    int m_signalFd;
 
     std::atomic<bool> m_refresh;
     std::atomic<bool> m_erase;
+    std::atomic<bool> m_restack;
+    std::atomic<bool> m_menuDirty;
 
     std::vector<std::pair<std::string, std::function<void()>>> m_menuFunctions;
+    std::string m_status;
     std::vector<Window *> m_windows;
+    std::vector<const Window *> m_damagedWindows;
 
     std::thread m_uiThread;
+    std::atomic<std::thread::id> m_uiThreadId;
+
+    /**
+     * The functions, that have been posted since the UI-thread has last drained the queue, in reverse order.
+     * Other threads push to this list with compare-and-swap, while the UI-thread takes the entire list at once.
+     */
+    std::atomic<PostedFunction*> m_postedFunctions;
+
+    std::function<void(uint64_t, uint64_t)> m_frameObserver;
+    std::chrono::steady_clock::time_point m_inputTime;
+    bool m_hasInput;
+
+    std::chrono::steady_clock::duration m_frameInterval;
+    std::chrono::steady_clock::time_point m_nextFrameTime;
+    bool m_isInputFrame;
 
     static WindowManager *instance;
 };
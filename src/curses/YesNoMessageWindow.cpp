@@ -89,15 +89,16 @@ void YesNoMessageWindow::HandleKey(int c) {
     switch (c) {
         case KEY_LEFT:
             m_choice = true;
-            WindowManager::GetInstance()->RequestRefresh();
+            Invalidate();
             break;
         case KEY_RIGHT:
             m_choice = false;
-            WindowManager::GetInstance()->RequestRefresh();
+            Invalidate();
             break;
         case 10:
-            m_onClick(m_choice);
+            // The callback may release a thread, that deletes this window, so it must not be shown anymore
             WindowManager::GetInstance()->DeregisterWindow(this);
+            m_onClick(m_choice);
             break;
         default:
             break;
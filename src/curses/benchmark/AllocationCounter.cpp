@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+#include "AllocationCounter.h"
+
+/**
+ * The amount of heap allocations since the benchmark has been started.
+ */
+static std::atomic<uint64_t> allocationCount(0);
+
+/**
+ * The amount of heap memory in bytes, that is currently allocated.
+ */
+static std::atomic<int64_t> allocatedBytes(0);
+
+void *operator new(size_t size) {
+    void *memory = malloc(size > 0 ? size : 1);
+
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(malloc_usable_size(memory), std::memory_order_relaxed);
+
+    return memory;
+}
+
+// Not inlined, so that the compiler does not mistake free() for a mismatched deallocation of new'ed memory
+__attribute__((noinline)) void operator delete(void *memory) noexcept {
+    allocatedBytes.fetch_sub(malloc_usable_size(memory), std::memory_order_relaxed);
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept {
+    allocatedBytes.fetch_sub(malloc_usable_size(memory), std::memory_order_relaxed);
+    free(memory);
+}
+
+namespace Curses {
+
+uint64_t AllocationCounter::GetAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+int64_t AllocationCounter::GetAllocatedBytes() {
+    return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+}
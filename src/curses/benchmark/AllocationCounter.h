@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef IBSCANNER_ALLOCATIONCOUNTER_H
+#define IBSCANNER_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+namespace Curses {
+
+/**
+ * Counts the heap allocations of a benchmark and the heap memory, that they occupy.
+ *
+ * Linking AllocationCounter.cpp into a benchmark replaces the global operators new and delete, so that every
+ * allocation made via new is counted. Measurements subtract the values read before and after the measured code.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class AllocationCounter {
+
+public:
+    /**
+     * Get the amount of heap allocations since the benchmark has been started.
+     */
+    static uint64_t GetAllocationCount();
+
+    /**
+     * Get the amount of heap memory in bytes, that is currently allocated via new.
+     */
+    static int64_t GetAllocatedBytes();
+};
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <curses/MenuWindow.h>
+#include <curses/benchmark/AllocationCounter.h>
+
+/**
+ * Receives the data of clicked items, so that the callback functions are not empty.
+ */
+static void *volatile clickedData;
+
+namespace Curses {
+
+/**
+ * Builds the menu of a large fabric in the different ways, that a MenuWindow can be filled, and reports the time,
+ * the heap allocations and the memory needed by each of them:
+ *  - items: A tree of MenuItems with a callback function per item, as it is added with AddItem(MenuItem)
+ *  - nodes+ports: The compact items of all nodes and ports, with a shared click handler
+ *  - nodes: Only the compact items of the nodes; The ports are created, when a node is expanded
+ *
+ * The items are named like the nodes and ports of a fabric. The window is never drawn, so ncurses does not need to
+ * be initialized and no terminal is needed.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class MenuBenchmark {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param nodeCount The amount of nodes
+     * @param portCount The amount of ports per node
+     */
+    MenuBenchmark(uint32_t nodeCount, uint32_t portCount);
+
+    /**
+     * Destructor.
+     */
+    ~MenuBenchmark() = default;
+
+    /**
+     * Build the menu in every way and print the results.
+     */
+    void Run();
+
+private:
+    /**
+     * The ways to fill the menu.
+     */
+    enum Variant {
+        ITEMS,
+        NODES_AND_PORTS,
+        NODES
+    };
+
+    /**
+     * Build the menu in one way and print the results. The window is deleted afterwards.
+     */
+    void Measure(const char *name, Variant variant);
+
+private:
+
+    std::vector<std::string> m_nodeNames;
+    std::vector<std::string> m_portNames;
+
+    // The addresses of the entries serve as the items' data
+    std::vector<char> m_nodes;
+    std::vector<char> m_ports;
+
+    uint32_t m_portCount;
+};
+
+MenuBenchmark::MenuBenchmark(uint32_t nodeCount, uint32_t portCount) :
+        m_nodes(nodeCount),
+        m_ports(static_cast<size_t>(nodeCount) * portCount),
+        m_portCount(portCount) {
+    char name[64];
+
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        snprintf(name, sizeof(name), "node%05u HCA-1", i);
+        m_nodeNames.emplace_back(name);
+    }
+
+    for (uint32_t i = 0; i < portCount; i++) {
+        snprintf(name, sizeof(name), "Port %u", i + 1);
+        m_portNames.emplace_back(name);
+    }
+}
+
+void MenuBenchmark::Run() {
+    Measure("items", ITEMS);
+    Measure("nodes+ports", NODES_AND_PORTS);
+    Measure("nodes", NODES);
+}
+
+void MenuBenchmark::Measure(const char *name, Variant variant) {
+    uint64_t allocations = AllocationCounter::GetAllocationCount();
+    int64_t bytes = AllocationCounter::GetAllocatedBytes();
+    auto start = std::chrono::steady_clock::now();
+
+    auto *window = new MenuWindow(0, 0, 70, 50, "Benchmark");
+
+    window->SetClickHandler([](void *data) { clickedData = data; });
+
+    for (uint32_t i = 0; i < m_nodes.size(); i++) {
+        void *node = &m_nodes[i];
+
+        if (variant == ITEMS) {
+            // Like the scanner used to build its menu: Every item captures the window and its own data
+            MenuItem item(m_nodeNames[i], [window, node] { window->Invalidate(); clickedData = node; }, node);
+
+            for (uint32_t j = 0; j < m_portCount; j++) {
+                void *port = &m_ports[i * m_portCount + j];
+
+                item.AddSubitem(MenuItem(m_portNames[j], [window, port] { window->Invalidate(); clickedData = port; },
+                                         port));
+            }
+
+            window->AddItem(item);
+        } else {
+            window->AddItem(m_nodeNames[i].c_str(), node, variant == NODES && m_portCount > 0);
+
+            for (uint32_t j = 0; variant == NODES_AND_PORTS && j < m_portCount; j++) {
+                window->AddSubitem(node, m_portNames[j].c_str(), &m_ports[i * m_portCount + j]);
+            }
+        }
+    }
+
+    // Build the index of rows, as the first frame would
+    window->GetSelectedData();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    allocations = AllocationCounter::GetAllocationCount() - allocations;
+    bytes = AllocationCounter::GetAllocatedBytes() - bytes;
+
+    delete window;
+
+    printf("%8zu  %8u  %-12s %10.2f %12lu %12.1f %12.1f\n", m_nodes.size(), m_portCount, name,
+           static_cast<double>(elapsed.count()) / 1000000, allocations, static_cast<double>(bytes) / 1024,
+           static_cast<double>(bytes) / m_nodes.size());
+    fflush(stdout);
+}
+
+}
+
+static void printUsage() {
+    printf("Usage: ./menu-benchmark [OPTION...]\n"
+           "Available options:\n"
+           "-n, --nodes\n"
+           "    The amount of nodes (Default: 20000).\n"
+           "-p, --ports\n"
+           "    The amount of ports per node (Default: 1 and 36).\n"
+           "-h, --help\n"
+           "    Show this help message.\n");
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t nodeCount = 20000;
+    std::vector<uint32_t> portCounts = { 1, 36 };
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            printUsage();
+
+            exit(EXIT_SUCCESS);
+        }
+
+        if (i + 1 >= argc) {
+            printUsage();
+
+            printf("\n'%s' requires a parameter!\n", argv[i]);
+
+            exit(EXIT_FAILURE);
+        }
+
+        if (!strcmp(argv[i], "-n") || !strcmp(argv[i], "--nodes")) {
+            nodeCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0));
+        } else if (!strcmp(argv[i], "-p") || !strcmp(argv[i], "--ports")) {
+            portCounts = { static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0)) };
+        } else {
+            printUsage();
+
+            printf("\nUnknown option '%s'!\n", argv[i]);
+
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("%8s  %8s  %-12s %10s %12s %12s %12s\n", "Nodes", "Ports", "Menu", "ms", "allocations", "KiB",
+           "bytes/node");
+
+    for (uint32_t portCount : portCounts) {
+        Curses::MenuBenchmark(nodeCount, portCount).Run();
+    }
+
+    return EXIT_SUCCESS;
+}
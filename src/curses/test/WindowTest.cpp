@@ -1,4 +1,5 @@
 #include <csignal>
+#include <thread>
 #include <curses/WindowManager.h>
 #include <curses/OkMessageWindow.h>
 #include <curses/ListWindow.h>
@@ -25,7 +26,7 @@ int main(int argc, char **argv) {
                                "Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,\n"
                                "Institute of Computer Science, Department Operating Systems\n"
                                "Licensed under GPL v3\n\n"
-                               "Up/Down: Navigate menu\n"
+                               "Up/Down/PageUp/PageDown/Home/End: Navigate menu\n"
                                "Right/Left: Open/Close menu entry\n"
                                "Tab: Switch window", []{});
 
@@ -71,7 +72,9 @@ int main(int argc, char **argv) {
     manager->RegisterWindow(&menuWindow);
     manager->RegisterWindow(&listWindow);
 
-    while(isRunning);
+    while(isRunning) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
 
     // Close Windows
     manager->DeregisterWindow(&messageWindow5);
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <utility>
+#include "CounterDelta.h"
+#include "AlertMonitor.h"
+
+namespace Scanner {
+
+AlertMonitor::PortListener::PortListener(AlertMonitor &monitor, uint32_t index) :
+        m_monitor(monitor),
+        m_index(index) {
+
+}
+
+void AlertMonitor::PortListener::OnSample(const CounterSample &sample) {
+    m_monitor.Evaluate(m_index, sample);
+}
+
+void AlertMonitor::PortListener::OnSampleError(const char *message) {
+    m_monitor.ResetPort(m_index);
+}
+
+AlertMonitor::AlertMonitor(const AlertRules &rules, Sampler &sampler, const Topology &topology, const char *logPath,
+                           std::function<void(bool)> sweepHandler) :
+        m_sampler(sampler),
+        m_topology(topology),
+        m_windowCount(0),
+        m_raisedCount(0),
+        m_isChanged(false),
+        m_log(nullptr),
+        m_isLogDirty(false),
+        m_sweepHandler(std::move(sweepHandler)) {
+    if (logPath != nullptr) {
+        m_log = fopen(logPath, "a");
+
+        if (m_log == nullptr) {
+            throw std::runtime_error(std::string("Unable to open '") + logPath + "': " + strerror(errno));
+        }
+    }
+
+    auto getSlot = [this](CounterId counter) {
+        auto slot = std::find(m_counters.begin(), m_counters.end(), counter);
+
+        if (slot == m_counters.end()) {
+            m_counters.push_back(counter);
+            return static_cast<uint8_t>(m_counters.size() - 1);
+        }
+
+        return static_cast<uint8_t>(slot - m_counters.begin());
+    };
+
+    for (const AlertRules::Rule &rule : rules.GetRules()) {
+        CompiledRule compiled{rule, getSlot(rule.counter), 0, 0};
+
+        if (rule.reference == AlertRules::PACKETS) {
+            compiled.referenceSlot = getSlot(rule.referenceCounter);
+        }
+
+        if (rule.window > 0) {
+            compiled.windowSlot = m_windowCount++;
+        }
+
+        m_rules.push_back(compiled);
+    }
+
+    m_deltas.resize(m_counters.size());
+
+    for (uint32_t i = 0; i < topology.GetDeviceCount(); i++) {
+        const Device &device = topology.GetDevice(i);
+
+        if (!device.IsNode()) {
+            AddPort(&device);
+        }
+    }
+
+    m_sampler.AddSweepCallback([this] { OnSweep(); });
+}
+
+AlertMonitor::~AlertMonitor() {
+    for (PortListener *listener : m_listeners) {
+        m_sampler.Unsubscribe(listener);
+        delete listener;
+    }
+
+    if (m_log != nullptr) {
+        fclose(m_log);
+    }
+}
+
+void AlertMonitor::AddPort(const Device *port) {
+    auto index = static_cast<uint32_t>(m_ports.size());
+
+    m_ports.push_back(Port{port, 0, false});
+    m_previousValues.resize(m_previousValues.size() + m_counters.size());
+    m_windows.resize(m_windows.size() + m_windowCount);
+    m_isRaised.resize(m_isRaised.size() + m_rules.size());
+    m_values.resize(m_values.size() + m_rules.size());
+    m_raisedSince.resize(m_raisedSince.size() + m_rules.size());
+
+    m_listeners.push_back(new PortListener(*this, index));
+    m_sampler.Subscribe(m_listeners.back(), port);
+}
+
+void AlertMonitor::Evaluate(uint32_t index, const CounterSample &sample) {
+    Port &port = m_ports[index];
+    uint64_t *previousValues = &m_previousValues[index * m_counters.size()];
+    bool hasDelta = port.hasValues && sample.timestamp > port.timestamp;
+    double seconds = hasDelta ? (sample.timestamp - port.timestamp) / 1000000000.0 : 0;
+
+    for (size_t slot = 0; slot < m_counters.size(); slot++) {
+        uint64_t value = sample.values[m_counters[slot]];
+
+        m_deltas[slot] = hasDelta ? CounterDelta::GetDelta(previousValues[slot], value) : 0;
+        previousValues[slot] = value;
+    }
+
+    port.timestamp = sample.timestamp;
+    port.hasValues = true;
+
+    for (uint32_t i = 0; i < m_rules.size(); i++) {
+        const CompiledRule &compiled = m_rules[i];
+        const AlertRules::Rule &rule = compiled.rule;
+        double value;
+
+        // The diagnostic counters are only available for local ports
+        if (rule.counter >= PERF_COUNTER_COUNT && !sample.hasDiag) {
+            continue;
+        }
+
+        if (rule.quantity == AlertRules::TOTAL) {
+            value = sample.values[rule.counter];
+        } else if (rule.window > 0) {
+            Window &window = m_windows[index * m_windowCount + compiled.windowSlot];
+
+            value = UpdateWindow(window, m_deltas[compiled.counterSlot], sample.timestamp, rule.window);
+
+            if (rule.quantity == AlertRules::RATE) {
+                value /= rule.window / 1000000000.0;
+            }
+        } else if (hasDelta) {
+            value = rule.quantity == AlertRules::RATE ? m_deltas[compiled.counterSlot] / seconds :
+                    m_deltas[compiled.counterSlot];
+        } else {
+            // The first sample of a port has no delta, so the state of its alerts is kept
+            continue;
+        }
+
+        if (rule.IsPercentage()) {
+            double reference;
+
+            // A rate relates to the reference just like a delta
+            if (rule.quantity == AlertRules::RATE) {
+                value = m_deltas[compiled.counterSlot];
+            }
+
+            if (rule.reference == AlertRules::ELAPSED_TIME) {
+                // Percentages of the elapsed time are never totals, so they are only evaluated with a delta
+                reference = seconds * 1000000000 / XMIT_WAIT_TICK;
+            } else if (rule.quantity == AlertRules::TOTAL) {
+                reference = sample.values[rule.referenceCounter];
+            } else {
+                reference = m_deltas[compiled.referenceSlot];
+            }
+
+            value = reference > 0 ? value * 100 / reference : 0;
+        }
+
+        size_t state = index * m_rules.size() + i;
+        bool isRaised = rule.IsExceeded(value);
+
+        m_values[state] = value;
+
+        if (isRaised != (m_isRaised[state] != 0)) {
+            SetRaised(index, i, isRaised, sample.timestamp);
+        }
+    }
+}
+
+void AlertMonitor::ResetPort(uint32_t index) {
+    Port &port = m_ports[index];
+
+    port.hasValues = false;
+
+    // Alerts of a port, that cannot be sampled temporarily, are kept
+    if (port.device->isPresent) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < m_rules.size(); i++) {
+        if (m_isRaised[index * m_rules.size() + i]) {
+            SetRaised(index, i, false, CounterSample::GetMonotonicTime());
+        }
+    }
+}
+
+void AlertMonitor::SetRaised(uint32_t index, uint32_t rule, bool isRaised, uint64_t timestamp) {
+    size_t state = index * m_rules.size() + rule;
+
+    m_isRaised[state] = isRaised;
+    m_raisedSince[state] = timestamp;
+    m_raisedCount = isRaised ? m_raisedCount + 1 : m_raisedCount - 1;
+    m_isChanged = true;
+
+    if (m_log == nullptr) {
+        return;
+    }
+
+    const Device *port = m_ports[index].device;
+    auto time = static_cast<time_t>((static_cast<int64_t>(timestamp) + m_sampler.GetClockOffset()) / 1000000000);
+    tm localTime{};
+    char timeString[32];
+
+    localtime_r(&time, &localTime);
+    strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", &localTime);
+
+    fprintf(m_log, "%s %s %s / %s (GUID 0x%016lx, LID %u): %s (%s)\n", timeString, isRaised ? "RAISED" : "CLEARED",
+            m_topology.GetDevice(port->nodeId).name.c_str(), port->name.c_str(), port->guid,
+            static_cast<unsigned>(port->lid), m_rules[rule].rule.text.c_str(),
+            FormatValue(Alert{port, rule, m_values[state], timestamp}).c_str());
+
+    m_isLogDirty = true;
+}
+
+uint64_t AlertMonitor::UpdateWindow(Window &window, uint64_t delta, uint64_t timestamp, uint64_t length) {
+    window.accumulated += delta;
+
+    // Checkpoints, that are older than the window, are dropped, except for the newest of them
+    while (window.count > 1 && timestamp >= length &&
+           window.times[(window.first + 1) % CHECKPOINT_COUNT] <= timestamp - length) {
+        window.first = static_cast<uint8_t>((window.first + 1) % CHECKPOINT_COUNT);
+        window.count--;
+    }
+
+    uint8_t last = static_cast<uint8_t>((window.first + window.count + CHECKPOINT_COUNT - 1) % CHECKPOINT_COUNT);
+
+    if (window.count == 0 || timestamp - window.times[last] >= length / (CHECKPOINT_COUNT - 1)) {
+        if (window.count == CHECKPOINT_COUNT) {
+            window.first = static_cast<uint8_t>((window.first + 1) % CHECKPOINT_COUNT);
+            window.count--;
+        }
+
+        uint8_t next = static_cast<uint8_t>((window.first + window.count) % CHECKPOINT_COUNT);
+
+        window.times[next] = timestamp;
+        window.values[next] = window.accumulated;
+        window.count++;
+    }
+
+    return window.accumulated - window.values[window.first];
+}
+
+void AlertMonitor::OnSweep() {
+    if (m_isLogDirty) {
+        fflush(m_log);
+        m_isLogDirty = false;
+    }
+
+    // Nothing to publish, if there have not been any alerts since the last snapshot
+    if (m_raisedCount == 0 && !m_isChanged) {
+        return;
+    }
+
+    std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+    snapshot->alerts.reserve(m_raisedCount);
+
+    for (uint32_t index = 0; index < m_ports.size(); index++) {
+        for (uint32_t rule = 0; rule < m_rules.size(); rule++) {
+            size_t state = index * m_rules.size() + rule;
+
+            if (m_isRaised[state]) {
+                snapshot->alerts.push_back(Alert{m_ports[index].device, rule, m_values[state], m_raisedSince[state]});
+            }
+        }
+    }
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(snapshot));
+
+    bool isChanged = m_isChanged;
+    m_isChanged = false;
+
+    m_sweepHandler(isChanged);
+}
+
+std::string AlertMonitor::FormatValue(const Alert &alert) const {
+    char buffer[32];
+
+    snprintf(buffer, sizeof(buffer), m_rules[alert.rule].rule.IsPercentage() ? "%.2f%%" : "%.2f", alert.value);
+
+    return std::string(buffer);
+}
+
+}
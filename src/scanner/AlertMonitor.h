@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_ALERTMONITOR_H
+#define IBSCANNER_ALERTMONITOR_H
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AlertRules.h"
+#include "Sampler.h"
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * Checks a set of AlertRules against every sample of every port of the fabric.
+ *
+ * All ports are subscribed to the sampler for as long as the monitor exists. The sampling thread evaluates the
+ * compiled rules on each sample. Only the previous values of the counters, that appear in a rule, are kept per port,
+ * so that the state of the whole fabric fits into a few flat arrays. After each sweep, the alerts, that are currently
+ * raised, are published as an immutable snapshot. Raising and clearing an alert can be logged to a file.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class AlertMonitor {
+
+public:
+    /**
+     * A rule, that is exceeded by a port.
+     */
+    struct Alert {
+        const Device *port;
+        uint32_t rule;
+
+        /**
+         * The value, that has been compared to the rule's threshold on the latest sample.
+         */
+        double value;
+
+        /**
+         * The timestamp (CLOCK_MONOTONIC, in nanoseconds) of the sample, that has raised the alert.
+         */
+        uint64_t since;
+    };
+
+    /**
+     * The raised alerts after a sweep.
+     *
+     * Snapshots are never modified after they have been published.
+     */
+    struct Snapshot {
+        std::vector<Alert> alerts;
+    };
+
+    /**
+     * Constructor.
+     *
+     * Throws std::runtime_error, if the log file cannot be opened.
+     *
+     * @param rules The rules
+     * @param sampler The sampler, which refreshes the counters
+     * @param topology The topology, whose ports are checked
+     * @param logPath The file, which raised and cleared alerts are appended to (nullptr to disable logging)
+     * @param sweepHandler Called by the sampling thread after each sweep, that has published a snapshot; The
+     *                     parameter is true, if alerts have been raised or cleared
+     */
+    AlertMonitor(const AlertRules &rules, Sampler &sampler, const Topology &topology, const char *logPath,
+                 std::function<void(bool)> sweepHandler);
+
+    /**
+     * Destructor.
+     *
+     * The sampler must have been stopped before.
+     */
+    ~AlertMonitor();
+
+    AlertMonitor(const AlertMonitor &copy) = delete;
+
+    AlertMonitor& operator=(const AlertMonitor &other) = delete;
+
+    /**
+     * Add a port, that has been found by a rescan.
+     *
+     * Must only be called, while the sampler is paused.
+     *
+     * @param port The port
+     */
+    void AddPort(const Device *port);
+
+    /**
+     * Get the latest snapshot (nullptr, if no alert has been raised yet).
+     */
+    std::shared_ptr<const Snapshot> GetSnapshot() const {
+        return std::atomic_load(&m_snapshot);
+    }
+
+    const AlertRules::Rule &GetRule(uint32_t rule) const {
+        return m_rules[rule].rule;
+    }
+
+    /**
+     * Format an alert's value (e.g. "12.50" or "3.20%").
+     */
+    std::string FormatValue(const Alert &alert) const;
+
+private:
+    /**
+     * Receives the samples of a single port.
+     */
+    class PortListener : public Sampler::Listener {
+
+    public:
+        PortListener(AlertMonitor &monitor, uint32_t index);
+
+        void OnSample(const CounterSample &sample) override;
+
+        void OnSampleError(const char *message) override;
+
+    private:
+
+        AlertMonitor &m_monitor;
+        uint32_t m_index;
+    };
+
+    /**
+     * A rule and the positions of its state inside the per port arrays.
+     */
+    struct CompiledRule {
+        AlertRules::Rule rule;
+        uint8_t counterSlot;
+        uint8_t referenceSlot;
+        uint32_t windowSlot;
+    };
+
+    static const uint8_t CHECKPOINT_COUNT = 16;
+
+    /**
+     * The sliding window of a rule with 'over'.
+     *
+     * The sum of all deltas is checkpointed regularly. The oldest checkpoint, that is not newer than the window's
+     * length, is the window's start, so the window is exact to 1/15 of its length.
+     */
+    struct Window {
+        uint64_t accumulated;
+        uint64_t times[CHECKPOINT_COUNT];
+        uint64_t values[CHECKPOINT_COUNT];
+        uint8_t first;
+        uint8_t count;
+    };
+
+    /**
+     * The state of a single port (only accessed by the sampling thread).
+     */
+    struct Port {
+        const Device *device;
+        uint64_t timestamp;
+        bool hasValues;
+    };
+
+    /**
+     * Evaluate all rules on a sample of a port.
+     */
+    void Evaluate(uint32_t index, const CounterSample &sample);
+
+    /**
+     * Forget the previous sample of a port and clear its alerts, if it has been removed from the fabric.
+     */
+    void ResetPort(uint32_t index);
+
+    /**
+     * Change the state of an alert.
+     */
+    void SetRaised(uint32_t index, uint32_t rule, bool isRaised, uint64_t timestamp);
+
+    /**
+     * Add a delta to a sliding window.
+     *
+     * @return The sum of the deltas inside the window
+     */
+    static uint64_t UpdateWindow(Window &window, uint64_t delta, uint64_t timestamp, uint64_t length);
+
+    /**
+     * Called by the sampler after each sweep.
+     */
+    void OnSweep();
+
+private:
+
+    Sampler &m_sampler;
+    const Topology &m_topology;
+
+    std::vector<CompiledRule> m_rules;
+
+    /**
+     * The counters, whose previous values are kept for each port.
+     */
+    std::vector<CounterId> m_counters;
+    uint32_t m_windowCount;
+
+    std::vector<PortListener*> m_listeners;
+    std::vector<Port> m_ports;
+
+    /**
+     * The per port state; Indexed by port * m_counters.size() + slot, port * m_windowCount + window
+     * and port * m_rules.size() + rule.
+     */
+    std::vector<uint64_t> m_previousValues;
+    std::vector<Window> m_windows;
+    std::vector<uint8_t> m_isRaised;
+    std::vector<double> m_values;
+    std::vector<uint64_t> m_raisedSince;
+
+    std::vector<uint64_t> m_deltas;
+
+    uint32_t m_raisedCount;
+    bool m_isChanged;
+
+    FILE *m_log;
+    bool m_isLogDirty;
+
+    std::function<void(bool)> m_sweepHandler;
+
+    /**
+     * Written by the sampler thread and read by the UI thread.
+     * Must only be accessed via std::atomic_load()/std::atomic_store().
+     */
+    std::shared_ptr<const Snapshot> m_snapshot;
+};
+
+}
+
+#endif
@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "AlertRules.h"
+
+namespace Scanner {
+
+/**
+ * What a percentage of a counter relates to.
+ */
+struct PercentageReference {
+    CounterId counter;
+    AlertRules::Reference reference;
+    CounterId referenceCounter;
+};
+
+/**
+ * The references of all counters in the order of their ids. Errors and discards relate to the packets, that may have
+ * been affected by them, while XmitWait counts ticks and thus relates to the elapsed time.
+ */
+static constexpr PercentageReference percentageReferences[] = {
+        { XMIT_DATA_BYTES, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { RCV_DATA_BYTES, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { XMIT_PKTS, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { RCV_PKTS, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { UNICAST_XMIT_PKTS, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { UNICAST_RCV_PKTS, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { MULTICAST_XMIT_PKTS, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { MULTICAST_RCV_PKTS, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { SYMBOL_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { LINK_DOWNED, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { LINK_RECOVERIES, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { RCV_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { RCV_REMOTE_PHYSICAL_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { RCV_SWITCH_RELAY_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { XMIT_DISCARDS, AlertRules::PACKETS, XMIT_PKTS },
+        { XMIT_CONSTRAINT_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { RCV_CONSTRAINT_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { LOCAL_LINK_INTEGRITY_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { EXCESSIVE_BUFFER_OVERRUN_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { VL15_DROPPED, AlertRules::PACKETS, RCV_PKTS },
+        { XMIT_WAIT, AlertRules::ELAPSED_TIME, COUNTER_COUNT },
+
+        { LIFESPAN, AlertRules::ABSOLUTE_VALUE, COUNTER_COUNT },
+        { RQ_LOCAL_LENGTH_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { RQ_LOCAL_QP_PROTECTION_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { RQ_OUT_OF_SEQUENCE_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { RQ_REMOTE_ACCESS_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { RQ_REMOTE_INVALID_REQUEST_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { RQ_RNR_NAK_NUM, AlertRules::PACKETS, RCV_PKTS },
+        { RQ_COMPLETION_QUEUE_ENTRY_ERRORS, AlertRules::PACKETS, RCV_PKTS },
+        { SQ_BAD_RESPONSE_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_LOCAL_LENGTH_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_LOCAL_PROTECTION_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_LOCAL_QP_PROTECTION_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_MEMORY_WINDOW_BIND_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_OUT_OF_SEQUENCE_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_REMOTE_ACCESS_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_REMOTE_INVALID_REQUEST_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_RNR_NAK_NUM, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_REMOTE_OPERATION_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_RNR_NAK_RETRIES_EXCEEDED_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_TRANSPORT_RETRIES_EXCEEDED_ERRORS, AlertRules::PACKETS, XMIT_PKTS },
+        { SQ_COMPLETION_QUEUE_ENTRY_ERRORS, AlertRules::PACKETS, XMIT_PKTS }
+};
+
+/**
+ * Check, that the table contains every counter at the position of its id.
+ */
+static constexpr bool isReferenceTableComplete(uint32_t index = 0) {
+    return index == COUNTER_COUNT || (percentageReferences[index].counter == index &&
+                                      isReferenceTableComplete(index + 1));
+}
+
+static_assert(sizeof(percentageReferences) / sizeof(percentageReferences[0]) == COUNTER_COUNT,
+              "Every counter needs exactly one reference");
+static_assert(isReferenceTableComplete(), "The references have to be ordered by counter id");
+
+AlertRules::AlertRules(const char *path) {
+    std::ifstream file(path);
+
+    if (!file.is_open()) {
+        throw std::runtime_error(std::string("Unable to open '") + path + "': " + strerror(errno));
+    }
+
+    std::string line;
+    uint32_t lineNumber = 0;
+
+    while (std::getline(file, line)) {
+        lineNumber++;
+
+        std::string::size_type comment = line.find('#');
+
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        try {
+            m_rules.push_back(Compile(line));
+        } catch (const std::runtime_error &exception) {
+            throw std::runtime_error(std::string("'") + path + "', line " + std::to_string(lineNumber) + ": " +
+                                     exception.what());
+        }
+    }
+
+    if (m_rules.empty()) {
+        throw std::runtime_error(std::string("'") + path + "' does not contain any rules!");
+    }
+}
+
+AlertRules::Rule AlertRules::Compile(const std::string &line) {
+    std::istringstream stream(line);
+    std::string counter, quantity, op, threshold, over, duration, rest;
+    Rule rule{};
+
+    stream >> counter >> quantity >> op >> threshold >> over >> duration >> rest;
+
+    if (threshold.empty() || !rest.empty() || (!over.empty() && (over != "over" || duration.empty()))) {
+        throw std::runtime_error("Expected '<counter> <total|delta|rate> <operator> <threshold>[%] "
+                                 "[over <duration>]'!");
+    }
+
+    rule.counter = FindCounter(counter);
+
+    if (rule.counter == COUNTER_COUNT) {
+        throw std::runtime_error("Unknown counter '" + counter + "'!");
+    }
+
+    if (quantity == "total") {
+        rule.quantity = TOTAL;
+    } else if (quantity == "delta") {
+        rule.quantity = DELTA;
+    } else if (quantity == "rate") {
+        rule.quantity = RATE;
+    } else {
+        throw std::runtime_error("Unknown quantity '" + quantity + "'; Expected 'total', 'delta' or 'rate'!");
+    }
+
+    if (op == ">") {
+        rule.op = GREATER;
+    } else if (op == ">=") {
+        rule.op = GREATER_EQUAL;
+    } else if (op == "<") {
+        rule.op = LESS;
+    } else if (op == "<=") {
+        rule.op = LESS_EQUAL;
+    } else {
+        throw std::runtime_error("Unknown operator '" + op + "'; Expected '>', '>=', '<' or '<='!");
+    }
+
+    char *end;
+    rule.threshold = strtod(threshold.c_str(), &end);
+    rule.reference = ABSOLUTE_VALUE;
+    rule.referenceCounter = COUNTER_COUNT;
+
+    if (end == threshold.c_str() || (*end != '\0' && strcmp(end, "%") != 0)) {
+        throw std::runtime_error("Invalid threshold '" + threshold + "'!");
+    }
+
+    if (*end == '%') {
+        const PercentageReference &reference = percentageReferences[rule.counter];
+
+        if (rule.counter == XMIT_DATA_BYTES || rule.counter == RCV_DATA_BYTES) {
+            throw std::runtime_error("A percentage of the data counters is not possible; Use an absolute threshold!");
+        } else if (reference.reference == ABSOLUTE_VALUE) {
+            throw std::runtime_error("A percentage is only possible for error, discard and XmitWait counters, "
+                                     "which have a reference!");
+        } else if (reference.reference == ELAPSED_TIME && rule.quantity == TOTAL) {
+            throw std::runtime_error("A percentage of the elapsed time is only possible for deltas and rates!");
+        }
+
+        rule.reference = reference.reference;
+        rule.referenceCounter = reference.referenceCounter;
+    }
+
+    if (!duration.empty()) {
+        rule.window = ParseDuration(duration);
+
+        if (rule.window == 0) {
+            throw std::runtime_error("Invalid duration '" + duration + "'!");
+        }
+
+        if (rule.quantity == TOTAL || rule.IsPercentage()) {
+            throw std::runtime_error("'over' is only possible for absolute deltas and rates!");
+        }
+    }
+
+    if (rule.counter == LIFESPAN && rule.quantity != TOTAL) {
+        throw std::runtime_error("The lifespan is not a counter; Only its 'total' can be checked!");
+    }
+
+    rule.text = counter + " " + quantity + " " + op + " " + threshold + (duration.empty() ? "" : " over " + duration);
+
+    return rule;
+}
+
+CounterId AlertRules::FindCounter(const std::string &name) {
+    std::string wanted;
+
+    for (char c : name) {
+        if (c != '_') {
+            wanted.push_back(static_cast<char>(tolower(c)));
+        }
+    }
+
+    for (uint8_t id = 0; id < COUNTER_COUNT; id++) {
+        std::string candidate;
+
+        for (const char *c = CounterSample::GetCounterName(static_cast<CounterId>(id)); *c != '\0'; c++) {
+            if (*c != '_') {
+                candidate.push_back(*c);
+            }
+        }
+
+        // The data counters can also be named without their unit (e.g. 'XmitData')
+        if (candidate == wanted || candidate == wanted + "bytes") {
+            return static_cast<CounterId>(id);
+        }
+    }
+
+    return COUNTER_COUNT;
+}
+
+uint64_t AlertRules::ParseDuration(const std::string &duration) {
+    char *end;
+    unsigned long long number = strtoull(duration.c_str(), &end, 10);
+
+    if (end == duration.c_str() || number == 0) {
+        return 0;
+    }
+
+    if (!strcmp(end, "ms")) {
+        return number * 1000000;
+    } else if (!strcmp(end, "s")) {
+        return number * 1000000000;
+    } else if (!strcmp(end, "m")) {
+        return number * 60 * 1000000000;
+    } else if (!strcmp(end, "h")) {
+        return number * 3600 * 1000000000;
+    }
+
+    return 0;
+}
+
+}
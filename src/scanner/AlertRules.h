@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_ALERTRULES_H
+#define IBSCANNER_ALERTRULES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CounterSample.h"
+
+namespace Scanner {
+
+/**
+ * Threshold rules, that are read from a file and compiled into a compact form, which can be evaluated on every
+ * sample without any parsing or lookups.
+ *
+ * Each line of the file contains a single rule:
+ *
+ *     <counter> <total|delta|rate> <operator> <threshold>[%] [over <duration>]
+ *
+ * e.g. "SymbolErrors rate > 0", "XmitWait rate > 10%" or "RcvErrors delta > 100 over 60s".
+ *
+ * Counters are named like in exported data; Case and underscores are ignored (e.g. 'xmit_wait' or 'XmitWait').
+ * The data counters may be named without their unit (e.g. 'XmitData').
+ * The operator is one of '>', '>=', '<' and '<='. A percentage relates error and discard counters to the packets,
+ * that have been sent or received by the port in the same time, and XmitWait to the elapsed time. Other counters
+ * (e.g. the data counters) have no meaningful reference, so percentages of them are rejected. 'over' sums up the
+ * deltas of a sliding window (e.g. '500ms', '60s', '5m' or '1h') instead of a single sample interval.
+ * Empty lines and lines starting with '#' are ignored.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class AlertRules {
+
+public:
+
+    enum Quantity : uint8_t {
+        TOTAL,
+        DELTA,
+        RATE
+    };
+
+    enum Operator : uint8_t {
+        GREATER,
+        GREATER_EQUAL,
+        LESS,
+        LESS_EQUAL
+    };
+
+    /**
+     * What the threshold of a rule relates to.
+     */
+    enum Reference : uint8_t {
+        ABSOLUTE_VALUE,
+        PACKETS,
+        ELAPSED_TIME
+    };
+
+    /**
+     * A compiled rule.
+     */
+    struct Rule {
+        CounterId counter;
+
+        Reference reference;
+
+        /**
+         * The packet counter, that a percentage relates to (only used for PACKETS).
+         */
+        CounterId referenceCounter;
+
+        Quantity quantity;
+        Operator op;
+        double threshold;
+
+        /**
+         * The length of the sliding window in nanoseconds (0 for a single sample interval).
+         */
+        uint64_t window;
+
+        /**
+         * The rule, as it is shown to the user.
+         */
+        std::string text;
+
+        bool IsPercentage() const {
+            return reference != ABSOLUTE_VALUE;
+        }
+
+        bool IsExceeded(double value) const {
+            switch (op) {
+                case GREATER:
+                    return value > threshold;
+                case GREATER_EQUAL:
+                    return value >= threshold;
+                case LESS:
+                    return value < threshold;
+                default:
+                    return value <= threshold;
+            }
+        }
+    };
+
+    /**
+     * Constructor.
+     *
+     * Reads and compiles the rules.
+     * Throws std::runtime_error, if the file cannot be read or contains an invalid rule.
+     *
+     * @param path The rules file
+     */
+    explicit AlertRules(const char *path);
+
+    /**
+     * Destructor.
+     */
+    ~AlertRules() = default;
+
+    const std::vector<Rule> &GetRules() const {
+        return m_rules;
+    }
+
+private:
+    /**
+     * Compile a single line of the rules file.
+     *
+     * Throws std::runtime_error, if the rule is invalid.
+     *
+     * @param line The line without comments
+     */
+    static Rule Compile(const std::string &line);
+
+    /**
+     * Find a counter by its name, ignoring case and underscores.
+     *
+     * @return The counter or COUNTER_COUNT, if there is no such counter
+     */
+    static CounterId FindCounter(const std::string &name);
+
+    /**
+     * Parse a duration like '500ms', '60s', '5m' or '1h'.
+     *
+     * @return The duration in nanoseconds or 0, if the duration is invalid
+     */
+    static uint64_t ParseDuration(const std::string &duration);
+
+private:
+
+    std::vector<Rule> m_rules;
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cstdio>
+#include <utility>
+#include "AlertWindow.h"
+
+namespace Scanner {
+
+AlertWindow::AlertWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, const AlertMonitor &monitor,
+                         const Topology &topology, std::function<void(const Device*)> selectHandler) :
+        ListWindow(posX, posY, width, height, "Alerts (0)"),
+        m_monitor(monitor),
+        m_topology(topology),
+        m_selectHandler(std::move(selectHandler)) {
+
+}
+
+void AlertWindow::DrawContent() {
+    std::shared_ptr<const AlertMonitor::Snapshot> snapshot = m_monitor.GetSnapshot();
+
+    if (snapshot != m_shownSnapshot) {
+        m_items.clear();
+        m_ports.clear();
+
+        if (snapshot != nullptr) {
+            char line[256];
+
+            for (const AlertMonitor::Alert &alert : snapshot->alerts) {
+                std::string port = m_topology.GetDevice(alert.port->nodeId).name + " / " + alert.port->name;
+
+                snprintf(line, sizeof(line), "%-50s %-45s %s", port.c_str(),
+                         m_monitor.GetRule(alert.rule).text.c_str(), m_monitor.FormatValue(alert).c_str());
+
+                m_items.emplace_back(line);
+                m_ports.push_back(alert.port);
+            }
+        }
+
+        // Keep the highlight inside the list, if alerts have been cleared
+        if (m_highlight + m_scrollOffset >= m_items.size()) {
+            m_scrollOffset = 0;
+            m_highlight = m_items.empty() ? 0 : static_cast<uint32_t>(m_items.size() - 1);
+
+            if (m_highlight >= GetHeight()) {
+                m_scrollOffset = static_cast<int32_t>(m_highlight - GetHeight() + 1);
+                m_highlight = GetHeight() - 1;
+            }
+        }
+
+        SetTitle(("Alerts (" + std::to_string(m_items.size()) + ")").c_str());
+
+        m_shownSnapshot = snapshot;
+    }
+
+    ListWindow::DrawContent();
+}
+
+void AlertWindow::HandleKey(int c) {
+    if (m_items.empty()) {
+        Window::HandleKey(c);
+        return;
+    }
+
+    if (c == KEY_ENTER || c == 10) {
+        m_selectHandler(m_ports[m_highlight + m_scrollOffset]);
+        return;
+    }
+
+    ListWindow::HandleKey(c);
+}
+
+}
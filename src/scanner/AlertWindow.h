@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_ALERTWINDOW_H
+#define IBSCANNER_ALERTWINDOW_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <curses/ListWindow.h>
+#include "AlertMonitor.h"
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * ListWindow, which shows all alerts, that are currently raised by an AlertMonitor.
+ *
+ * The lines are only rebuilt, if the monitor has published a new snapshot since the last frame.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class AlertWindow : public Curses::ListWindow {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param posX X-coordinate of upper left corner
+     * @param posY Y-coordinate of upper left corner
+     * @param width The width
+     * @param height The height
+     * @param monitor The monitor, whose alerts are shown
+     * @param topology The topology, that the alerting ports belong to
+     * @param selectHandler Called with the highlighted port, when Enter is pressed
+     */
+    AlertWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, const AlertMonitor &monitor,
+                const Topology &topology, std::function<void(const Device*)> selectHandler);
+
+    /**
+     * Destructor.
+     */
+    ~AlertWindow() override = default;
+
+    /**
+     * Overriding function from ListWindow.
+     */
+    void HandleKey(int c) override;
+
+private:
+    /**
+     * Overriding function from ListWindow.
+     */
+    void DrawContent() override;
+
+private:
+
+    const AlertMonitor &m_monitor;
+    const Topology &m_topology;
+
+    std::function<void(const Device*)> m_selectHandler;
+
+    /**
+     * The snapshot, that m_items have been built from, and the port of each item (only accessed by the UI thread).
+     */
+    std::shared_ptr<const AlertMonitor::Snapshot> m_shownSnapshot;
+    std::vector<const Device*> m_ports;
+};
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cstdio>
+#include "CounterDelta.h"
+
+namespace Scanner {
+
+void CounterDelta::Calculate(const CounterSample &previous, const CounterSample &current) {
+    elapsed = current.timestamp > previous.timestamp ? current.timestamp - previous.timestamp : 0;
+
+    if (elapsed == 0) {
+        for (uint8_t id = 0; id < COUNTER_COUNT; id++) {
+            deltas[id] = 0;
+            rates[id] = 0;
+        }
+
+        return;
+    }
+
+    double seconds = elapsed / 1000000000.0;
+
+    for (uint8_t id = 0; id < COUNTER_COUNT; id++) {
+        deltas[id] = IsGauge(static_cast<CounterId>(id)) ? 0 : GetDelta(previous.values[id], current.values[id]);
+        rates[id] = deltas[id] / seconds;
+    }
+}
+
+uint64_t CounterDelta::GetErrorSum(const CounterSample &sample) {
+    uint64_t sum = 0;
+
+    for (uint8_t id = SYMBOL_ERRORS; id <= VL15_DROPPED; id++) {
+        sum += sample.values[id];
+    }
+
+    return sum;
+}
+
+void CounterDelta::FormatRate(char *buffer, size_t size, double rate, const char *unit, int precision) {
+    static const char prefixes[] = { ' ', 'k', 'M', 'G', 'T', 'P', 'E' };
+    uint8_t prefix = 0;
+
+    while (rate >= 1000 && prefix < sizeof(prefixes) - 1) {
+        rate /= 1000;
+        prefix++;
+    }
+
+    // Rates without a unit are kept as short as possible, so that several of them fit into a line
+    const char *separator = *unit != '\0' ? " " : "";
+
+    if (rate == 0) {
+        snprintf(buffer, size, "0%s%s", separator, unit);
+    } else if (prefix == 0) {
+        snprintf(buffer, size, "%.*f%s%s", precision, rate, separator, unit);
+    } else {
+        snprintf(buffer, size, "%.*f%s%c%s", precision, rate, separator, prefixes[prefix], unit);
+    }
+}
+
+}
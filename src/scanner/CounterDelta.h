@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_COUNTERDELTA_H
+#define IBSCANNER_COUNTERDELTA_H
+
+#include <cstddef>
+#include <cstdint>
+#include "CounterSample.h"
+
+namespace Scanner {
+
+/**
+ * The change of every counter of a device between two consecutive samples.
+ *
+ * A counter, that is smaller than in the previous sample, has been reset in the meantime (e.g. via 'Reset Counters'
+ * or by a reboot of the device). Its delta is counted from zero, so that a reset never produces a negative or huge
+ * rate. Calculating a delta only touches the two samples, so it is cheap enough to be done for every device of
+ * the fabric after each sweep.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+struct CounterDelta {
+
+    uint64_t deltas[COUNTER_COUNT];
+
+    /**
+     * The deltas per second.
+     */
+    double rates[COUNTER_COUNT];
+
+    /**
+     * The time in nanoseconds, that has passed between both samples (0, if there is no previous sample).
+     */
+    uint64_t elapsed;
+
+    /**
+     * Calculate the deltas and rates of all counters.
+     *
+     * If the current sample is not newer than the previous one, all deltas and rates are 0.
+     *
+     * @param previous The previous sample
+     * @param current The current sample
+     */
+    void Calculate(const CounterSample &previous, const CounterSample &current);
+
+    /**
+     * Calculate the delta of a single counter.
+     *
+     * @param previous The counter's previous value
+     * @param current The counter's current value
+     *
+     * @return The delta (the current value, if the counter has been reset)
+     */
+    static uint64_t GetDelta(uint64_t previous, uint64_t current) {
+        return current >= previous ? current - previous : current;
+    }
+
+    /**
+     * Check if a value is a gauge (e.g. the lifespan) instead of a monotonic counter, so that its delta is meaningless.
+     *
+     * @param id The counter
+     */
+    static bool IsGauge(CounterId id) {
+        return id == LIFESPAN;
+    }
+
+    /**
+     * Sum up all error counters (SYMBOL_ERRORS to VL15_DROPPED) of a sample. Congestion (XmitWait) is not an error.
+     *
+     * @param sample The sample
+     */
+    static uint64_t GetErrorSum(const CounterSample &sample);
+
+    /**
+     * Format a rate with a metric prefix (e.g. '1.25 MB/s'). A rate of 0 is shown without decimals.
+     *
+     * @param buffer The buffer, that receives the formatted rate
+     * @param size The buffer's size
+     * @param rate The rate
+     * @param unit The rate's unit (may be empty, to keep the rate as short as possible)
+     * @param precision The amount of decimals
+     */
+    static void FormatRate(char *buffer, size_t size, double rate, const char *unit, int precision = 2);
+};
+
+}
+
+#endif
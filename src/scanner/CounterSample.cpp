@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <ctime>
+#include "CounterSample.h"
+
+namespace Scanner {
+
+static const char *counterNames[COUNTER_COUNT] = {
+        "xmit_data_bytes",
+        "rcv_data_bytes",
+        "xmit_pkts",
+        "rcv_pkts",
+        "unicast_xmit_pkts",
+        "unicast_rcv_pkts",
+        "multicast_xmit_pkts",
+        "multicast_rcv_pkts",
+        "symbol_errors",
+        "link_downed",
+        "link_recoveries",
+        "rcv_errors",
+        "rcv_remote_physical_errors",
+        "rcv_switch_relay_errors",
+        "xmit_discards",
+        "xmit_constraint_errors",
+        "rcv_constraint_errors",
+        "local_link_integrity_errors",
+        "excessive_buffer_overrun_errors",
+        "vl15_dropped",
+        "xmit_wait",
+        "lifespan",
+        "rq_local_length_errors",
+        "rq_local_qp_protection_errors",
+        "rq_out_of_sequence_errors",
+        "rq_remote_access_errors",
+        "rq_remote_invalid_request_errors",
+        "rq_rnr_nak_num",
+        "rq_completion_queue_entry_errors",
+        "sq_bad_response_errors",
+        "sq_local_length_errors",
+        "sq_local_protection_errors",
+        "sq_local_qp_protection_errors",
+        "sq_memory_window_bind_errors",
+        "sq_out_of_sequence_errors",
+        "sq_remote_access_errors",
+        "sq_remote_invalid_request_errors",
+        "sq_rnr_nak_num",
+        "sq_remote_operation_errors",
+        "sq_rnr_nak_retries_exceeded_errors",
+        "sq_transport_retries_exceeded_errors",
+        "sq_completion_queue_entry_errors"
+};
+
+uint64_t CounterSample::GetMonotonicTime() {
+    timespec time{};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+}
+
+const char *CounterSample::GetCounterName(CounterId id) {
+    return id < COUNTER_COUNT ? counterNames[id] : "unknown";
+}
+
+void CounterSample::ReadPerfCounter(const Detector::IbPerfCounter &perfCounter) {
+    values[XMIT_DATA_BYTES] = perfCounter.GetXmitDataBytes();
+    values[RCV_DATA_BYTES] = perfCounter.GetRcvDataBytes();
+    values[XMIT_PKTS] = perfCounter.GetXmitPkts();
+    values[RCV_PKTS] = perfCounter.GetRcvPkts();
+    values[UNICAST_XMIT_PKTS] = perfCounter.GetUnicastXmitPkts();
+    values[UNICAST_RCV_PKTS] = perfCounter.GetUnicastRcvPkts();
+    values[MULTICAST_XMIT_PKTS] = perfCounter.GetMulticastXmitPkts();
+    values[MULTICAST_RCV_PKTS] = perfCounter.GetMulticastRcvPkts();
+    values[SYMBOL_ERRORS] = perfCounter.GetSymbolErrors();
+    values[LINK_DOWNED] = perfCounter.GetLinkDownedCounter();
+    values[LINK_RECOVERIES] = perfCounter.GetLinkRecoveryCounter();
+    values[RCV_ERRORS] = perfCounter.GetRcvErrors();
+    values[RCV_REMOTE_PHYSICAL_ERRORS] = perfCounter.GetRcvRemotePhysicalErrors();
+    values[RCV_SWITCH_RELAY_ERRORS] = perfCounter.GetRcvSwitchRelayErrors();
+    values[XMIT_DISCARDS] = perfCounter.GetXmitDiscards();
+    values[XMIT_CONSTRAINT_ERRORS] = perfCounter.GetXmitConstraintErrors();
+    values[RCV_CONSTRAINT_ERRORS] = perfCounter.GetRcvConstraintErrors();
+    values[LOCAL_LINK_INTEGRITY_ERRORS] = perfCounter.GetLocalLinkIntegrityErrors();
+    values[EXCESSIVE_BUFFER_OVERRUN_ERRORS] = perfCounter.GetExcessiveBufferOverrunErrors();
+    values[VL15_DROPPED] = perfCounter.GetVL15Dropped();
+    values[XMIT_WAIT] = perfCounter.GetXmitWait();
+
+    timestamp = GetMonotonicTime();
+}
+
+void CounterSample::ReadDiagPerfCounter(const Detector::IbDiagPerfCounter &diagPerfCounter) {
+    values[LIFESPAN] = diagPerfCounter.GetLifespan();
+    values[RQ_LOCAL_LENGTH_ERRORS] = diagPerfCounter.GetRqLocalLengthErrors();
+    values[RQ_LOCAL_QP_PROTECTION_ERRORS] = diagPerfCounter.GetRqLocalQpProtectionErrors();
+    values[RQ_OUT_OF_SEQUENCE_ERRORS] = diagPerfCounter.GetRqOutOfSequenceErrors();
+    values[RQ_REMOTE_ACCESS_ERRORS] = diagPerfCounter.GetRqRemoteAccessErrors();
+    values[RQ_REMOTE_INVALID_REQUEST_ERRORS] = diagPerfCounter.GetRqRemoteInvalidRequestErrors();
+    values[RQ_RNR_NAK_NUM] = diagPerfCounter.GetRqRnrNakNum();
+    values[RQ_COMPLETION_QUEUE_ENTRY_ERRORS] = diagPerfCounter.GetRqCompletionQueueEntryErrors();
+    values[SQ_BAD_RESPONSE_ERRORS] = diagPerfCounter.GetSqBadResponseErrors();
+    values[SQ_LOCAL_LENGTH_ERRORS] = diagPerfCounter.GetSqLocalLengthErrors();
+    values[SQ_LOCAL_PROTECTION_ERRORS] = diagPerfCounter.GetSqLocalProtectionErrors();
+    values[SQ_LOCAL_QP_PROTECTION_ERRORS] = diagPerfCounter.GetSqLocalQpProtectionErrors();
+    values[SQ_MEMORY_WINDOW_BIND_ERRORS] = diagPerfCounter.GetSqMemoryWindowBindErrors();
+    values[SQ_OUT_OF_SEQUENCE_ERRORS] = diagPerfCounter.GetSqOutOfSequenceErrors();
+    values[SQ_REMOTE_ACCESS_ERRORS] = diagPerfCounter.GetSqRemoteAccessErrors();
+    values[SQ_REMOTE_INVALID_REQUEST_ERRORS] = diagPerfCounter.GetSqRemoteInvalidRequestErrors();
+    values[SQ_RNR_NAK_NUM] = diagPerfCounter.GetSqRnrNakNum();
+    values[SQ_REMOTE_OPERATION_ERRORS] = diagPerfCounter.GetSqRemoteOperationErrors();
+    values[SQ_RNR_NAK_RETRIES_EXCEEDED_ERRORS] = diagPerfCounter.GetSqRnrNakRetriesExceededErrors();
+    values[SQ_TRANSPORT_RETRIES_EXCEEDED_ERRORS] = diagPerfCounter.GetSqTransportRetriesExceededErrors();
+    values[SQ_COMPLETION_QUEUE_ENTRY_ERRORS] = diagPerfCounter.GetSqCompletionQueueEntryErrors();
+
+    hasDiag = true;
+}
+
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef IBSCANNER_COUNTERSAMPLE_H
+#define IBSCANNER_COUNTERSAMPLE_H
+
+#include <cstdint>
+#include <detector/IbPerfCounter.h>
+#include <detector/IbDiagPerfCounter.h>
+
+namespace Scanner {
+
+/**
+ * Identifies a single counter inside a CounterSample.
+ *
+ * The counters up to PERF_COUNTER_COUNT are provided by the performance management agent (PortCounters and
+ * PortCountersExtended). The remaining counters are only available for local devices (IbDiagPerfCounter).
+ */
+enum CounterId : uint8_t {
+    XMIT_DATA_BYTES,
+    RCV_DATA_BYTES,
+    XMIT_PKTS,
+    RCV_PKTS,
+    UNICAST_XMIT_PKTS,
+    UNICAST_RCV_PKTS,
+    MULTICAST_XMIT_PKTS,
+    MULTICAST_RCV_PKTS,
+    SYMBOL_ERRORS,
+    LINK_DOWNED,
+    LINK_RECOVERIES,
+    RCV_ERRORS,
+    RCV_REMOTE_PHYSICAL_ERRORS,
+    RCV_SWITCH_RELAY_ERRORS,
+    XMIT_DISCARDS,
+    XMIT_CONSTRAINT_ERRORS,
+    RCV_CONSTRAINT_ERRORS,
+    LOCAL_LINK_INTEGRITY_ERRORS,
+    EXCESSIVE_BUFFER_OVERRUN_ERRORS,
+    VL15_DROPPED,
+    XMIT_WAIT,
+    PERF_COUNTER_COUNT,
+
+    LIFESPAN = PERF_COUNTER_COUNT,
+    RQ_LOCAL_LENGTH_ERRORS,
+    RQ_LOCAL_QP_PROTECTION_ERRORS,
+    RQ_OUT_OF_SEQUENCE_ERRORS,
+    RQ_REMOTE_ACCESS_ERRORS,
+    RQ_REMOTE_INVALID_REQUEST_ERRORS,
+    RQ_RNR_NAK_NUM,
+    RQ_COMPLETION_QUEUE_ENTRY_ERRORS,
+    SQ_BAD_RESPONSE_ERRORS,
+    SQ_LOCAL_LENGTH_ERRORS,
+    SQ_LOCAL_PROTECTION_ERRORS,
+    SQ_LOCAL_QP_PROTECTION_ERRORS,
+    SQ_MEMORY_WINDOW_BIND_ERRORS,
+    SQ_OUT_OF_SEQUENCE_ERRORS,
+    SQ_REMOTE_ACCESS_ERRORS,
+    SQ_REMOTE_INVALID_REQUEST_ERRORS,
+    SQ_RNR_NAK_NUM,
+    SQ_REMOTE_OPERATION_ERRORS,
+    SQ_RNR_NAK_RETRIES_EXCEEDED_ERRORS,
+    SQ_TRANSPORT_RETRIES_EXCEEDED_ERRORS,
+    SQ_COMPLETION_QUEUE_ENTRY_ERRORS,
+    COUNTER_COUNT
+};
+
+/**
+ * The duration of a single XmitWait tick in nanoseconds.
+ *
+ * The specification leaves the length of a tick to the implementation, so one microsecond is assumed.
+ */
+static constexpr uint64_t XMIT_WAIT_TICK = 1000;
+
+/**
+ * The values of all counters of a single device, taken at one point in time.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+struct CounterSample {
+
+    uint64_t values[COUNTER_COUNT];
+
+    /**
+     * The point in time (CLOCK_MONOTONIC, in nanoseconds), at which the counters have been read.
+     */
+    uint64_t timestamp;
+
+    bool hasDiag;
+
+    /**
+     * Get the current time of CLOCK_MONOTONIC in nanoseconds.
+     */
+    static uint64_t GetMonotonicTime();
+
+    /**
+     * Get the name of a counter (e.g. "xmit_data_bytes"), as used in exported data.
+     *
+     * @param id The counter
+     */
+    static const char *GetCounterName(CounterId id);
+
+    /**
+     * Copy the values of a performance counter into this sample and stamp it with the current time.
+     *
+     * @param perfCounter The performance counter
+     */
+    void ReadPerfCounter(const Detector::IbPerfCounter &perfCounter);
+
+    /**
+     * Copy the values of a diagnostic performance counter into this sample.
+     *
+     * @param diagPerfCounter The diagnostic performance counter
+     */
+    void ReadDiagPerfCounter(const Detector::IbDiagPerfCounter &diagPerfCounter);
+};
+
+}
+
+#endif
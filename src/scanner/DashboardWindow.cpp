@@ -0,0 +1,428 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "CounterDelta.h"
+#include "DashboardWindow.h"
+
+namespace Scanner {
+
+/**
+ * The minimum width of a tile.
+ */
+static const uint32_t TILE_WIDTH = 34;
+
+/**
+ * The amount of lines of a tile (name, throughput and error rates).
+ */
+static const uint32_t TILE_HEIGHT = 3;
+
+/**
+ * The amount of spaces between two tiles.
+ */
+static const uint32_t TILE_GAP = 2;
+
+/**
+ * The maximum width of a line, that is drawn.
+ */
+static const uint32_t MAX_LINE_WIDTH = 512;
+
+/**
+ * The maximum amount of tiles, that are shown side by side.
+ */
+static const uint32_t MAX_COLUMNS = MAX_LINE_WIDTH / (TILE_WIDTH + TILE_GAP);
+
+DashboardWindow::Tile::Tile(const Device *port) :
+        row{},
+        values{},
+        timestamp(0),
+        hasValues(false) {
+    row.device = port;
+}
+
+void DashboardWindow::Tile::OnSample(const CounterSample &sample) {
+    uint64_t current[METRIC_COUNT] = {
+            sample.values[XMIT_DATA_BYTES],
+            sample.values[RCV_DATA_BYTES],
+            // Discards are shown on their own
+            CounterDelta::GetErrorSum(sample) - sample.values[XMIT_DISCARDS],
+            sample.values[XMIT_DISCARDS],
+            sample.values[XMIT_WAIT]
+    };
+
+    if (hasValues && sample.timestamp > timestamp) {
+        double elapsed = (sample.timestamp - timestamp) / 1000000000.0;
+
+        for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
+            row.rates[metric] = CounterDelta::GetDelta(values[metric], current[metric]) / elapsed;
+        }
+
+        row.hasRates = true;
+    }
+
+    memcpy(values, current, sizeof(values));
+    timestamp = sample.timestamp;
+    hasValues = true;
+    row.hasError = false;
+}
+
+void DashboardWindow::Tile::OnSampleError(const char *message) {
+    hasValues = false;
+    row.hasRates = false;
+    row.hasError = true;
+}
+
+void DashboardWindow::Tile::Reset() {
+    hasValues = false;
+    row.hasRates = false;
+    row.hasError = false;
+}
+
+DashboardWindow::DashboardWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, Sampler &sampler,
+                                 const Topology &topology, std::function<void(const Device*)> selectHandler) :
+        SampledWindow(posX, posY, width, height, "Dashboard", sampler),
+        m_topology(topology),
+        m_selectHandler(std::move(selectHandler)),
+        m_layout(std::make_shared<std::vector<Tile*>>()),
+        m_highlight(0),
+        m_scrollRow(0),
+        m_columnCount(1),
+        m_rowCount(1) {
+    m_sampler.AddSweepCallback([this] { OnSweep(); });
+}
+
+DashboardWindow::~DashboardWindow() {
+    SetActive(false);
+
+    for (Tile *tile : m_tiles) {
+        delete tile;
+    }
+}
+
+bool DashboardWindow::HasTile(const Device *port) const {
+    return std::any_of(m_tiles.begin(), m_tiles.end(), [port](const Tile *tile) { return tile->row.device == port; });
+}
+
+void DashboardWindow::AddTile(const Device *port) {
+    if (HasTile(port)) {
+        return;
+    }
+
+    auto *tile = new Tile(port);
+
+    m_tiles.push_back(tile);
+    PublishLayout();
+
+    if (m_isActive) {
+        m_sampler.Subscribe(tile, port);
+        m_sampler.RequestSample();
+    }
+
+    Invalidate();
+}
+
+void DashboardWindow::RemoveTile(const Device *port) {
+    auto position = std::find_if(m_tiles.begin(), m_tiles.end(), [port](const Tile *tile) {
+        return tile->row.device == port;
+    });
+
+    if (position == m_tiles.end()) {
+        return;
+    }
+
+    Tile *tile = *position;
+
+    m_tiles.erase(position);
+    PublishLayout();
+
+    // The sampling thread holds the sampler's lock, while it notifies the tiles and collects their rates.
+    // So after unsubscribing, the sampling thread only sees the new layout and the tile can be deleted.
+    m_sampler.Unsubscribe(tile);
+    delete tile;
+
+    Invalidate();
+}
+
+void DashboardWindow::ResetValues() {
+    for (const Tile *tile : m_tiles) {
+        m_sampler.ResetCounter(tile->row.device);
+    }
+}
+
+void DashboardWindow::PublishLayout() {
+    std::shared_ptr<const std::vector<Tile*>> layout = std::make_shared<std::vector<Tile*>>(m_tiles);
+
+    std::atomic_store(&m_layout, layout);
+}
+
+void DashboardWindow::ResetRates() {
+    for (Tile *tile : m_tiles) {
+        tile->Reset();
+    }
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>());
+}
+
+void DashboardWindow::ForEachListener(const std::function<void(Sampler::Listener*, const Device*)> &function) {
+    for (Tile *tile : m_tiles) {
+        function(tile, tile->row.device);
+    }
+}
+
+void DashboardWindow::OnSweep() {
+    if (!m_isActive) {
+        return;
+    }
+
+    std::shared_ptr<const std::vector<Tile*>> layout = std::atomic_load(&m_layout);
+    std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+    snapshot->errorCount = 0;
+    snapshot->unreachableCount = 0;
+
+    snapshot->rows.reserve(layout->size());
+
+    for (const Tile *tile : *layout) {
+        const Row &row = tile->row;
+
+        if (row.hasError) {
+            snapshot->unreachableCount++;
+        } else if (row.hasRates && (row.rates[ERRORS] > 0 || row.rates[DISCARDS] > 0)) {
+            snapshot->errorCount++;
+        }
+
+        snapshot->rows.push_back(row);
+    }
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(snapshot));
+
+    Invalidate();
+}
+
+bool DashboardWindow::FormatTileLine(char *buffer, size_t size, uint32_t line, const Device *port,
+                                     const Row *row) const {
+    char first[16], second[16], third[16];
+
+    if (line == 0) {
+        snprintf(buffer, size, "%s / %s", m_topology.GetDevice(port->nodeId).name.c_str(), port->name.c_str());
+
+        return false;
+    }
+
+    if (!port->isPresent) {
+        snprintf(buffer, size, "%s", line == 1 ? "Removed from the fabric" : "");
+
+        return false;
+    }
+
+    if (row == nullptr || (!row->hasRates && !row->hasError)) {
+        snprintf(buffer, size, "%s", line == 1 ? "Waiting for samples..." : "");
+
+        return false;
+    }
+
+    if (row->hasError) {
+        snprintf(buffer, size, "%s", line == 1 ? "Unreachable" : "");
+
+        return true;
+    }
+
+    if (line == 1) {
+        CounterDelta::FormatRate(first, sizeof(first), row->rates[XMIT], "B/s", 2);
+        CounterDelta::FormatRate(second, sizeof(second), row->rates[RCV], "B/s", 2);
+
+        snprintf(buffer, size, "Tx %-11s Rx %s", first, second);
+
+        return false;
+    }
+
+    CounterDelta::FormatRate(first, sizeof(first), row->rates[ERRORS], "", 1);
+    CounterDelta::FormatRate(second, sizeof(second), row->rates[DISCARDS], "", 1);
+    CounterDelta::FormatRate(third, sizeof(third), row->rates[WAIT], "", 1);
+
+    snprintf(buffer, size, "Err %-6s Dsc %-6s Wait %s", first, second, third);
+
+    return row->rates[ERRORS] > 0 || row->rates[DISCARDS] > 0;
+}
+
+void DashboardWindow::DrawContent() {
+    Window::DrawContent();
+
+    m_shownSnapshot = std::atomic_load(&m_snapshot);
+
+    uint32_t width = std::min(GetWidth(), MAX_LINE_WIDTH);
+    uint32_t height = GetHeight();
+    uint32_t tileCount = GetTileCount();
+    char text[MAX_LINE_WIDTH + 1];
+    chtype line[MAX_LINE_WIDTH];
+
+    if (tileCount == 0) {
+        PrintLineAt(0, "No tiles; Press 'd' in the menu to add the selected port or all ports of a node");
+    } else if (m_shownSnapshot == nullptr) {
+        PrintLineAt(0, "Waiting for the first sweep...");
+    } else {
+        snprintf(text, sizeof(text), "%u tiles, %u with errors, %u unreachable (rates per second)", tileCount,
+                 m_shownSnapshot->errorCount, m_shownSnapshot->unreachableCount);
+        PrintLineAt(0, text);
+    }
+
+    // As many tiles as possible are shown side by side and share the remaining width
+    m_columnCount = std::max(1u, std::min((width + TILE_GAP) / (TILE_WIDTH + TILE_GAP), MAX_COLUMNS));
+    m_rowCount = std::max(1u, (height > 0 ? height - 1 : 0) / TILE_HEIGHT);
+
+    uint32_t tileWidth = width >= TILE_WIDTH ? (width + TILE_GAP) / m_columnCount - TILE_GAP : width;
+
+    // Tiles may have been removed and the window may have become smaller since the last frame
+    if (m_highlight >= tileCount) {
+        m_highlight = tileCount > 0 ? tileCount - 1 : 0;
+    }
+
+    ScrollTo(m_highlight / m_columnCount, m_scrollRow, m_rowCount);
+
+    // The snapshot lists the tiles in the same order, apart from those added or removed since the last sweep
+    static const std::vector<Row> noRows;
+    const std::vector<Row> &rows = m_shownSnapshot != nullptr ? m_shownSnapshot->rows : noRows;
+    size_t nextRow = 0;
+
+    auto findRow = [&](const Device *port) -> const Row* {
+        for (size_t i = nextRow; i < rows.size(); i++) {
+            if (rows[i].device == port) {
+                nextRow = i + 1;
+
+                return &rows[i];
+            }
+        }
+
+        return nullptr;
+    };
+
+    for (uint32_t i = 0; i < m_scrollRow * m_columnCount && i < tileCount; i++) {
+        findRow(m_tiles[i]->row.device);
+    }
+
+    uint32_t y = 1;
+
+    for (uint32_t tileRow = m_scrollRow; tileRow < m_scrollRow + m_rowCount; tileRow++) {
+        uint32_t first = tileRow * m_columnCount;
+        uint32_t last = std::min(first + m_columnCount, tileCount);
+        const Row *tileRows[MAX_COLUMNS] = {};
+
+        for (uint32_t i = first; i < last; i++) {
+            tileRows[i - first] = findRow(m_tiles[i]->row.device);
+        }
+
+        for (uint32_t tileLine = 0; tileLine < TILE_HEIGHT && y < height; tileLine++, y++) {
+            uint32_t length = 0;
+
+            for (uint32_t i = first; i < last; i++) {
+                const Device *port = m_tiles[i]->row.device;
+                bool hasErrors = FormatTileLine(text, tileWidth + 1, tileLine, port, tileRows[i - first]);
+                chtype attr = A_NORMAL;
+
+                if (tileLine == 0) {
+                    attr = i == m_highlight ? A_BOLD | A_REVERSE : A_BOLD;
+                } else if (hasErrors) {
+                    attr = A_BOLD;
+                }
+
+                if (i > first) {
+                    for (uint32_t gap = 0; gap < TILE_GAP && length < width; gap++) {
+                        line[length++] = ' ';
+                    }
+                }
+
+                // The name is padded to the tile's width, so that the highlight covers the entire tile
+                size_t textLength = strlen(text);
+
+                for (uint32_t x = 0; x < tileWidth && length < width; x++) {
+                    line[length++] = static_cast<unsigned char>(x < textLength ? text[x] : ' ') | attr;
+                }
+            }
+
+            PrintLineAt(y, line, length);
+        }
+    }
+
+    for (; y < height; y++) {
+        PrintLineAt(y, "");
+    }
+}
+
+void DashboardWindow::HandleKey(int c) {
+    uint32_t tileCount = GetTileCount();
+    uint32_t pageSize = m_columnCount * m_rowCount;
+    uint32_t position = m_highlight;
+
+    switch (c) {
+        case KEY_LEFT:
+            position = position > 0 ? position - 1 : 0;
+            break;
+        case KEY_RIGHT:
+            position++;
+            break;
+        case KEY_UP:
+            position = position >= m_columnCount ? position - m_columnCount : position;
+            break;
+        case KEY_DOWN:
+            position = position + m_columnCount < tileCount ? position + m_columnCount : position;
+            break;
+        case KEY_PPAGE:
+            position = position > pageSize ? position - pageSize : 0;
+            break;
+        case KEY_NPAGE:
+            position += pageSize;
+            break;
+        case KEY_HOME:
+            position = 0;
+            break;
+        case KEY_END:
+            position = tileCount;
+            break;
+        case KEY_DC:
+        case 'x':
+            if (position < tileCount) {
+                RemoveTile(m_tiles[position]->row.device);
+                tileCount--;
+            }
+            break;
+        case KEY_ENTER:
+        case 10:
+            if (position < tileCount) {
+                m_selectHandler(m_tiles[position]->row.device);
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (position >= tileCount) {
+        position = tileCount > 0 ? tileCount - 1 : 0;
+    }
+
+    ScrollTo(position / m_columnCount, m_scrollRow, m_rowCount);
+
+    m_highlight = position;
+
+    Window::HandleKey(c);
+
+    Invalidate();
+}
+
+}
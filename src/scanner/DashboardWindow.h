@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_DASHBOARDWINDOW_H
+#define IBSCANNER_DASHBOARDWINDOW_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "SampledWindow.h"
+
+namespace Scanner {
+
+/**
+ * Window, which shows many ports side by side as compact tiles (throughput and the most important error rates).
+ *
+ * The tiles are laid out in as many columns as fit into the window and scrolled by rows, if there are more tiles
+ * than rows. Every tile is a listener of the shared sampler, so all tiles are refreshed by the same sweep and a tile
+ * only adds one more subscription and one more row to the published snapshot. After each sweep, the sampling thread
+ * publishes the rates of all tiles as an immutable snapshot, so drawing never has to wait for the sampler.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class DashboardWindow : public SampledWindow {
+
+public:
+    /**
+     * Constructor.
+     *
+     * Must be called before the sampler is started.
+     *
+     * @param posX X-coordinate of upper left corner
+     * @param posY Y-coordinate of upper left corner
+     * @param width The width
+     * @param height The height
+     * @param sampler The sampler, which refreshes the counters
+     * @param topology The topology, whose node names are shown
+     * @param selectHandler Called with the highlighted port, when Enter is pressed
+     */
+    DashboardWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, Sampler &sampler,
+                    const Topology &topology, std::function<void(const Device*)> selectHandler);
+
+    /**
+     * Destructor.
+     */
+    ~DashboardWindow() override;
+
+    /**
+     * Check, if a port is shown by a tile.
+     *
+     * @param port The port
+     */
+    bool HasTile(const Device *port) const;
+
+    /**
+     * Append a tile, that shows a port (ignored, if the port already has a tile).
+     *
+     * @param port The port
+     */
+    void AddTile(const Device *port);
+
+    /**
+     * Remove the tile of a port.
+     *
+     * @param port The port
+     */
+    void RemoveTile(const Device *port);
+
+    /**
+     * Get the amount of tiles.
+     */
+    uint32_t GetTileCount() const {
+        return static_cast<uint32_t>(m_tiles.size());
+    }
+
+    /**
+     * Reset the counters of all ports, that are shown by a tile.
+     */
+    void ResetValues();
+
+    /**
+     * Overriding function from Window.
+     */
+    void HandleKey(int c) override;
+
+private:
+    /**
+     * The rates, that are shown by each tile.
+     */
+    enum Metric : uint8_t {
+        XMIT,
+        RCV,
+        ERRORS,
+        DISCARDS,
+        WAIT,
+        METRIC_COUNT
+    };
+
+    /**
+     * The rates of a single tile.
+     */
+    struct Row {
+        const Device *device;
+        double rates[METRIC_COUNT];
+        bool hasRates;
+        bool hasError;
+    };
+
+    /**
+     * A single tile, which receives the samples of its port.
+     *
+     * The state is only accessed by the sampling thread, while the tile is part of the published layout.
+     */
+    class Tile : public Sampler::Listener {
+
+    public:
+        explicit Tile(const Device *port);
+
+        void OnSample(const CounterSample &sample) override;
+
+        void OnSampleError(const char *message) override;
+
+        /**
+         * Forget the previous sample, so that no rate is calculated across a gap in sampling.
+         */
+        void Reset();
+
+    public:
+
+        Row row;
+        uint64_t values[METRIC_COUNT];
+        uint64_t timestamp;
+        bool hasValues;
+    };
+
+    /**
+     * The rates of all tiles after a sweep.
+     *
+     * Snapshots are never modified after they have been published.
+     */
+    struct Snapshot {
+        std::vector<Row> rows;
+        uint32_t errorCount;
+        uint32_t unreachableCount;
+    };
+
+    /**
+     * Publish the current tiles to the sampling thread.
+     */
+    void PublishLayout();
+
+    /**
+     * Called by the sampler after each sweep.
+     */
+    void OnSweep();
+
+    /**
+     * Overriding function from SampledWindow.
+     */
+    void ResetRates() override;
+
+    /**
+     * Overriding function from SampledWindow.
+     */
+    void ForEachListener(const std::function<void(Sampler::Listener*, const Device*)> &function) override;
+
+    /**
+     * Format a single line of a tile.
+     *
+     * @param buffer The buffer, that receives the line
+     * @param size The buffer's size
+     * @param line The line's index inside the tile
+     * @param port The tile's port
+     * @param row The tile's rates (nullptr, if the tile is not part of the shown snapshot yet)
+     *
+     * @return true, if the line shall be highlighted, because the port has errors
+     */
+    bool FormatTileLine(char *buffer, size_t size, uint32_t line, const Device *port, const Row *row) const;
+
+    /**
+     * Overriding function from Window.
+     */
+    void DrawContent() override;
+
+private:
+
+    const Topology &m_topology;
+
+    std::function<void(const Device*)> m_selectHandler;
+
+    /**
+     * The tiles in the order, in which they are shown (only accessed by the UI thread).
+     */
+    std::vector<Tile*> m_tiles;
+
+    /**
+     * The tiles, that the sampling thread collects the rates of.
+     * Must only be accessed via std::atomic_load()/std::atomic_store().
+     */
+    std::shared_ptr<const std::vector<Tile*>> m_layout;
+
+    /**
+     * Written by the sampler thread and read by the UI thread.
+     * Must only be accessed via std::atomic_load()/std::atomic_store().
+     */
+    std::shared_ptr<const Snapshot> m_snapshot;
+
+    /**
+     * The snapshot, that is shown (only accessed by the UI thread).
+     */
+    std::shared_ptr<const Snapshot> m_shownSnapshot;
+
+    uint32_t m_highlight;
+    uint32_t m_scrollRow;
+    uint32_t m_columnCount;
+    uint32_t m_rowCount;
+};
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <thread>
+#include "FakePmaTransport.h"
+
+namespace Scanner {
+
+FakePmaTransport::FakePmaTransport(uint32_t roundTripTime, uint32_t serializationTime, double lossRate) :
+        m_roundTripTime(roundTripTime),
+        m_serializationTime(serializationTime),
+        m_startTime(std::chrono::steady_clock::now()),
+        m_wireFree(m_startTime),
+        m_random(std::random_device()()),
+        m_loss(lossRate) {
+
+}
+
+bool FakePmaTransport::Send(uint32_t tid, uint16_t lid, uint8_t portNum, PmaAttribute attribute) {
+    auto now = std::chrono::steady_clock::now();
+
+    // Queries are serialized one after another on the simulated wire
+    m_wireFree = (m_wireFree > now ? m_wireFree : now) + m_serializationTime;
+
+    if (!m_loss(m_random)) {
+        m_pending.push(PendingResponse{m_wireFree + m_roundTripTime, tid, lid, portNum, attribute});
+    }
+
+    return true;
+}
+
+bool FakePmaTransport::Receive(PmaResponse &response, uint32_t timeout) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    if (m_pending.empty() || m_pending.top().due > deadline) {
+        std::this_thread::sleep_until(deadline);
+
+        return false;
+    }
+
+    PendingResponse pending = m_pending.top();
+    m_pending.pop();
+
+    std::this_thread::sleep_until(pending.due);
+
+    response.tid = pending.tid;
+    response.attribute = pending.attribute;
+    response.success = true;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(pending.due - m_startTime).count();
+
+    GenerateCounters(pending.lid, pending.portNum, static_cast<uint64_t>(elapsed), response);
+
+    return true;
+}
+
+uint64_t FakePmaTransport::GetElapsedTime() const {
+    auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+void FakePmaTransport::GenerateCounters(uint16_t lid, uint8_t portNum, uint64_t elapsed, PmaResponse &response) {
+    // Every port gets its own constant rate between 1 MB/s and 100 MB/s
+    uint64_t rate = ((lid * 31u + portNum) % 100 + 1) * 1000000;
+    uint64_t bytes = rate * elapsed / 1000000;
+
+    for (uint64_t &value : response.values) {
+        value = 0;
+    }
+
+    response.values[XMIT_DATA_BYTES] = bytes;
+    response.values[RCV_DATA_BYTES] = bytes / 2;
+    response.values[XMIT_PKTS] = bytes / 2048;
+    response.values[RCV_PKTS] = bytes / 4096;
+    response.values[UNICAST_XMIT_PKTS] = bytes / 2048;
+    response.values[UNICAST_RCV_PKTS] = bytes / 4096;
+}
+
+}
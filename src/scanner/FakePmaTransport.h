@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef IBSCANNER_FAKEPMATRANSPORT_H
+#define IBSCANNER_FAKEPMATRANSPORT_H
+
+#include <chrono>
+#include <queue>
+#include <random>
+#include <vector>
+#include "PmaTransport.h"
+
+namespace Scanner {
+
+/**
+ * PmaTransport with an in-process fake performance management agent.
+ *
+ * Each query occupies a simulated wire for the serialization time and is answered after an additional round trip
+ * time. Queries can be dropped randomly to exercise timeouts. No InfiniBand hardware is needed, so that the
+ * PmaQueryEngine can be benchmarked and tested on any machine.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class FakePmaTransport : public PmaTransport {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param roundTripTime The simulated round trip time in microseconds
+     * @param serializationTime The time in microseconds needed to put a single MAD on the wire
+     * @param lossRate The probability for a query to be lost (0.0 - 1.0)
+     */
+    explicit FakePmaTransport(uint32_t roundTripTime = 20, uint32_t serializationTime = 1, double lossRate = 0);
+
+    /**
+     * Destructor.
+     */
+    ~FakePmaTransport() override = default;
+
+    /**
+     * Overriding function from PmaTransport.
+     */
+    bool Send(uint32_t tid, uint16_t lid, uint8_t portNum, PmaAttribute attribute) override;
+
+    /**
+     * Overriding function from PmaTransport.
+     */
+    bool Receive(PmaResponse &response, uint32_t timeout) override;
+
+protected:
+    /**
+     * Generate the counters of a port.
+     *
+     * The default implementation lets the data counters of every port grow at a constant rate.
+     *
+     * @param lid The port's LID
+     * @param portNum The port number
+     * @param elapsed The time in microseconds since the transport has been created
+     * @param response Receives the counters
+     */
+    virtual void GenerateCounters(uint16_t lid, uint8_t portNum, uint64_t elapsed, PmaResponse &response);
+
+    /**
+     * Get the time in microseconds since the transport has been created (the same clock as in GenerateCounters()).
+     */
+    uint64_t GetElapsedTime() const;
+
+private:
+
+    struct PendingResponse {
+        std::chrono::steady_clock::time_point due;
+        uint32_t tid;
+        uint16_t lid;
+        uint8_t portNum;
+        PmaAttribute attribute;
+
+        bool operator>(const PendingResponse &other) const {
+            return due > other.due;
+        }
+    };
+
+    std::priority_queue<PendingResponse, std::vector<PendingResponse>, std::greater<PendingResponse>> m_pending;
+
+    std::chrono::microseconds m_roundTripTime;
+    std::chrono::microseconds m_serializationTime;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_wireFree;
+
+    std::minstd_rand m_random;
+    std::bernoulli_distribution m_loss;
+};
+
+}
+
+#endif
@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <detector/exception/IbMadException.h>
+#include <detector/exception/IbFileException.h>
+#include "CounterDelta.h"
+#include "HeadlessScanner.h"
+
+namespace Scanner {
+
+HeadlessScanner::Target::Target(HeadlessScanner &scanner, const Device *device) :
+        m_scanner(scanner),
+        m_device(device),
+        m_node(&scanner.m_topology.GetDevice(device->nodeId)),
+        m_lastSample{},
+        m_hasLastSample(false) {
+
+}
+
+void HeadlessScanner::Target::OnSample(const CounterSample &sample) {
+    if (m_scanner.m_isDone) {
+        return;
+    }
+
+    uint64_t rates[sizeof(SampleWriter::RATE_COUNTERS) / sizeof(SampleWriter::RATE_COUNTERS[0])] = {};
+
+    if (m_hasLastSample && sample.timestamp > m_lastSample.timestamp) {
+        CounterDelta delta{};
+        delta.Calculate(m_lastSample, sample);
+
+        for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+            rates[i] = static_cast<uint64_t>(delta.rates[SampleWriter::RATE_COUNTERS[i]]);
+        }
+    }
+
+    m_scanner.m_writer->WriteSample(m_scanner.ToWallClockTime(sample.timestamp), m_node->name.c_str(),
+                                    m_device->guid, m_device->lid, m_device->portNum, sample, rates);
+
+    m_lastSample = sample;
+    m_hasLastSample = true;
+}
+
+void HeadlessScanner::Target::OnSampleError(const char *message) {
+    if (m_scanner.m_isDone) {
+        return;
+    }
+
+    m_scanner.m_writer->WriteError(m_scanner.ToWallClockTime(CounterSample::GetMonotonicTime()),
+                                   m_node->name.c_str(), m_device->guid, m_device->lid, m_device->portNum, message);
+
+    m_hasLastSample = false;
+}
+
+HeadlessScanner::HeadlessScanner(bool network, bool compatibility, uint32_t maxOutstanding,
+                                 uint32_t refreshInterval, SimulatedFabric *simulation) :
+        m_fabric(nullptr),
+        m_sampler(refreshInterval),
+        m_pmaConnection(nullptr),
+        m_simulation(simulation),
+        m_recorder(nullptr),
+        m_exporter(nullptr),
+        m_writer(nullptr),
+        m_network(network),
+        m_compatibility(compatibility),
+        m_maxOutstanding(maxOutstanding),
+        m_sweepCount(0),
+        m_sweepsWritten(0),
+        m_isDone(false),
+        m_mainThread(pthread_self()) {
+
+}
+
+HeadlessScanner::~HeadlessScanner() {
+    m_sampler.Stop();
+
+    delete m_recorder;
+    delete m_exporter;
+
+    for (Target *target : m_targets) {
+        delete target;
+    }
+
+    delete m_writer;
+
+    delete m_pmaConnection;
+    delete m_simulation;
+
+    delete m_fabric;
+}
+
+int HeadlessScanner::Run(const char *targets, const char *outputPath, SampleWriter::Format format,
+                         uint64_t sweepCount, const char *recordPath, const char *exportAddress) {
+    // Block the signals, that stop sampling, in all threads, so that they can be received via sigwait().
+    // SIGPIPE is included, so that a closed pipe does not kill the process before the output has been flushed.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGPIPE);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    m_mainThread = pthread_self();
+    m_sweepCount = sweepCount;
+
+    std::vector<DiscoveredNode> nodes;
+
+    if (m_simulation != nullptr) {
+        nodes = m_simulation->Discover();
+    } else {
+        try {
+            m_fabric = new Detector::IbFabric(m_network, m_compatibility);
+        } catch (const Detector::IbMadException &exception) {
+            fprintf(stderr, "An error occurred, while scanning the fabric: %s\n"
+                            "You probably don't have root privileges. Try '--mode compat'.\n", exception.what());
+            return EXIT_FAILURE;
+        } catch (const Detector::IbFileException &exception) {
+            fprintf(stderr, "An error occurred, while scanning the fabric: %s\n", exception.what());
+            return EXIT_FAILURE;
+        }
+
+        nodes = Topology::ListNodes(*m_fabric);
+    }
+
+    for (const DiscoveredNode &node : nodes) {
+        uint32_t nodeId = m_topology.AddNode(node.guid, node.description, node.lid, node.perfCounter).id;
+
+        for (const DiscoveredPort &port : node.ports) {
+            m_topology.AddPort(nodeId, port.lid, port.portNum, port.perfCounter);
+        }
+    }
+
+    if (m_topology.GetDeviceCount() == 0) {
+        fprintf(stderr, "No devices found!\n");
+        return EXIT_FAILURE;
+    }
+
+    FILE *file = nullptr;
+
+    // Without an output, the targets are irrelevant, because the exporter serves all devices
+    if (outputPath != nullptr) {
+        if (!AddTargets(targets)) {
+            return EXIT_FAILURE;
+        }
+
+        if (m_targets.empty()) {
+            fprintf(stderr, "No devices found!\n");
+            return EXIT_FAILURE;
+        }
+
+        file = stdout;
+
+        if (strcmp(outputPath, "-") != 0) {
+            file = fopen(outputPath, "w");
+
+            if (file == nullptr) {
+                fprintf(stderr, "Unable to open '%s'! Error: %s\n", outputPath, strerror(errno));
+                return EXIT_FAILURE;
+            }
+        }
+
+        m_writer = new SampleWriter(file, format);
+        m_writer->WriteHeader();
+    }
+
+    m_pmaConnection = new PmaConnection(m_sampler, m_compatibility, m_maxOutstanding, m_simulation);
+
+    if (recordPath != nullptr) {
+        try {
+            m_recorder = new Recorder(recordPath, m_topology, m_sampler);
+        } catch (const std::runtime_error &exception) {
+            fprintf(stderr, "%s\n", exception.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (exportAddress != nullptr) {
+        try {
+            m_exporter = new MetricsExporter(exportAddress, m_topology, m_sampler);
+        } catch (const std::runtime_error &exception) {
+            fprintf(stderr, "%s\n", exception.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (Target *target : m_targets) {
+        m_sampler.Subscribe(target, target->GetDevice());
+    }
+
+    m_sampler.AddSweepCallback([this] { OnSweep(); });
+    m_sampler.Start();
+
+    int signal;
+    sigwait(&signals, &signal);
+
+    m_sampler.Stop();
+
+    delete m_recorder;
+    m_recorder = nullptr;
+
+    delete m_exporter;
+    m_exporter = nullptr;
+
+    bool success = m_writer == nullptr || m_writer->Flush();
+
+    delete m_writer;
+    m_writer = nullptr;
+
+    if (file != nullptr && file != stdout) {
+        success = fclose(file) == 0 && success;
+    }
+
+    return success || signal == SIGPIPE ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool HeadlessScanner::AddTargets(const char *targets) {
+    std::string list(targets);
+    size_t start = 0;
+
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+
+        std::string target = list.substr(start, end - start);
+        start = end + 1;
+
+        if (target.empty()) {
+            continue;
+        }
+
+        if (target == "all") {
+            for (uint32_t nodeId : m_topology.GetNodes()) {
+                for (uint32_t portId : m_topology.GetDevice(nodeId).ports) {
+                    m_targets.push_back(new Target(*this, &m_topology.GetDevice(portId)));
+                }
+            }
+
+            continue;
+        }
+
+        char *separator;
+        uint64_t guid = strtoull(target.c_str(), &separator, 16);
+        unsigned long portNum = 0xff;
+
+        if (*separator == ':') {
+            char *portEnd;
+            portNum = strtoul(separator + 1, &portEnd, 10);
+
+            if (*portEnd != '\0' || portEnd == separator + 1 || portNum > 0xfe) {
+                fprintf(stderr, "Invalid target '%s'!\n", target.c_str());
+                return false;
+            }
+        } else if (*separator != '\0' || separator == target.c_str()) {
+            fprintf(stderr, "Invalid target '%s'!\n", target.c_str());
+            return false;
+        }
+
+        bool found = false;
+
+        for (uint32_t nodeId : m_topology.GetNodes()) {
+            if (m_topology.GetDevice(nodeId).guid == guid) {
+                found = AddTarget(m_topology.GetDevice(nodeId), static_cast<uint8_t>(portNum));
+                break;
+            }
+        }
+
+        if (!found) {
+            fprintf(stderr, "Target '%s' not found in the fabric!\n", target.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool HeadlessScanner::AddTarget(const Device &node, uint8_t portNum) {
+    if (node.ports.empty()) {
+        return false;
+    }
+
+    if (portNum == 0xff) {
+        m_targets.push_back(new Target(*this, &node));
+        return true;
+    }
+
+    for (uint32_t portId : node.ports) {
+        if (m_topology.GetDevice(portId).portNum == portNum) {
+            m_targets.push_back(new Target(*this, &m_topology.GetDevice(portId)));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void HeadlessScanner::OnSweep() {
+    if (m_isDone) {
+        return;
+    }
+
+    m_sweepsWritten++;
+
+    // Output is written once per sweep, so that consumers of a pipe see complete sweeps
+    bool success = m_writer == nullptr || m_writer->Flush();
+
+    if (!success || (m_sweepCount > 0 && m_sweepsWritten >= m_sweepCount)) {
+        // Samples of further sweeps, that may happen before the main thread stops the sampler, are discarded
+        m_isDone = true;
+
+        pthread_kill(m_mainThread, SIGUSR1);
+    }
+}
+
+uint64_t HeadlessScanner::ToWallClockTime(uint64_t timestamp) const {
+    return static_cast<uint64_t>(static_cast<int64_t>(timestamp) + m_sampler.GetClockOffset()) / 1000;
+}
+
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_HEADLESSSCANNER_H
+#define IBSCANNER_HEADLESSSCANNER_H
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <detector/IbFabric.h>
+#include "MetricsExporter.h"
+#include "Sampler.h"
+#include "SampleWriter.h"
+#include "PmaConnection.h"
+#include "Recorder.h"
+#include "SimulatedFabric.h"
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * Samples a set of nodes and ports without any user interface and streams the counters to a file.
+ * Optionally, the latest samples of all devices are served to monitoring systems via a MetricsExporter.
+ *
+ * Runs until the requested amount of sweeps has been written, writing fails or SIGINT/SIGTERM is received,
+ * so that it can be used unattended (e.g. in cron jobs or piped into other tools).
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class HeadlessScanner {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param network Set to true, to scan the entire network instead of local devices only.
+     * @param compatibility Set to true, to activate compatibility mode.
+     * @param maxOutstanding The maximum amount of performance management queries in flight.
+     * @param refreshInterval The interval in milliseconds, in which the counters are refreshed.
+     * @param simulation The simulated fabric to sample instead of the real one (may be nullptr); Is deleted by the
+     *                   scanner.
+     */
+    HeadlessScanner(bool network, bool compatibility, uint32_t maxOutstanding, uint32_t refreshInterval,
+                    SimulatedFabric *simulation = nullptr);
+
+    /**
+     * Destructor.
+     */
+    ~HeadlessScanner();
+
+    /**
+     * Scan the fabric and stream samples of the selected targets.
+     *
+     * @param targets Comma separated list of node GUIDs ('0x...' for the entire node, '0x...:<port>' for a single
+     *                port) or 'all' for every port of the fabric
+     * @param outputPath The file to write to ('-' for stdout, nullptr to only export the samples)
+     * @param format The output format
+     * @param sweepCount The amount of sweeps to write (0 to run until interrupted)
+     * @param recordPath The file to record the samples of all devices to (nullptr to disable recording)
+     * @param exportAddress The address to serve the samples of all devices on (nullptr to disable exporting)
+     *
+     * @return The exit code
+     */
+    int Run(const char *targets, const char *outputPath, SampleWriter::Format format, uint64_t sweepCount,
+            const char *recordPath = nullptr, const char *exportAddress = nullptr);
+
+private:
+    /**
+     * A single node or port, that is sampled.
+     */
+    class Target : public Sampler::Listener {
+
+    public:
+        Target(HeadlessScanner &scanner, const Device *device);
+
+        void OnSample(const CounterSample &sample) override;
+
+        void OnSampleError(const char *message) override;
+
+        const Device *GetDevice() const {
+            return m_device;
+        }
+
+    private:
+
+        HeadlessScanner &m_scanner;
+
+        const Device *m_device;
+        const Device *m_node;
+
+        CounterSample m_lastSample;
+        bool m_hasLastSample;
+    };
+
+    /**
+     * Create a target for every entry of the target list.
+     *
+     * @return false, if an entry is invalid or does not match any device
+     */
+    bool AddTargets(const char *targets);
+
+    /**
+     * Create a target for a node or one of its ports.
+     *
+     * @return false, if the port does not exist
+     */
+    bool AddTarget(const Device &node, uint8_t portNum);
+
+    /**
+     * Called by the sampler after each sweep.
+     */
+    void OnSweep();
+
+    /**
+     * Convert a CLOCK_MONOTONIC timestamp in nanoseconds to wall clock time in microseconds since the epoch.
+     *
+     * Uses the sampler's clock offset, so that the written timestamps match the ones in a recording of the same run.
+     */
+    uint64_t ToWallClockTime(uint64_t timestamp) const;
+
+private:
+
+    Detector::IbFabric *m_fabric;
+
+    Topology m_topology;
+
+    Sampler m_sampler;
+
+    PmaConnection *m_pmaConnection;
+    SimulatedFabric *m_simulation;
+
+    std::vector<Target*> m_targets;
+
+    Recorder *m_recorder;
+
+    MetricsExporter *m_exporter;
+
+    SampleWriter *m_writer;
+
+    bool m_network;
+    bool m_compatibility;
+
+    uint32_t m_maxOutstanding;
+
+    uint64_t m_sweepCount;
+    uint64_t m_sweepsWritten;
+
+    bool m_isDone;
+
+    pthread_t m_mainThread;
+};
+
+}
+
+#endif
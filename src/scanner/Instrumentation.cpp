@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cstdio>
+#include <unistd.h>
+#include "Instrumentation.h"
+
+namespace Scanner {
+
+Instrumentation::Instrumentation() :
+        queryCount(0),
+        timeoutCount(0),
+        errorCount(0) {
+
+}
+
+uint64_t Instrumentation::GetResidentMemory() {
+    FILE *file = fopen("/proc/self/statm", "r");
+
+    if (file == nullptr) {
+        return 0;
+    }
+
+    unsigned long long size = 0;
+    unsigned long long resident = 0;
+
+    // The second field contains the amount of resident pages
+    if (fscanf(file, "%llu %llu", &size, &resident) != 2) {
+        resident = 0;
+    }
+
+    fclose(file);
+
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+}
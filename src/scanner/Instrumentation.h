@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_INSTRUMENTATION_H
+#define IBSCANNER_INSTRUMENTATION_H
+
+#include <atomic>
+#include <cstdint>
+#include "LatencyHistogram.h"
+
+namespace Scanner {
+
+/**
+ * Measurements of the scanner itself, which show whether the fabric, the MAD layer or the UI is slow.
+ *
+ * The sampler records the round trip time of every query and the timing of its sweeps, the WindowManager reports the
+ * time needed for every frame. All durations are given in nanoseconds. Every member may be updated by any thread
+ * without locking.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+struct Instrumentation {
+
+    /**
+     * The time from sending a query until its response has arrived (or until RefreshCounters() has returned, if the
+     * counters are not queried via the PmaQueryEngine).
+     */
+    LatencyHistogram queryRoundTrip;
+
+    /**
+     * The time between the starts of two consecutive sweeps, which should match the requested refresh interval.
+     */
+    LatencyHistogram sweepInterval;
+
+    /**
+     * The time needed to query all subscribed counters and to notify their listeners.
+     */
+    LatencyHistogram sweepDuration;
+
+    /**
+     * The time needed to draw and flush a frame.
+     */
+    LatencyHistogram frameTime;
+
+    /**
+     * The time from a key press until the resulting frame has been flushed to the terminal.
+     */
+    LatencyHistogram inputLatency;
+
+    std::atomic<uint64_t> queryCount;
+    std::atomic<uint64_t> timeoutCount;
+    std::atomic<uint64_t> errorCount;
+
+    /**
+     * Constructor.
+     */
+    Instrumentation();
+
+    /**
+     * Get the amount of physical memory in bytes, that is currently used by the process (0, if unknown).
+     */
+    static uint64_t GetResidentMemory();
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cmath>
+#include "LatencyHistogram.h"
+
+namespace Scanner {
+
+const constexpr uint32_t LatencyHistogram::SUB_BUCKET_BITS;
+const constexpr uint32_t LatencyHistogram::SUB_BUCKET_COUNT;
+const constexpr uint32_t LatencyHistogram::BUCKET_COUNT;
+
+LatencyHistogram::LatencyHistogram() :
+        m_max(0) {
+    for (std::atomic<uint64_t> &bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    m_buckets[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed));
+}
+
+uint64_t LatencyHistogram::GetCount() const {
+    uint64_t count = 0;
+
+    for (const std::atomic<uint64_t> &bucket : m_buckets) {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+
+    return count;
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const {
+    uint64_t count = GetCount();
+
+    if (count == 0) {
+        return 0;
+    }
+
+    auto rank = static_cast<uint64_t>(std::ceil(count * percentile / 100));
+    uint64_t seen = 0;
+
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+
+        if (seen >= rank && seen > 0) {
+            // The end of the highest bucket may lie beyond the largest value, that has actually been recorded
+            uint64_t end = GetBucketEnd(i);
+            uint64_t max = GetMax();
+
+            return end < max ? end : max;
+        }
+    }
+
+    return GetMax();
+}
+
+uint32_t LatencyHistogram::GetBucket(uint64_t value) {
+    if (value < 2 * SUB_BUCKET_COUNT) {
+        return static_cast<uint32_t>(value);
+    }
+
+    // The SUB_BUCKET_BITS bits below the most significant bit select the bucket inside the power of two
+    auto shift = static_cast<uint32_t>(63 - __builtin_clzll(value) - SUB_BUCKET_BITS);
+
+    return shift * SUB_BUCKET_COUNT + static_cast<uint32_t>(value >> shift);
+}
+
+uint64_t LatencyHistogram::GetBucketEnd(uint32_t bucket) {
+    if (bucket < 2 * SUB_BUCKET_COUNT) {
+        return bucket;
+    }
+
+    uint32_t shift = bucket / SUB_BUCKET_COUNT - 1;
+    uint64_t start = static_cast<uint64_t>(bucket % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT) << shift;
+
+    return start + ((1ull << shift) - 1);
+}
+
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_LATENCYHISTOGRAM_H
+#define IBSCANNER_LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace Scanner {
+
+/**
+ * Lock-free histogram of durations with a fixed memory footprint (similar to an HDR histogram).
+ *
+ * Values are sorted into log-linear buckets: Each power of two is split into 16 buckets, so that every recorded value
+ * is reproduced with a relative error of at most 6.25% over the whole range of 64-bit values. Recording a value only
+ * costs a few instructions and a relaxed atomic increment, so it can be done from any thread on every query or frame
+ * without disturbing the measurement. Percentiles are calculated by the reader, which may see a few values of a
+ * concurrent recording missing.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class LatencyHistogram {
+
+public:
+    /**
+     * Constructor.
+     */
+    LatencyHistogram();
+
+    /**
+     * Destructor.
+     */
+    ~LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram &other) = delete;
+
+    LatencyHistogram &operator=(const LatencyHistogram &other) = delete;
+
+    /**
+     * Record a value.
+     *
+     * May be called from any thread.
+     *
+     * @param value The value (e.g. a duration in nanoseconds)
+     */
+    void Record(uint64_t value);
+
+    /**
+     * Get the amount of recorded values.
+     */
+    uint64_t GetCount() const;
+
+    /**
+     * Get the largest recorded value.
+     */
+    uint64_t GetMax() const {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the value, that is larger than or equal to a given percentage of all recorded values.
+     *
+     * The value is rounded up to the upper end of its bucket, so that it is never underestimated.
+     *
+     * @param percentile The percentage (0.0 - 100.0)
+     *
+     * @return The value (0, if no value has been recorded)
+     */
+    uint64_t GetPercentile(double percentile) const;
+
+private:
+    /**
+     * Get the bucket, that a value is counted in.
+     *
+     * @param value The value
+     */
+    static uint32_t GetBucket(uint64_t value);
+
+    /**
+     * Get the largest value, that is counted in a bucket.
+     *
+     * @param bucket The bucket
+     */
+    static uint64_t GetBucketEnd(uint32_t bucket);
+
+private:
+
+    static const constexpr uint32_t SUB_BUCKET_BITS = 4;
+    static const constexpr uint32_t SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;
+
+    /**
+     * Values below 2 * SUB_BUCKET_COUNT get a bucket of their own, every larger power of two is split into
+     * SUB_BUCKET_COUNT buckets.
+     */
+    static const constexpr uint32_t BUCKET_COUNT = (65 - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT;
+
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> m_max;
+};
+
+}
+
+#endif
@@ -0,0 +1,457 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "MetricsExporter.h"
+
+namespace Scanner {
+
+/**
+ * The maximum amount of simultaneous connections. Further scrapers wait in the listen backlog.
+ */
+static const size_t MAX_CONNECTIONS = 256;
+
+/**
+ * The maximum size of a request's header.
+ */
+static const size_t MAX_REQUEST_SIZE = 8192;
+
+/**
+ * The time in nanoseconds, after which idle connections are closed.
+ */
+static const uint64_t CONNECTION_TIMEOUT = 10000000000;
+
+static const char *CONTENT_TYPE = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+static void appendUnsigned(std::string &buffer, uint64_t value) {
+    char digits[20];
+    int length = 0;
+
+    do {
+        digits[length++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (length > 0) {
+        buffer += digits[--length];
+    }
+}
+
+static void appendLabel(std::string &buffer, const char *name, const std::string &value) {
+    if (!buffer.empty()) {
+        buffer += ',';
+    }
+
+    buffer += name;
+    buffer += "=\"";
+
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            buffer += '\\';
+            buffer += c;
+        } else if (c == '\n') {
+            buffer += "\\n";
+        } else {
+            buffer += c;
+        }
+    }
+
+    buffer += '"';
+}
+
+MetricsExporter::DeviceListener::DeviceListener(const Device &device) :
+        m_device(device),
+        m_sample{},
+        m_isUp(false) {
+
+}
+
+void MetricsExporter::DeviceListener::OnSample(const CounterSample &sample) {
+    m_sample = sample;
+    m_isUp = true;
+}
+
+void MetricsExporter::DeviceListener::OnSampleError(const char *message) {
+    // Stale values are dropped, so that the monitoring system notices the gap
+    m_isUp = false;
+}
+
+MetricsExporter::MetricsExporter(const char *address, const Topology &topology, Sampler &sampler) :
+        m_sampler(sampler),
+        m_exposition(std::make_shared<const std::string>("# EOF\n")),
+        m_sweepCount(0),
+        m_listenFd(-1),
+        m_wakeupFds{-1, -1} {
+    std::string host(address);
+    std::string port;
+    size_t separator = host.rfind(':');
+
+    if (separator == std::string::npos) {
+        port = host;
+        host.clear();
+    } else {
+        port = host.substr(separator + 1);
+        host.erase(separator);
+
+        // IPv6 addresses are enclosed in brackets
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    addrinfo *addresses;
+    int error = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addresses);
+
+    if (error != 0) {
+        throw std::runtime_error(std::string("Invalid address '") + address + "': " + gai_strerror(error));
+    }
+
+    std::string bindError = "No usable address";
+
+    for (addrinfo *info = addresses; info != nullptr; info = info->ai_next) {
+        int fd = socket(info->ai_family, info->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, info->ai_protocol);
+
+        if (fd < 0) {
+            bindError = strerror(errno);
+            continue;
+        }
+
+        int enable = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+        if (bind(fd, info->ai_addr, info->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0) {
+            m_listenFd = fd;
+            break;
+        }
+
+        bindError = strerror(errno);
+        close(fd);
+    }
+
+    freeaddrinfo(addresses);
+
+    if (m_listenFd < 0) {
+        throw std::runtime_error(std::string("Unable to listen on '") + address + "': " + bindError);
+    }
+
+    if (pipe2(m_wakeupFds, O_NONBLOCK | O_CLOEXEC) != 0) {
+        close(m_listenFd);
+        throw std::runtime_error(std::string("Unable to create pipe: ") + strerror(errno));
+    }
+
+    for (uint32_t i = 0; i < topology.GetDeviceCount(); i++) {
+        const Device &device = topology.GetDevice(i);
+        auto *listener = new DeviceListener(device);
+        char guid[19];
+
+        snprintf(guid, sizeof(guid), "0x%016llx", static_cast<unsigned long long>(device.guid));
+
+        appendLabel(listener->m_labels, "guid", guid);
+        appendLabel(listener->m_labels, "lid", std::to_string(device.lid));
+
+        if (!device.IsNode()) {
+            appendLabel(listener->m_labels, "port", std::to_string(device.portNum));
+        }
+
+        appendLabel(listener->m_labels, "node", topology.GetDevice(device.nodeId).name);
+
+        m_listeners.push_back(listener);
+        m_sampler.Subscribe(listener, &device);
+    }
+
+    m_sampler.AddSweepCallback([this] { OnSweep(); });
+
+    m_thread = std::thread(&MetricsExporter::Run, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+    for (DeviceListener *listener : m_listeners) {
+        m_sampler.Unsubscribe(listener);
+    }
+
+    char wakeup = 0;
+
+    if (write(m_wakeupFds[1], &wakeup, sizeof(wakeup)) < 0) {
+        // The pipe can only be full, if the thread has already been woken up
+    }
+
+    m_thread.join();
+
+    for (Connection &connection : m_connections) {
+        close(connection.fd);
+    }
+
+    close(m_listenFd);
+    close(m_wakeupFds[0]);
+    close(m_wakeupFds[1]);
+
+    for (DeviceListener *listener : m_listeners) {
+        delete listener;
+    }
+}
+
+void MetricsExporter::OnSweep() {
+    m_sweepCount++;
+
+    // The previous exposition's size is a good estimate, so that the buffer is allocated only once
+    auto exposition = std::make_shared<std::string>();
+    exposition->reserve(std::atomic_load(&m_exposition)->size() + 4096);
+
+    for (bool nodes : {false, true}) {
+        for (uint8_t id = 0; id < COUNTER_COUNT; id++) {
+            AppendFamily(*exposition, static_cast<CounterId>(id), nodes);
+        }
+
+        *exposition += nodes ? "# TYPE ib_node_up gauge\n" : "# TYPE ib_port_up gauge\n";
+
+        for (const DeviceListener *listener : m_listeners) {
+            if (listener->m_device.IsNode() != nodes) {
+                continue;
+            }
+
+            *exposition += nodes ? "ib_node_up{" : "ib_port_up{";
+            *exposition += listener->m_labels;
+            *exposition += listener->m_isUp ? "} 1\n" : "} 0\n";
+        }
+    }
+
+    *exposition += "# TYPE ib_scanner_sweeps counter\nib_scanner_sweeps_total ";
+    appendUnsigned(*exposition, m_sweepCount);
+    *exposition += "\n# EOF\n";
+
+    std::atomic_store(&m_exposition, std::shared_ptr<const std::string>(std::move(exposition)));
+}
+
+void MetricsExporter::AppendFamily(std::string &buffer, CounterId id, bool nodes) const {
+    const char *prefix = nodes ? "ib_node_" : "ib_port_";
+    const char *name = CounterSample::GetCounterName(id);
+
+    // The lifespan is the counters' resolution and not a counter itself
+    bool isGauge = id == LIFESPAN;
+    bool hasHeader = false;
+
+    for (const DeviceListener *listener : m_listeners) {
+        if (listener->m_device.IsNode() != nodes || !listener->m_isUp ||
+                (id >= PERF_COUNTER_COUNT && !listener->m_sample.hasDiag)) {
+            continue;
+        }
+
+        if (!hasHeader) {
+            buffer += "# TYPE ";
+            buffer += prefix;
+            buffer += name;
+            buffer += isGauge ? " gauge\n" : " counter\n";
+
+            hasHeader = true;
+        }
+
+        buffer += prefix;
+        buffer += name;
+        buffer += isGauge ? "{" : "_total{";
+        buffer += listener->m_labels;
+        buffer += "} ";
+        appendUnsigned(buffer, listener->m_sample.values[id]);
+        buffer += '\n';
+    }
+}
+
+void MetricsExporter::Run() {
+    std::vector<pollfd> fds;
+
+    while (true) {
+        fds.clear();
+
+        // New connections are only accepted, if there is room for them
+        fds.push_back(pollfd{m_wakeupFds[0], POLLIN, 0});
+        fds.push_back(pollfd{m_listenFd, static_cast<short>(m_connections.size() < MAX_CONNECTIONS ? POLLIN : 0), 0});
+
+        for (const Connection &connection : m_connections) {
+            fds.push_back(pollfd{connection.fd, static_cast<short>(connection.body ? POLLOUT : POLLIN), 0});
+        }
+
+        if (poll(fds.data(), fds.size(), 1000) < 0 && errno != EINTR) {
+            return;
+        }
+
+        if (fds[0].revents != 0) {
+            return;
+        }
+
+        uint64_t now = CounterSample::GetMonotonicTime();
+
+        // Iterate backwards, so that closed connections can be removed without disturbing the indices
+        for (size_t i = m_connections.size(); i-- > 0;) {
+            Connection &connection = m_connections[i];
+            short events = fds[i + 2].revents;
+            bool keep;
+
+            if (events & (POLLERR | POLLNVAL)) {
+                keep = false;
+            } else if (events & POLLOUT) {
+                keep = SendResponse(connection);
+                connection.lastActivity = now;
+            } else if (events & (POLLIN | POLLHUP)) {
+                keep = ReceiveRequest(connection);
+                connection.lastActivity = now;
+            } else {
+                keep = now - connection.lastActivity < CONNECTION_TIMEOUT;
+            }
+
+            if (!keep) {
+                close(connection.fd);
+
+                m_connections[i] = std::move(m_connections.back());
+                m_connections.pop_back();
+            }
+        }
+
+        if (!(fds[1].revents & POLLIN)) {
+            continue;
+        }
+
+        while (m_connections.size() < MAX_CONNECTIONS) {
+            int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+            if (fd < 0) {
+                break;
+            }
+
+            m_connections.push_back(Connection{fd, now, "", "", nullptr, 0});
+        }
+    }
+}
+
+bool MetricsExporter::ReceiveRequest(Connection &connection) {
+    char buffer[1024];
+    ssize_t length = read(connection.fd, buffer, sizeof(buffer));
+
+    if (length < 0) {
+        return errno == EAGAIN || errno == EINTR;
+    }
+
+    // The scraper has closed the connection without sending a complete request
+    if (length == 0) {
+        return false;
+    }
+
+    connection.request.append(buffer, static_cast<size_t>(length));
+
+    if (connection.request.find("\r\n\r\n") == std::string::npos &&
+            connection.request.find("\n\n") == std::string::npos) {
+        return connection.request.size() <= MAX_REQUEST_SIZE;
+    }
+
+    // Only the request line is of interest; Every response closes the connection, so there is no need for a body
+    const std::string &request = connection.request;
+    size_t lineEnd = request.find_first_of("\r\n");
+    size_t methodEnd = request.find(' ');
+    std::string method;
+    std::string target;
+
+    // The request line is '<method> <target>[?<query>] <version>'; Anything else is answered with 400
+    if (methodEnd != std::string::npos && methodEnd > 0 && methodEnd < lineEnd) {
+        size_t targetEnd = std::min(request.find_first_of(" ?", methodEnd + 1), lineEnd);
+
+        method = request.substr(0, methodEnd);
+        target = request.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+    }
+
+    const char *status = "200 OK";
+    const char *contentType = CONTENT_TYPE;
+    std::shared_ptr<const std::string> body;
+
+    if (method.empty() || target.empty()) {
+        status = "400 Bad Request";
+        contentType = "text/plain; charset=utf-8";
+        body = std::make_shared<const std::string>("Bad request\n");
+    } else if (method != "GET" && method != "HEAD") {
+        status = "405 Method Not Allowed";
+        contentType = "text/plain; charset=utf-8";
+        body = std::make_shared<const std::string>("Method not allowed\n");
+    } else if (target != "/metrics" && target != "/") {
+        status = "404 Not Found";
+        contentType = "text/plain; charset=utf-8";
+        body = std::make_shared<const std::string>("Not found; Metrics are served at /metrics\n");
+    } else {
+        body = std::atomic_load(&m_exposition);
+    }
+
+    connection.header = std::string("HTTP/1.1 ") + status + "\r\nContent-Type: " + contentType +
+            "\r\nContent-Length: " + std::to_string(body->size()) + "\r\nConnection: close\r\n\r\n";
+
+    // HEAD requests only get the headers, which describe the body, that GET would return
+    connection.body = method == "HEAD" ? std::make_shared<const std::string>() : body;
+    connection.sent = 0;
+
+    return SendResponse(connection);
+}
+
+bool MetricsExporter::SendResponse(Connection &connection) {
+    while (true) {
+        size_t headerSize = connection.header.size();
+        iovec parts[2] = {};
+        int partCount = 0;
+
+        if (connection.sent < headerSize) {
+            parts[partCount++] = iovec{const_cast<char*>(connection.header.data()) + connection.sent,
+                                       headerSize - connection.sent};
+        }
+
+        size_t bodySent = connection.sent > headerSize ? connection.sent - headerSize : 0;
+
+        if (bodySent < connection.body->size()) {
+            parts[partCount++] = iovec{const_cast<char*>(connection.body->data()) + bodySent,
+                                       connection.body->size() - bodySent};
+        }
+
+        // The response is complete, so the connection is closed
+        if (partCount == 0) {
+            return false;
+        }
+
+        msghdr message{};
+        message.msg_iov = parts;
+        message.msg_iovlen = static_cast<size_t>(partCount);
+
+        // A scraper, that disconnects early, must not raise SIGPIPE
+        ssize_t length = sendmsg(connection.fd, &message, MSG_NOSIGNAL);
+
+        if (length < 0) {
+            return errno == EAGAIN || errno == EINTR;
+        }
+
+        connection.sent += static_cast<size_t>(length);
+    }
+}
+
+}
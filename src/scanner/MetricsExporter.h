@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_METRICSEXPORTER_H
+#define IBSCANNER_METRICSEXPORTER_H
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Sampler.h"
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * Serves the latest samples of all devices of a topology in OpenMetrics text format via HTTP (e.g. for Prometheus).
+ *
+ * The exposition is serialized once per sweep on the sampling thread and published as an immutable buffer.
+ * Scrapes are answered from that buffer by a single thread, that multiplexes all connections via poll(),
+ * so that any amount of scrapers neither causes additional queries nor delays the sampler.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class MetricsExporter {
+
+public:
+    /**
+     * Constructor.
+     *
+     * Starts listening and subscribes every device to the sampler.
+     * Throws std::runtime_error, if the address is invalid or cannot be bound.
+     *
+     * @param address The address to listen on ('<port>', '<host>:<port>' or '[<IPv6 address>]:<port>')
+     * @param topology The devices to export
+     * @param sampler The sampler, that the devices are subscribed to; Must not have been started yet
+     */
+    MetricsExporter(const char *address, const Topology &topology, Sampler &sampler);
+
+    /**
+     * Destructor.
+     *
+     * Closes all connections and unsubscribes all devices.
+     * The sampler must have been stopped before, because it keeps calling the exporter after each sweep.
+     */
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter &copy) = delete;
+
+    MetricsExporter& operator=(const MetricsExporter &other) = delete;
+
+private:
+    /**
+     * Receives the samples of a single device.
+     */
+    class DeviceListener : public Sampler::Listener {
+
+    public:
+        explicit DeviceListener(const Device &device);
+
+        void OnSample(const CounterSample &sample) override;
+
+        void OnSampleError(const char *message) override;
+
+    private:
+
+        friend class MetricsExporter;
+
+        const Device &m_device;
+
+        /**
+         * The device's label set, which never changes and is therefore only formatted once.
+         */
+        std::string m_labels;
+
+        CounterSample m_sample;
+        bool m_isUp;
+    };
+
+    /**
+     * A connected scraper.
+     */
+    struct Connection {
+        int fd;
+        uint64_t lastActivity;
+
+        std::string request;
+
+        /**
+         * The status line and headers of the response.
+         */
+        std::string header;
+
+        /**
+         * The exposition, that is sent to this scraper (kept alive, even if a newer one is published meanwhile).
+         */
+        std::shared_ptr<const std::string> body;
+
+        size_t sent;
+    };
+
+    /**
+     * Called by the sampler after each sweep.
+     */
+    void OnSweep();
+
+    /**
+     * Serialize one metric family for either all nodes or all ports.
+     */
+    void AppendFamily(std::string &buffer, CounterId id, bool nodes) const;
+
+    /**
+     * The serving thread.
+     */
+    void Run();
+
+    /**
+     * Read from a connection and prepare the response, once the request is complete.
+     *
+     * @return false, if the connection has to be closed
+     */
+    bool ReceiveRequest(Connection &connection);
+
+    /**
+     * Write as much of the response as possible.
+     *
+     * @return false, if the connection has to be closed
+     */
+    bool SendResponse(Connection &connection);
+
+private:
+
+    Sampler &m_sampler;
+
+    std::vector<DeviceListener*> m_listeners;
+
+    /**
+     * The latest exposition (accessed via std::atomic_load/std::atomic_store).
+     */
+    std::shared_ptr<const std::string> m_exposition;
+
+    uint64_t m_sweepCount;
+
+    int m_listenFd;
+
+    /**
+     * Written to by the destructor to wake up the serving thread.
+     */
+    int m_wakeupFds[2];
+
+    std::vector<Connection> m_connections;
+
+    std::thread m_thread;
+};
+
+}
+
+#endif
@@ -1,10 +1,115 @@
 #include <algorithm>
-#include <detector/exception/IbPerfException.h>
+#include <cinttypes>
 #include <cstring>
+#include <ctime>
 #include "MonitorWindow.h"
 
 namespace Scanner {
 
+/**
+ * Describes the line of a counter.
+ */
+struct CounterDescriptor {
+    const char *label;
+    CounterId id;
+    const char *unit;
+    const char *rateUnit;
+};
+
+/**
+ * The lines of all counters in the order, in which they are shown. The diagnostic counters come last,
+ * so that they can simply be left out for devices without them.
+ */
+static constexpr CounterDescriptor counterDescriptors[] = {
+        { "Xmit Data:", XMIT_DATA_BYTES, "B", "B/s" },
+        { "Rcv Data:", RCV_DATA_BYTES, "B", "B/s" },
+        { "Xmit Pkts:", XMIT_PKTS, "", "/s" },
+        { "Rcv Pkts:", RCV_PKTS, "", "/s" },
+        { "Unicast Xmit Pkts:", UNICAST_XMIT_PKTS, "", "/s" },
+        { "Unicast Rcv Pkts:", UNICAST_RCV_PKTS, "", "/s" },
+        { "Multicast Xmit Pkts:", MULTICAST_XMIT_PKTS, "", "/s" },
+        { "Multicast Rcv Pkts:", MULTICAST_RCV_PKTS, "", "/s" },
+        { "Symbol Errors:", SYMBOL_ERRORS, "", "/s" },
+        { "Link Downed:", LINK_DOWNED, "", "/s" },
+        { "Link Recoveries:", LINK_RECOVERIES, "", "/s" },
+        { "Rcv Errors:", RCV_ERRORS, "", "/s" },
+        { "Rcv Remote Physical Errors:", RCV_REMOTE_PHYSICAL_ERRORS, "", "/s" },
+        { "Rcv Switch Relay Errors:", RCV_SWITCH_RELAY_ERRORS, "", "/s" },
+        { "Xmit Discards:", XMIT_DISCARDS, "", "/s" },
+        { "Xmit Constraint Errors:", XMIT_CONSTRAINT_ERRORS, "", "/s" },
+        { "Rcv Constraint Errors:", RCV_CONSTRAINT_ERRORS, "", "/s" },
+        { "Local Link Integrity Errors:", LOCAL_LINK_INTEGRITY_ERRORS, "", "/s" },
+        { "Excessive Buffer Overrun Errors:", EXCESSIVE_BUFFER_OVERRUN_ERRORS, "", "/s" },
+        { "VL15 Dropped:", VL15_DROPPED, "", "/s" },
+        { "Xmit Wait:", XMIT_WAIT, "", "/s" },
+
+        { "Lifespan:", LIFESPAN, "", "/s" },
+        { "Rq Local Length Errors:", RQ_LOCAL_LENGTH_ERRORS, "", "/s" },
+        { "Rq Local Qp Protection Errors:", RQ_LOCAL_QP_PROTECTION_ERRORS, "", "/s" },
+        { "Rq Out Of Sequence Errors:", RQ_OUT_OF_SEQUENCE_ERRORS, "", "/s" },
+        { "Rq Remote Access Errors:", RQ_REMOTE_ACCESS_ERRORS, "", "/s" },
+        { "Rq Remote Invalid Request Errors:", RQ_REMOTE_INVALID_REQUEST_ERRORS, "", "/s" },
+        { "Rq Rnr Nak Num:", RQ_RNR_NAK_NUM, "", "/s" },
+        { "Rq Completion Queue Entry Errors:", RQ_COMPLETION_QUEUE_ENTRY_ERRORS, "", "/s" },
+        { "SqBad Response Errors:", SQ_BAD_RESPONSE_ERRORS, "", "/s" },
+        { "Sq Local Length Errors:", SQ_LOCAL_LENGTH_ERRORS, "", "/s" },
+        { "Sq Local Protection Errors:", SQ_LOCAL_PROTECTION_ERRORS, "", "/s" },
+        { "Sq Local Qp Protection Errors:", SQ_LOCAL_QP_PROTECTION_ERRORS, "", "/s" },
+        { "Sq Memory Window Bind Errors:", SQ_MEMORY_WINDOW_BIND_ERRORS, "", "/s" },
+        { "Sq Out Of Sequence Errors:", SQ_OUT_OF_SEQUENCE_ERRORS, "", "/s" },
+        { "Sq Remote Access Errors:", SQ_REMOTE_ACCESS_ERRORS, "", "/s" },
+        { "Sq Remote Invalid Request Errors:", SQ_REMOTE_INVALID_REQUEST_ERRORS, "", "/s" },
+        { "Sq Rnr Nak Num:", SQ_RNR_NAK_NUM, "", "/s" },
+        { "Sq Remote Operation Errors:", SQ_REMOTE_OPERATION_ERRORS, "", "/s" },
+        { "Sq Rnr Nak Retries Exceeded Errors:", SQ_RNR_NAK_RETRIES_EXCEEDED_ERRORS, "", "/s" },
+        { "Sq Transport Retries Exceeded Errors:", SQ_TRANSPORT_RETRIES_EXCEEDED_ERRORS, "", "/s" },
+        { "Sq Completion Queue Entry Errors:", SQ_COMPLETION_QUEUE_ENTRY_ERRORS, "", "/s" }
+};
+
+static constexpr uint32_t COUNTER_LINE_COUNT = sizeof(counterDescriptors) / sizeof(counterDescriptors[0]);
+
+/**
+ * Count the lines of the counters, that every device has (i.e. all lines before the first diagnostic counter).
+ */
+static constexpr uint32_t countPerfCounterLines(uint32_t line = 0) {
+    return line < COUNTER_LINE_COUNT && counterDescriptors[line].id < PERF_COUNTER_COUNT ?
+           1 + countPerfCounterLines(line + 1) : 0;
+}
+
+static constexpr uint32_t PERF_COUNTER_LINE_COUNT = countPerfCounterLines();
+
+static_assert(COUNTER_LINE_COUNT == COUNTER_COUNT, "Every counter needs exactly one line");
+static_assert(PERF_COUNTER_LINE_COUNT == PERF_COUNTER_COUNT, "The diagnostic counters have to be shown last");
+
+/**
+ * The lines above the counters (sample time, sample interval and column headers).
+ */
+static constexpr uint32_t HEADER_LINE_COUNT = 3;
+
+/**
+ * The widths of the label column and the value columns.
+ */
+static constexpr int LABEL_WIDTH = 40;
+static constexpr int COLUMN_WIDTH = 13;
+
+/**
+ * The maximum length of a formatted value (e.g. "999.999 kB/s") including the terminating null character.
+ */
+static constexpr int VALUE_LENGTH = 32;
+
+/**
+ * The powers of 1000, which belong to the metric prefixes.
+ */
+static constexpr uint64_t metricDivisors[] = {
+        1,
+        1000,
+        1000000,
+        1000000000,
+        1000000000000,
+        1000000000000000,
+        1000000000000000000
+};
+
 char MonitorWindow::metricTable[] = {
         ' ',
         'k',
@@ -16,201 +121,350 @@ char MonitorWindow::metricTable[] = {
 };
 
 MonitorWindow::MonitorWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, const char *title,
-                             Detector::IbPerfCounter *perfCounter, Detector::IbDiagPerfCounter *diagPerfCounter,
-                             uint32_t refreshInterval) :
+                             Sampler &sampler, const Device *device) :
         ListWindow(posX, posY, width, height, title),
-        m_perfCounter(perfCounter),
-        m_diagPerfCounter(diagPerfCounter),
-        m_lastXmit(0),
-        m_lastRcv(0),
-        m_xmitThroughput(0),
-        m_rcvThroughput(0),
-        m_refreshThroughput(false),
-        m_refreshInterval(refreshInterval) {
-    m_refreshThread = std::thread(&MonitorWindow::RefreshThread, this);
+        m_device(device),
+        m_snapshots(),
+        m_writtenSnapshot(0),
+        m_publishedSnapshot(1),
+        m_takenSnapshot(2),
+        m_previousSample(),
+        m_hasPreviousSample(false),
+        m_generation(1),
+        m_showsPlaceholder(false),
+        m_formattedOffset(0),
+        m_formattedHeight(0),
+        m_sampler(sampler),
+        m_isActive(false) {
+
 }
 
 MonitorWindow::~MonitorWindow() {
-    m_refreshThread.detach();
+    m_sampler.Unsubscribe(this);
 }
 
 void MonitorWindow::DrawContent() {
-    m_refreshLock.lock();
+    UpdateItems();
 
     ListWindow::DrawContent();
+}
 
-    m_refreshLock.unlock();
+void MonitorWindow::UpdateItems() {
+    bool isNewSnapshot = TakeSnapshot();
+    const Snapshot *snapshot = GetTakenSnapshot();
+
+    // Only rebuild the items, if a new snapshot has been taken or other lines have been scrolled into view
+    if (isNewSnapshot || (snapshot == nullptr) != m_showsPlaceholder ||
+            m_scrollOffset != m_formattedOffset || GetHeight() != m_formattedHeight) {
+        RefreshValues(snapshot);
+
+        m_showsPlaceholder = snapshot == nullptr;
+        m_formattedOffset = m_scrollOffset;
+        m_formattedHeight = GetHeight();
+    }
 }
 
-void MonitorWindow::SetPerfCounter(Detector::IbPerfCounter *perfCounter,
-        Detector::IbDiagPerfCounter *diagPerfCounter) {
-    m_refreshLock.lock();
+void MonitorWindow::PublishSnapshot() {
+    auto written = static_cast<uint8_t>(m_writtenSnapshot | SNAPSHOT_FRESH);
 
-    m_perfCounter = perfCounter;
-    m_diagPerfCounter = diagPerfCounter;
+    m_writtenSnapshot = static_cast<uint8_t>(
+            m_publishedSnapshot.exchange(written, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH);
+}
+
+bool MonitorWindow::TakeSnapshot() {
+    if ((m_publishedSnapshot.load(std::memory_order_relaxed) & SNAPSHOT_FRESH) == 0) {
+        return false;
+    }
+
+    m_takenSnapshot = static_cast<uint8_t>(
+            m_publishedSnapshot.exchange(m_takenSnapshot, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH);
+
+    return true;
+}
+
+const MonitorWindow::Snapshot *MonitorWindow::GetTakenSnapshot() const {
+    const Snapshot &snapshot = m_snapshots[m_takenSnapshot];
+
+    // Snapshots of a previous device may still be buffered after the device has changed
+    return snapshot.generation == m_generation ? &snapshot : nullptr;
+}
+
+void MonitorWindow::SetDevice(const Device *device) {
+    m_device = device;
 
     m_highlight = 0;
     m_scrollOffset = 0;
 
-    m_xmitThroughput = 0;
-    m_rcvThroughput = 0;
+    // Unsubscribing waits for the sampler to finish notifying its listeners, so the state shared with the sampler
+    // thread can be reset safely, until the window is subscribed again
+    if (m_isActive) {
+        m_sampler.Unsubscribe(this);
+    }
+
+    m_generation++;
+    m_hasPreviousSample = false;
+
+    if (m_isActive) {
+        m_sampler.Subscribe(this, device);
+    }
 
-    RefreshValues();
+    Invalidate();
 
-    m_refreshLock.unlock();
+    if (m_isActive) {
+        m_sampler.RequestSample();
+    }
 }
 
-void MonitorWindow::RefreshValues() {
-    m_items.clear();
+void MonitorWindow::SetActive(bool active) {
+    if (active == m_isActive) {
+        return;
+    }
 
-    try {
-        m_perfCounter->RefreshCounters();
+    m_isActive = active;
 
-        if(m_diagPerfCounter != nullptr) {
-            m_diagPerfCounter->RefreshCounters();
-        }
-    } catch(const Detector::IbPerfException &exception) {
-        m_items.emplace_back("An error occurred while refreshing the performance counters:");
-        m_items.emplace_back(exception.what());
-        m_items.emplace_back("Retrying...");
+    if (m_isActive) {
+        m_sampler.Subscribe(this, m_device);
+        m_sampler.RequestSample();
+    } else {
+        m_sampler.Unsubscribe(this);
+    }
+}
+
+void MonitorWindow::OnSample(const CounterSample &sample) {
+    Snapshot &snapshot = m_snapshots[m_writtenSnapshot];
+
+    snapshot.sample = sample;
+    snapshot.delta = CounterDelta{};
+    snapshot.generation = m_generation;
+    snapshot.error[0] = '\0';
+
+    // Rates are calculated from the time, that has actually passed between both samples
+    snapshot.hasDelta = m_hasPreviousSample && sample.timestamp > m_previousSample.timestamp;
+
+    if (snapshot.hasDelta) {
+        snapshot.delta.Calculate(m_previousSample, sample);
+    }
+
+    m_previousSample = sample;
+    m_hasPreviousSample = true;
+
+    PublishSnapshot();
+
+    Invalidate();
+}
 
+void MonitorWindow::OnSampleError(const char *message) {
+    Snapshot &snapshot = m_snapshots[m_writtenSnapshot];
+
+    snapshot.sample = CounterSample{};
+    snapshot.delta = CounterDelta{};
+    snapshot.hasDelta = false;
+    snapshot.generation = m_generation;
+    snprintf(snapshot.error, sizeof(snapshot.error), "%s", message);
+
+    m_hasPreviousSample = false;
+
+    PublishSnapshot();
+
+    Invalidate();
+}
+
+void MonitorWindow::RefreshValues(const Snapshot *snapshot) {
+    if (snapshot == nullptr) {
+        m_items.resize(1);
+        m_items[0].assign("Waiting for the first sample...");
         return;
     }
 
-    if(m_refreshThroughput) {
-        if(m_lastXmit != 0) {
-            m_xmitThroughput = (m_perfCounter->GetXmitDataBytes() - m_lastXmit) / (m_refreshInterval / 1000);
-        } else {
-            m_xmitThroughput = 0;
-        }
+    if (snapshot->error[0] != '\0') {
+        m_items.resize(3);
+        m_items[0].assign("An error occurred while refreshing the performance counters:");
+        m_items[1].assign(snapshot->error);
+        m_items[2].assign("Retrying...");
+        return;
+    }
 
-        if(m_lastRcv != 0) {
-            m_rcvThroughput = (m_perfCounter->GetRcvDataBytes() - m_lastRcv) / (m_refreshInterval / 1000);
-        } else {
-            m_rcvThroughput = 0;
-        }
+    // The lines are kept between refreshes and overwritten in place, so that their buffers are reused
+    m_items.resize(HEADER_LINE_COUNT + (snapshot->sample.hasDiag ? COUNTER_LINE_COUNT : PERF_COUNTER_LINE_COUNT));
+
+    // Lines, that are scrolled off-screen, are only formatted, when they are scrolled into view
+    auto end = std::min<size_t>(m_items.size(), m_scrollOffset + GetHeight());
 
-        m_lastXmit = m_perfCounter->GetXmitDataBytes();
-        m_lastRcv = m_perfCounter->GetRcvDataBytes();
-
-        m_refreshThroughput = false;
-    }
-
-    m_items.emplace_back(FormatValue("Xmit Throughput", m_xmitThroughput, "Bytes/s"));
-    m_items.emplace_back(FormatValue("Rcv Throughput", m_rcvThroughput, "Bytes/s"));
-
-    m_items.emplace_back(FormatValue("Xmit Data", m_perfCounter->GetXmitDataBytes(), "Bytes"));
-    m_items.emplace_back(FormatValue("Rcv Data", m_perfCounter->GetRcvDataBytes(), "Bytes"));
-    m_items.emplace_back(FormatValue("Xmit Pkts", m_perfCounter->GetXmitPkts()));
-    m_items.emplace_back(FormatValue("Rcv Pkts", m_perfCounter->GetRcvPkts()));
-
-    m_items.emplace_back(FormatValue("Unicast Xmit Pkts", m_perfCounter->GetUnicastXmitPkts()));
-    m_items.emplace_back(FormatValue("Unicast Rcv Pkts", m_perfCounter->GetUnicastRcvPkts()));
-    m_items.emplace_back(FormatValue("Multicast Xmit Pkts", m_perfCounter->GetMulticastXmitPkts()));
-    m_items.emplace_back(FormatValue("Multicast Rcv Pkts", m_perfCounter->GetMulticastRcvPkts()));
-
-    m_items.emplace_back(FormatValue("Symbol Errors", m_perfCounter->GetSymbolErrors()));
-    m_items.emplace_back(FormatValue("Link Downed", m_perfCounter->GetLinkDownedCounter()));
-    m_items.emplace_back(FormatValue("Link Recoveries", m_perfCounter->GetLinkRecoveryCounter()));
-    m_items.emplace_back(FormatValue("Rcv Errors", m_perfCounter->GetRcvErrors()));
-    m_items.emplace_back(FormatValue("Rcv Remote Physical Errors", m_perfCounter->GetRcvRemotePhysicalErrors()));
-    m_items.emplace_back(FormatValue("Rcv Switch Relay Errors", m_perfCounter->GetRcvSwitchRelayErrors()));
-    m_items.emplace_back(FormatValue("Xmit Discards", m_perfCounter->GetXmitDiscards()));
-    m_items.emplace_back(FormatValue("Xmit Constraint Errors", m_perfCounter->GetXmitConstraintErrors()));
-    m_items.emplace_back(FormatValue("Rcv Constraint Errors", m_perfCounter->GetRcvConstraintErrors()));
-    m_items.emplace_back(FormatValue("Local Link Integrity Errors", m_perfCounter->GetLocalLinkIntegrityErrors()));
-    m_items.emplace_back(FormatValue("Excessive Buffer Overrun Errors",
-            m_perfCounter->GetExcessiveBufferOverrunErrors()));
-    m_items.emplace_back(FormatValue("VL15 Dropped", m_perfCounter->GetVL15Dropped()));
-    m_items.emplace_back(FormatValue("Xmit Wait", m_perfCounter->GetXmitWait()));
-
-    m_lastXmit = m_perfCounter->GetXmitDataBytes();
-    m_lastRcv = m_perfCounter->GetRcvDataBytes();
-
-    if(m_diagPerfCounter != nullptr) {
-        m_items.emplace_back(FormatValue("Lifespan", m_diagPerfCounter->GetLifespan()));
-
-        m_items.emplace_back(FormatValue("Rq Local Length Errors", m_diagPerfCounter->GetRqLocalLengthErrors()));
-        m_items.emplace_back(FormatValue("Rq Local Qp Protection Errors",
-                m_diagPerfCounter->GetRqLocalQpProtectionErrors()));
-        m_items.emplace_back(FormatValue("Rq Out Of Sequence Errors", m_diagPerfCounter->GetRqOutOfSequenceErrors()));
-        m_items.emplace_back(FormatValue("Rq Remote Access Errors", m_diagPerfCounter->GetRqRemoteAccessErrors()));
-        m_items.emplace_back(FormatValue("Rq Remote Invalid Request Errors",
-                m_diagPerfCounter->GetRqRemoteInvalidRequestErrors()));
-        m_items.emplace_back(FormatValue("Rq Rnr Nak Num", m_diagPerfCounter->GetRqRnrNakNum()));
-        m_items.emplace_back(FormatValue("Rq Completion Queue Entry Errors",
-                m_diagPerfCounter->GetRqCompletionQueueEntryErrors()));
-
-        m_items.emplace_back(FormatValue("SqBad Response Errors", m_diagPerfCounter->GetSqBadResponseErrors()));
-        m_items.emplace_back(FormatValue("Sq Local Length Errors", m_diagPerfCounter->GetSqLocalLengthErrors()));
-        m_items.emplace_back(FormatValue("Sq Local Protection Errors",
-                m_diagPerfCounter->GetSqLocalProtectionErrors()));
-        m_items.emplace_back(FormatValue("Sq Local Qp Protection Errors",
-                m_diagPerfCounter->GetSqLocalQpProtectionErrors()));
-        m_items.emplace_back(FormatValue("Sq Memory Window Bind Errors",
-                m_diagPerfCounter->GetSqMemoryWindowBindErrors()));
-        m_items.emplace_back(FormatValue("Sq Out Of Sequence Errors",
-                m_diagPerfCounter->GetSqOutOfSequenceErrors()));
-        m_items.emplace_back(FormatValue("Sq Remote Access Errors", m_diagPerfCounter->GetSqRemoteAccessErrors()));
-        m_items.emplace_back(FormatValue("Sq Remote Invalid Request Errors",
-                m_diagPerfCounter->GetSqRemoteInvalidRequestErrors()));
-        m_items.emplace_back(FormatValue("Sq Rnr Nak Num", m_diagPerfCounter->GetSqRnrNakNum()));
-        m_items.emplace_back(FormatValue("Sq Remote Operation Errors",
-                m_diagPerfCounter->GetSqRemoteOperationErrors()));
-        m_items.emplace_back(FormatValue("Sq Rnr Nak Retries Exceeded Errors",
-                m_diagPerfCounter->GetSqRnrNakRetriesExceededErrors()));
-        m_items.emplace_back(FormatValue("Sq Transport Retries Exceeded Errors",
-                m_diagPerfCounter->GetSqTransportRetriesExceededErrors()));
-        m_items.emplace_back(FormatValue("Sq Completion Queue Entry Errors",
-                m_diagPerfCounter->GetSqCompletionQueueEntryErrors()));
+    for (auto line = static_cast<uint32_t>(m_scrollOffset); line < end; line++) {
+        FormatLine(line, *snapshot);
     }
 }
 
+void MonitorWindow::FormatLine(uint32_t line, const Snapshot &snapshot) {
+    char buffer[128];
+    int length;
+
+    if (line == 0) {
+        // Show the wall clock time of the sample, which is important when replaying a recording
+        auto time = static_cast<time_t>((static_cast<int64_t>(snapshot.sample.timestamp) +
+                                         m_sampler.GetClockOffset()) / 1000000000);
+        tm localTime{};
+        localtime_r(&time, &localTime);
+
+        char timeString[32];
+        strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", &localTime);
+
+        length = snprintf(buffer, sizeof(buffer), "%-40s %s", "Sample Time:", timeString);
+    } else if (line == 1) {
+        uint64_t tenths = (snapshot.delta.elapsed + 50000) / 100000;
+
+        length = snprintf(buffer, sizeof(buffer), "%-40s %u ms (measured: %" PRIu64 ".%" PRIu64 " ms)",
+                          "Sample Interval:", m_sampler.GetRefreshInterval(), tenths / 10, tenths % 10);
+    } else if (line == 2) {
+        length = snprintf(buffer, sizeof(buffer), "%-40s %13s %13s %13s", "Counter", "Total", "Delta", "Rate");
+    } else {
+        length = FormatCounter(buffer, sizeof(buffer), counterDescriptors[line - HEADER_LINE_COUNT], snapshot);
+    }
+
+    m_items[line].assign(buffer, std::min<size_t>(std::max(length, 0), sizeof(buffer) - 1));
+}
+
 void MonitorWindow::ResetValues() {
-    m_refreshLock.lock();
+    m_sampler.ResetCounter(m_device);
+}
 
-    m_perfCounter->ResetCounters();
+/**
+ * Write the decimal digits of a value.
+ *
+ * @param out The position, at which the digits are written
+ * @param value The value
+ * @param minDigits The minimum amount of digits (padded with leading zeros)
+ *
+ * @return The position behind the last digit
+ */
+static char *appendDigits(char *out, uint64_t value, uint32_t minDigits = 1) {
+    char digits[20];
+    uint32_t count = 0;
+
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0 || count < minDigits);
+
+    while (count > 0) {
+        *out++ = digits[--count];
+    }
 
-    m_xmitThroughput = 0;
-    m_lastXmit = 0;
+    return out;
+}
 
-    m_rcvThroughput = 0;
-    m_lastRcv = 0;
+/**
+ * Write a field of a counter line: A space followed by the right-aligned text.
+ *
+ * @return The position behind the field
+ */
+static char *appendField(char *out, const char *text, int length) {
+    auto padding = static_cast<uint32_t>(std::max(COLUMN_WIDTH - length, 0));
 
-    RefreshValues();
+    memset(out, ' ', padding + 1);
+    memcpy(out + padding + 1, text, static_cast<size_t>(length));
 
-    m_refreshLock.unlock();
+    return out + padding + 1 + length;
 }
 
-void MonitorWindow::RefreshThread() {
-    while (true) {
-        m_refreshLock.lock();
-        
-        m_refreshThroughput = true;
-        RefreshValues();
-        Curses::WindowManager::GetInstance()->RequestRefresh();
-
-        m_refreshLock.unlock();
-        std::this_thread::sleep_for(std::chrono::milliseconds(m_refreshInterval));
+int MonitorWindow::FormatCounter(char *buffer, size_t size, const CounterDescriptor &counter,
+                                 const Snapshot &snapshot) {
+    char total[VALUE_LENGTH];
+    char delta[VALUE_LENGTH + 1] = "-";
+    char rate[VALUE_LENGTH] = "-";
+    int totalLength = FormatValue(total, sizeof(total), snapshot.sample.values[counter.id], 0, counter.unit);
+    int deltaLength = 1;
+    int rateLength = 1;
+
+    if (snapshot.hasDelta && !CounterDelta::IsGauge(counter.id)) {
+        double rateValue = snapshot.delta.rates[counter.id];
+        auto rateInteger = static_cast<uint64_t>(rateValue);
+        auto rateHundredths = static_cast<uint32_t>((rateValue - rateInteger) * 100 + 0.5);
+
+        delta[0] = '+';
+        deltaLength = 1 + FormatValue(delta + 1, sizeof(delta) - 1, snapshot.delta.deltas[counter.id], 0,
+                                      counter.unit);
+        rateLength = FormatValue(rate, sizeof(rate), rateInteger, rateHundredths, counter.rateUnit);
     }
+
+    // Equivalent to "%-40s %13s %13s %13s", but without parsing a format string for every line
+    char line[LABEL_WIDTH + 3 * (VALUE_LENGTH + 1)];
+    auto labelLength = std::min(static_cast<int>(strlen(counter.label)), LABEL_WIDTH);
+    char *out = line;
+
+    memcpy(out, counter.label, static_cast<size_t>(labelLength));
+    out += labelLength;
+
+    memset(out, ' ', static_cast<size_t>(LABEL_WIDTH - labelLength));
+    out += LABEL_WIDTH - labelLength;
+
+    out = appendField(out, total, totalLength);
+    out = appendField(out, delta, deltaLength);
+    out = appendField(out, rate, rateLength);
+
+    auto length = std::min<size_t>(static_cast<size_t>(out - line), size - 1);
+
+    memcpy(buffer, line, length);
+    buffer[length] = '\0';
+
+    return static_cast<int>(length);
 }
 
-std::string MonitorWindow::FormatValue(const std::string &name, uint64_t value, const std::string &unit) {
-    long double fValue = value;
-    char buf[GetWidth()];
+int MonitorWindow::FormatValue(char *buffer, size_t size, uint64_t value, uint32_t hundredths, const char *unit) {
+    char text[VALUE_LENGTH + 16];
+    char *out = text;
 
-    // Calculate formatted value
-    uint32_t counter = 0;
-    while (fValue > 1000 && counter < sizeof(metricTable)) {
-        fValue = fValue / 1000;
-        counter++;
+    if (hundredths >= 100) {
+        value += hundredths / 100;
+        hundredths %= 100;
     }
 
-    // Print name and value
-    snprintf(buf, GetWidth(), "%-40s %.3Lf %c%s (%lu)", (name + ":").c_str(),
-            fValue, metricTable[counter], unit.c_str(), value);
+    // Small values are shown exactly, unless they are fractional rates
+    if (value < 1000) {
+        out = appendDigits(out, value);
+
+        if (hundredths > 0) {
+            *out++ = '.';
+            out = appendDigits(out, hundredths, 2);
+        }
+
+        if (*unit != '\0') {
+            *out++ = ' ';
+        }
+    } else {
+        uint32_t prefix = 1;
+
+        while (prefix < sizeof(metricTable) - 1 && value / metricDivisors[prefix] >= 1000) {
+            prefix++;
+        }
 
-    return std::string(buf);
+        // Three decimals, rounded half up
+        uint64_t divisor = metricDivisors[prefix];
+        uint64_t integer = value / divisor;
+        uint64_t thousandths = (value % divisor + divisor / 2000) / (divisor / 1000);
+
+        if (thousandths >= 1000) {
+            integer++;
+            thousandths -= 1000;
+        }
+
+        out = appendDigits(out, integer);
+        *out++ = '.';
+        out = appendDigits(out, thousandths, 3);
+        *out++ = ' ';
+        *out++ = metricTable[prefix];
+    }
+
+    for (const char *c = unit; *c != '\0' && out < text + sizeof(text); c++) {
+        *out++ = *c;
+    }
+
+    auto length = std::min<size_t>(static_cast<size_t>(out - text), size - 1);
+
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+
+    return static_cast<int>(length);
 }
 
-}
\ No newline at end of file
+}
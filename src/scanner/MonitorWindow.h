@@ -1,29 +1,37 @@
 #ifndef IBSCANNER_MONITORWINDOW_H
 #define IBSCANNER_MONITORWINDOW_H
 
-#include <thread>
-#include <mutex>
+#include <atomic>
 #include <unistd.h>
 #include <ncurses.h>
-#include <detector/IbPerfCounter.h>
-#include <detector/IbDiagPerfCounter.h>
 #include <curses/Window.h>
 #include <curses/WindowManager.h>
 #include <curses/ListWindow.h>
+#include "CounterDelta.h"
+#include "Sampler.h"
 
 namespace Scanner {
 
+struct CounterDescriptor;
+
 /**
  * ListWindow, which shows the performance counters of an Infiniband device.
  *
- * The counters are automatically refreshed in a given interval.
+ * The counters are refreshed by a Sampler, as long as the window is active. The samples are handed over to the UI
+ * thread in a triple buffer of preallocated snapshots: The sampler thread writes into its own buffer and swaps it with
+ * the published one, while the UI thread swaps the published buffer with the one it is showing. Neither thread ever
+ * waits for the other one and no memory is allocated per sample.
+ *
+ * The lines are described by a table of counters. They are overwritten in place and only formatted while they are
+ * visible, so that refreshing the window does not allocate any memory.
  *
  * @author Fabian Ruhland, Fabian.Ruhland@hhu.de
  * @date May 2018
  */
-class MonitorWindow : public Curses::ListWindow {
+class MonitorWindow : public Curses::ListWindow, public Sampler::Listener {
 
 public:
+
     /**
      * Constructor.
      *
@@ -32,12 +40,11 @@ public:
      * @param width The width
      * @param height The height
      * @param title The title (shown at the window's top)
-     * @param perfCounter The performance counter to be displayed
-     * @param refreshInterval The interval, in which the counters shall be refreshed
+     * @param sampler The sampler, which refreshes the counters
+     * @param device The device, whose counters shall be displayed
      */
     MonitorWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, const char *title,
-                  Detector::IbPerfCounter *perfCounter, Detector::IbDiagPerfCounter *diagPerfCounter = nullptr,
-                  uint32_t refreshInterval = 2000);
+                  Sampler &sampler, const Device *device);
 
     /**
      * Destructor.
@@ -45,53 +52,181 @@ public:
     ~MonitorWindow() override;
 
     /**
-     * Set the performance counters.
+     * Set the device, whose counters shall be displayed.
      */
-    void SetPerfCounter(Detector::IbPerfCounter *perfCounter, Detector::IbDiagPerfCounter *diagPerfCounter = nullptr);
+    void SetDevice(const Device *device);
 
     /**
      * Reset the counters.
      */
     void ResetValues();
 
+    /**
+     * Activate/deactivate the window.
+     *
+     * Only active windows are subscribed to the sampler. Inactive windows don't cause any queries.
+     *
+     * @param active true, to activate the window
+     */
+    void SetActive(bool active);
+
+    /**
+     * Overriding function from Sampler::Listener.
+     */
+    void OnSample(const CounterSample &sample) override;
+
+    /**
+     * Overriding function from Sampler::Listener.
+     */
+    void OnSampleError(const char *message) override;
+
+    /**
+     * Take the latest snapshot and rebuild the lines, that are visible, if they have changed (only called by the
+     * UI thread). This is the part of drawing, that does not need a terminal.
+     */
+    void UpdateItems();
+
+    /**
+     * Format a value with a metric prefix, using integer arithmetic only.
+     *
+     * @param buffer The buffer, that receives the formatted value
+     * @param size The buffer's size
+     * @param value The value's integer part
+     * @param hundredths The value's fractional part in hundredths (only shown for values below 1000)
+     * @param unit The values's unit
+     *
+     * @return The formatted value's length (limited to the buffer's size)
+     */
+    static int FormatValue(char *buffer, size_t size, uint64_t value, uint32_t hundredths, const char *unit);
+
 private:
+
+    /**
+     * The values of a single sample.
+     *
+     * Snapshots are never modified, while they are published or shown.
+     */
+    struct Snapshot {
+        CounterSample sample;
+        CounterDelta delta;
+        bool hasDelta;
+
+        /**
+         * The device generation, that the sample belongs to (see m_generation).
+         */
+        uint32_t generation;
+
+        /**
+         * The error message (empty, if the sample has been read successfully).
+         */
+        char error[256];
+    };
+
+    /**
+     * Marks the published snapshot as not yet taken by the UI thread.
+     */
+    static constexpr uint8_t SNAPSHOT_FRESH = 0x80;
+
+    /**
+     * Publish the snapshot, that has been written by the sampler thread, and take over the previously published one.
+     */
+    void PublishSnapshot();
+
+    /**
+     * Take the published snapshot, if a new one has been published since the last call (only called by the UI thread).
+     *
+     * @return true, if a new snapshot has been taken
+     */
+    bool TakeSnapshot();
+
+    /**
+     * Get the snapshot, that has been taken last (only called by the UI thread).
+     *
+     * @return The snapshot (nullptr, if no sample of the current device has arrived yet)
+     */
+    const Snapshot *GetTakenSnapshot() const;
+
     /**
      * Overriding function from Window.
      */
     void DrawContent() override;
 
     /**
-     * Refresh the counters.
+     * Refresh the shown values from a snapshot.
+     *
+     * @param snapshot The snapshot (nullptr, if no sample has arrived yet)
      */
-    void RefreshValues();
+    void RefreshValues(const Snapshot *snapshot);
 
     /**
-     * Refreshes the values in the given interval.
+     * Overwrite a line with the current values.
+     *
+     * @param line The line's index
+     * @param snapshot The snapshot
      */
-    void RefreshThread();
+    void FormatLine(uint32_t line, const Snapshot &snapshot);
 
     /**
-     * Format a value.
+     * Format the line of a counter, which shows its total, its delta since the previous sample and its rate.
      *
-     * @param value The value
-     * @param unit The values's unit (Default = "Units")
+     * @param buffer The buffer, that receives the line
+     * @param size The buffer's size
+     * @param counter The counter
+     * @param snapshot The snapshot
      *
-     * @return The formatted string
+     * @return The line's length (limited to the buffer's size)
      */
-    std::string FormatValue(const std::string &name, uint64_t value, const std::string &unit = "Units");
+    static int FormatCounter(char *buffer, size_t size, const CounterDescriptor &counter, const Snapshot &snapshot);
 
 private:
 
-    Detector::IbPerfCounter *m_perfCounter;
-    Detector::IbDiagPerfCounter *m_diagPerfCounter;
+    const Device *m_device;
+
+    /**
+     * The triple buffer. Each snapshot is owned by exactly one of m_writtenSnapshot, m_publishedSnapshot and
+     * m_takenSnapshot at any time.
+     */
+    Snapshot m_snapshots[3];
+
+    /**
+     * The index of the snapshot, that the sampler thread writes into (only accessed by the sampler thread).
+     */
+    uint8_t m_writtenSnapshot;
+
+    /**
+     * The index of the published snapshot, combined with SNAPSHOT_FRESH; Exchanged by both threads.
+     */
+    std::atomic<uint8_t> m_publishedSnapshot;
+
+    /**
+     * The index of the snapshot, that m_items have been built from (only accessed by the UI thread).
+     */
+    uint8_t m_takenSnapshot;
+
+    /**
+     * The previous sample, which the deltas are calculated from.
+     * Only accessed by the sampler thread, or by the UI thread while the window is not subscribed to the sampler.
+     */
+    CounterSample m_previousSample;
+    bool m_hasPreviousSample;
+
+    /**
+     * Incremented, whenever the device changes, so that snapshots of the previous device are not shown anymore.
+     *
+     * Only written by the UI thread while the window is not subscribed to the sampler, so that the sampler thread
+     * can read it in its listener callbacks without further synchronization.
+     */
+    uint32_t m_generation;
+    bool m_showsPlaceholder;
 
-    uint64_t m_lastXmit, m_lastRcv;
-    uint64_t m_xmitThroughput, m_rcvThroughput;
-    bool m_refreshThroughput;
+    /**
+     * The visible lines, when the items have been refreshed; Only those lines have been formatted.
+     */
+    int32_t m_formattedOffset;
+    uint32_t m_formattedHeight;
 
-    std::mutex m_refreshLock;
-    std::thread m_refreshThread;
-    uint32_t m_refreshInterval;
+    Sampler &m_sampler;
+    bool m_isActive;
 
     static char metricTable[7];
 };
@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Player.h"
+
+namespace Scanner {
+
+Player::Player(const char *path) :
+        m_fd(-1),
+        m_data(nullptr),
+        m_size(0),
+        m_header(nullptr),
+        m_devices(nullptr),
+        m_recordCount(0),
+        m_firstTime(0),
+        m_lastTime(0),
+        m_sweepStart(0),
+        m_sweepEnd(0),
+        m_anchorTime(0),
+        m_speed(1),
+        m_isPaused(false) {
+    m_fd = open(path, O_RDONLY);
+
+    if (m_fd < 0) {
+        throw std::runtime_error(std::string("Unable to open '") + path + "': " + strerror(errno));
+    }
+
+    struct stat status{};
+
+    if (fstat(m_fd, &status) < 0 || static_cast<size_t>(status.st_size) < sizeof(Recording::Header)) {
+        close(m_fd);
+        throw std::runtime_error(std::string("'") + path + "' is not a recording!");
+    }
+
+    m_size = static_cast<size_t>(status.st_size);
+
+    // Records are only read on demand, so mapping the file does not read anything
+    void *data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+
+    if (data == MAP_FAILED) {
+        close(m_fd);
+        throw std::runtime_error(std::string("Unable to map '") + path + "': " + strerror(errno));
+    }
+
+    m_data = static_cast<const uint8_t*>(data);
+    m_header = reinterpret_cast<const Recording::Header*>(m_data);
+    m_devices = reinterpret_cast<const Recording::Device*>(m_data + sizeof(Recording::Header));
+
+    uint64_t tableEnd = sizeof(Recording::Header) + static_cast<uint64_t>(m_header->deviceCount) *
+                                                    sizeof(Recording::Device);
+
+    if (memcmp(m_header->magic, Recording::MAGIC, sizeof(Recording::MAGIC)) != 0 ||
+            m_header->version != Recording::VERSION || m_header->recordSize != sizeof(Recording::Record) ||
+            m_header->counterCount != COUNTER_COUNT || m_header->recordOffset < tableEnd ||
+            m_header->recordOffset > m_size) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+        close(m_fd);
+        throw std::runtime_error(std::string("'") + path + "' is not a recording of this version!");
+    }
+
+    m_recordCount = (m_size - m_header->recordOffset) / sizeof(Recording::Record);
+
+    // The recorder preallocates the file, so a recording, that has not been closed properly, ends with empty records
+    uint64_t low = 0;
+    uint64_t high = m_recordCount;
+
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+
+        if (GetRecord(middle).timestamp != 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    m_recordCount = low;
+
+    if (m_recordCount == 0) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+        close(m_fd);
+        throw std::runtime_error(std::string("'") + path + "' does not contain any samples!");
+    }
+
+    m_firstTime = GetRecord(0).timestamp;
+    m_lastTime = GetRecord(FindSweepStart(m_recordCount - 1)).timestamp;
+
+    m_sweepEnd = FindSweepEnd(0);
+
+    m_anchorTime = m_firstTime;
+    m_anchorClock = std::chrono::steady_clock::now();
+}
+
+Player::~Player() {
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+    close(m_fd);
+}
+
+void Player::AddDevices(Topology &topology) const {
+    for (uint32_t i = 0; i < m_header->deviceCount; i++) {
+        const Recording::Device &device = m_devices[i];
+        std::string name(device.name, strnlen(device.name, sizeof(device.name)));
+
+        if (device.portNum == 0xff) {
+            topology.AddNode(device.guid, name, device.lid);
+        } else if (device.nodeId < topology.GetDeviceCount() && topology.GetDevice(device.nodeId).IsNode()) {
+            topology.AddPort(device.nodeId, device.lid, device.portNum);
+        } else {
+            throw std::runtime_error("The recording's device table is corrupt!");
+        }
+    }
+}
+
+void Player::Synchronize() {
+    uint64_t time;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        time = GetReplayTime(std::chrono::steady_clock::now());
+    }
+
+    // Find the first record, that has been taken after the replay time
+    uint64_t low = 0;
+    uint64_t high = m_recordCount;
+
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+
+        if (GetRecord(middle).timestamp <= time) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    m_sweepStart = FindSweepStart(low > 0 ? low - 1 : 0);
+    m_sweepEnd = FindSweepEnd(m_sweepStart);
+}
+
+const char *Player::Read(uint32_t deviceId, CounterSample &sample) const {
+    uint64_t low = m_sweepStart;
+    uint64_t high = m_sweepEnd;
+
+    // Records of a sweep are sorted by device id
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+
+        if (GetRecord(middle).deviceId < deviceId) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low == m_sweepEnd || GetRecord(low).deviceId != deviceId) {
+        return "The device has not been recorded at this point of time!";
+    }
+
+    const Recording::Record &record = GetRecord(low);
+
+    if (record.flags & Recording::RECORD_ERROR) {
+        return "An error occurred while recording the counters!";
+    }
+
+    memcpy(sample.values, record.values, sizeof(sample.values));
+    sample.timestamp = record.timestamp;
+    sample.hasDiag = (record.flags & Recording::RECORD_HAS_DIAG) != 0;
+
+    return nullptr;
+}
+
+std::chrono::steady_clock::time_point Player::GetNextSweepTime() const {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    auto now = std::chrono::steady_clock::now();
+
+    // Nothing will change until the player is resumed or moved, which requests a new sample anyway
+    if (m_isPaused || m_sweepEnd >= m_recordCount) {
+        return now + std::chrono::hours(1);
+    }
+
+    uint64_t time = GetReplayTime(now);
+    uint64_t nextTime = GetRecord(m_sweepEnd).timestamp;
+
+    if (nextTime <= time) {
+        return now;
+    }
+
+    return now + std::chrono::nanoseconds((nextTime - time) / m_speed);
+}
+
+void Player::Seek(int64_t offset) {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    auto time = static_cast<int64_t>(GetReplayTime(std::chrono::steady_clock::now())) + offset;
+
+    if (time < static_cast<int64_t>(m_firstTime)) {
+        time = static_cast<int64_t>(m_firstTime);
+    } else if (time > static_cast<int64_t>(m_lastTime)) {
+        time = static_cast<int64_t>(m_lastTime);
+    }
+
+    SetReplayTime(static_cast<uint64_t>(time));
+}
+
+void Player::SeekRelative(double fraction) {
+    Seek(static_cast<int64_t>(fraction * (m_lastTime - m_firstTime)));
+}
+
+void Player::SetSpeed(uint32_t speed) {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    SetReplayTime(GetReplayTime(std::chrono::steady_clock::now()));
+
+    m_speed = speed > 0 ? speed : 1;
+}
+
+void Player::SetPaused(bool paused) {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    SetReplayTime(GetReplayTime(std::chrono::steady_clock::now()));
+
+    m_isPaused = paused;
+}
+
+const Recording::Record &Player::GetRecord(uint64_t index) const {
+    return reinterpret_cast<const Recording::Record*>(m_data + m_header->recordOffset)[index];
+}
+
+uint64_t Player::FindSweepStart(uint64_t index) const {
+    uint64_t sweep = GetRecord(index).sweep;
+    uint64_t low = 0;
+    uint64_t high = index;
+
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+
+        if (GetRecord(middle).sweep < sweep) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+uint64_t Player::FindSweepEnd(uint64_t index) const {
+    uint64_t sweep = GetRecord(index).sweep;
+    uint64_t low = index;
+    uint64_t high = m_recordCount;
+
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+
+        if (GetRecord(middle).sweep <= sweep) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+uint64_t Player::GetReplayTime(std::chrono::steady_clock::time_point now) const {
+    if (m_isPaused) {
+        return m_anchorTime;
+    }
+
+    auto elapsed = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_anchorClock).count());
+    uint64_t time = m_anchorTime + elapsed * m_speed;
+
+    return time < m_lastTime ? time : m_lastTime;
+}
+
+void Player::SetReplayTime(uint64_t time) {
+    m_anchorTime = time;
+    m_anchorClock = std::chrono::steady_clock::now();
+}
+
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_PLAYER_H
+#define IBSCANNER_PLAYER_H
+
+#include <chrono>
+#include <mutex>
+#include "Recording.h"
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * Replays a recording, that has been written by a Recorder.
+ *
+ * The file is mapped into memory as a whole and records are located via binary search, so that even recordings of
+ * several gigabytes can be opened instantly. The player keeps a replay clock, which runs at a configurable speed
+ * and can be paused or moved. The Sampler reads the sweep, that matches the current replay time.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class Player {
+
+public:
+    /**
+     * Constructor.
+     *
+     * Throws std::runtime_error, if the file cannot be opened or is not a valid recording.
+     *
+     * @param path The recording's path
+     */
+    explicit Player(const char *path);
+
+    /**
+     * Destructor.
+     */
+    ~Player();
+
+    Player(const Player &copy) = delete;
+
+    Player& operator=(const Player &other) = delete;
+
+    /**
+     * Add all recorded devices to a topology.
+     *
+     * The topology must be empty, so that the device ids match the ids inside the recording.
+     *
+     * @param topology The topology
+     */
+    void AddDevices(Topology &topology) const;
+
+    /**
+     * Move to the sweep, that matches the current replay time.
+     */
+    void Synchronize();
+
+    /**
+     * Read the sample of a device from the current sweep.
+     *
+     * @param deviceId The device's id
+     * @param sample Receives the sample
+     *
+     * @return nullptr on success, or an error message
+     */
+    const char *Read(uint32_t deviceId, CounterSample &sample) const;
+
+    /**
+     * Get the point in time, at which the next sweep is due (far in the future, if paused or at the end).
+     */
+    std::chrono::steady_clock::time_point GetNextSweepTime() const;
+
+    /**
+     * Move the replay time.
+     *
+     * @param offset The offset in nanoseconds (negative to move backwards)
+     */
+    void Seek(int64_t offset);
+
+    /**
+     * Move the replay time by a fraction of the recording's duration.
+     *
+     * @param fraction The fraction (e.g. -0.05 to move backwards by 5%)
+     */
+    void SeekRelative(double fraction);
+
+    /**
+     * Set the replay speed (1 is real time).
+     */
+    void SetSpeed(uint32_t speed);
+
+    uint32_t GetSpeed() const {
+        return m_speed;
+    }
+
+    void SetPaused(bool paused);
+
+    bool IsPaused() const {
+        return m_isPaused;
+    }
+
+    /**
+     * Get the difference between CLOCK_REALTIME and CLOCK_MONOTONIC at the time of recording in nanoseconds.
+     */
+    int64_t GetClockOffset() const {
+        return m_header->clockOffset;
+    }
+
+    /**
+     * Get the amount of records in the file.
+     */
+    uint64_t GetRecordCount() const {
+        return m_recordCount;
+    }
+
+private:
+
+    const Recording::Record &GetRecord(uint64_t index) const;
+
+    /**
+     * Find the first record of the sweep, that contains a given record.
+     */
+    uint64_t FindSweepStart(uint64_t index) const;
+
+    /**
+     * Find the first record of the sweep after the one, that contains a given record.
+     */
+    uint64_t FindSweepEnd(uint64_t index) const;
+
+    /**
+     * Get the replay time (CLOCK_MONOTONIC of the recording in nanoseconds). Must be called with the lock held.
+     */
+    uint64_t GetReplayTime(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * Restart the replay clock at a given replay time. Must be called with the lock held.
+     */
+    void SetReplayTime(uint64_t time);
+
+private:
+
+    int m_fd;
+
+    const uint8_t *m_data;
+    size_t m_size;
+
+    const Recording::Header *m_header;
+    const Recording::Device *m_devices;
+
+    uint64_t m_recordCount;
+
+    uint64_t m_firstTime;
+    uint64_t m_lastTime;
+
+    uint64_t m_sweepStart;
+    uint64_t m_sweepEnd;
+
+    uint64_t m_anchorTime;
+    std::chrono::steady_clock::time_point m_anchorClock;
+
+    uint32_t m_speed;
+    bool m_isPaused;
+
+    mutable std::mutex m_lock;
+};
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <stdexcept>
+#include "PmaConnection.h"
+#include "UmadPmaTransport.h"
+
+namespace Scanner {
+
+PmaConnection::PmaConnection(Sampler &sampler, bool compatibility, uint32_t maxOutstanding,
+                             PmaTransport *transport) :
+        m_ownTransport(nullptr),
+        m_queryEngine(nullptr) {
+    if (transport == nullptr) {
+        // In compatibility mode, the counters are read from the filesystem
+        if (compatibility) {
+            return;
+        }
+
+        try {
+            m_ownTransport = new UmadPmaTransport();
+        } catch (const std::runtime_error &exception) {
+            // Fall back to querying the counters one after another via Detector
+            return;
+        }
+
+        transport = m_ownTransport;
+    }
+
+    m_queryEngine = new PmaQueryEngine(*transport, maxOutstanding);
+    sampler.SetQueryEngine(m_queryEngine);
+}
+
+PmaConnection::~PmaConnection() {
+    delete m_queryEngine;
+    delete m_ownTransport;
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_PMACONNECTION_H
+#define IBSCANNER_PMACONNECTION_H
+
+#include "PmaQueryEngine.h"
+#include "PmaTransport.h"
+#include "Sampler.h"
+
+namespace Scanner {
+
+/**
+ * Sets up the transport and the pipelined query engine, that a sampler queries the performance management agents
+ * with, and owns both of them.
+ *
+ * In compatibility mode or without access to the performance management agents (e.g. without root privileges),
+ * no query engine is set up, so that the sampler falls back to refreshing the counters via Detector.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class PmaConnection {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param sampler The sampler, that shall use the query engine (must not have been started yet)
+     * @param compatibility true, if the counters are read from the filesystem (compatibility mode)
+     * @param maxOutstanding The maximum amount of queries in flight
+     * @param transport The transport to use instead of libibumad, e.g. a simulated fabric (not owned; may be nullptr)
+     */
+    PmaConnection(Sampler &sampler, bool compatibility, uint32_t maxOutstanding, PmaTransport *transport = nullptr);
+
+    /**
+     * Destructor.
+     *
+     * The sampler must have been stopped before.
+     */
+    ~PmaConnection();
+
+    PmaConnection(const PmaConnection &copy) = delete;
+
+    PmaConnection& operator=(const PmaConnection &other) = delete;
+
+    /**
+     * Check, if the counters are queried via the pipelined query engine.
+     */
+    bool HasQueryEngine() const {
+        return m_queryEngine != nullptr;
+    }
+
+private:
+
+    /**
+     * The transport, that has been created by the connection (nullptr, if an external transport is used).
+     */
+    PmaTransport *m_ownTransport;
+
+    PmaQueryEngine *m_queryEngine;
+};
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "PmaQueryEngine.h"
+
+namespace Scanner {
+
+PmaQueryEngine::PmaQueryEngine(PmaTransport &transport, uint32_t maxOutstanding, uint32_t timeout) :
+        m_transport(transport),
+        m_maxOutstanding(maxOutstanding > 0 ? maxOutstanding : 1),
+        m_timeout(timeout),
+        m_nextTid(1),
+        m_sentCount(0),
+        m_timeoutCount(0),
+        m_roundTripHistogram(nullptr) {
+    m_inFlight.reserve(m_maxOutstanding);
+}
+
+void PmaQueryEngine::Execute(Query *queries, size_t count) {
+    // Every query consists of two MADs: PortCounters and PortCountersExtended
+    size_t nextMad = 0;
+    size_t madCount = count * 2;
+
+    for (size_t i = 0; i < count; i++) {
+        queries[i].error = nullptr;
+        queries[i].pending = 2;
+    }
+
+    while (nextMad < madCount || !m_inFlight.empty()) {
+        // Fill the window
+        while (nextMad < madCount && m_inFlight.size() < m_maxOutstanding) {
+            Query &query = queries[nextMad / 2];
+            auto attribute = static_cast<PmaAttribute>(nextMad % 2);
+            uint32_t tid = m_nextTid++;
+
+            nextMad++;
+
+            if (!m_transport.Send(tid, query.lid, query.portNum, attribute)) {
+                query.error = "Unable to send performance management query!";
+                query.pending--;
+
+                continue;
+            }
+
+            auto sendTime = std::chrono::steady_clock::now();
+
+            m_inFlight[tid] = InFlight{&query, sendTime};
+            m_deadlines.emplace_back(tid, sendTime + m_timeout);
+            m_sentCount++;
+        }
+
+        // All queries are sent with the same timeout, so the deadlines are sorted by their send order
+        auto now = std::chrono::steady_clock::now();
+
+        while (!m_deadlines.empty()) {
+            auto inFlight = m_inFlight.find(m_deadlines.front().first);
+
+            if (inFlight == m_inFlight.end()) {
+                // Already answered
+                m_deadlines.pop_front();
+            } else if (m_deadlines.front().second <= now) {
+                inFlight->second.query->error = "Performance management query timed out!";
+                inFlight->second.query->pending--;
+
+                m_inFlight.erase(inFlight);
+                m_deadlines.pop_front();
+                m_timeoutCount++;
+            } else {
+                break;
+            }
+        }
+
+        if (m_inFlight.empty()) {
+            continue;
+        }
+
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(m_deadlines.front().second - now).count();
+
+        PmaResponse response{};
+
+        if (!m_transport.Receive(response, static_cast<uint32_t>(wait > 0 ? wait : 1))) {
+            continue;
+        }
+
+        auto inFlight = m_inFlight.find(response.tid);
+
+        if (inFlight == m_inFlight.end()) {
+            // Late response to a query, that has already timed out
+            continue;
+        }
+
+        if (m_roundTripHistogram != nullptr) {
+            m_roundTripHistogram->Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - inFlight->second.sendTime).count()));
+        }
+
+        Complete(*inFlight->second.query, response);
+
+        m_inFlight.erase(inFlight);
+    }
+
+    m_deadlines.clear();
+}
+
+void PmaQueryEngine::Complete(Query &query, const PmaResponse &response) {
+    query.pending--;
+
+    if (!response.success) {
+        query.error = "The performance management agent returned an error!";
+
+        return;
+    }
+
+    // PortCountersExtended provides the 64-bit data and packet counters, PortCounters provides the error counters
+    uint8_t first = response.attribute == PORT_COUNTERS_EXTENDED ? XMIT_DATA_BYTES : SYMBOL_ERRORS;
+    uint8_t last = response.attribute == PORT_COUNTERS_EXTENDED ? MULTICAST_RCV_PKTS : XMIT_WAIT;
+
+    for (uint8_t i = first; i <= last; i++) {
+        query.sample.values[i] = response.values[i];
+    }
+
+    // The sample is complete with the second response
+    if (query.pending == 0) {
+        query.sample.timestamp = CounterSample::GetMonotonicTime();
+    }
+}
+
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef IBSCANNER_PMAQUERYENGINE_H
+#define IBSCANNER_PMAQUERYENGINE_H
+
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include "LatencyHistogram.h"
+#include "PmaTransport.h"
+
+namespace Scanner {
+
+/**
+ * Queries the PortCounters and PortCountersExtended attributes of many ports with a window of outstanding MADs.
+ *
+ * Instead of waiting for each response before sending the next query, up to a configurable amount of queries are
+ * kept in flight. Responses are matched to their queries by transaction ID. Thus, a sweep over N ports costs roughly
+ * one round trip time plus the time needed to serialize N queries, instead of N round trip times.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class PmaQueryEngine {
+
+public:
+    /**
+     * A single port to be queried.
+     */
+    struct Query {
+        uint16_t lid;
+        uint8_t portNum;
+
+        /**
+         * Receives the counters of both attributes.
+         */
+        CounterSample sample;
+
+        /**
+         * Set to an error message, if one of the attributes could not be queried; nullptr on success.
+         */
+        const char *error;
+
+        /**
+         * Internal use; The amount of attributes, that are still in flight.
+         */
+        uint8_t pending;
+    };
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param transport The transport used to send and receive MADs
+     * @param maxOutstanding The maximum amount of MADs in flight
+     * @param timeout The time in milliseconds after which an unanswered MAD is considered lost
+     */
+    PmaQueryEngine(PmaTransport &transport, uint32_t maxOutstanding = 64, uint32_t timeout = 500);
+
+    /**
+     * Destructor.
+     */
+    ~PmaQueryEngine() = default;
+
+    /**
+     * Query all given ports and block until every query has either been answered or timed out.
+     *
+     * @param queries The queries
+     * @param count The amount of queries
+     */
+    void Execute(Query *queries, size_t count);
+
+    /**
+     * Get the amount of MADs sent since the engine has been created.
+     */
+    uint64_t GetSentCount() const {
+        return m_sentCount;
+    }
+
+    /**
+     * Get the amount of MADs, that timed out since the engine has been created.
+     */
+    uint64_t GetTimeoutCount() const {
+        return m_timeoutCount;
+    }
+
+    /**
+     * Set a histogram, which receives the round trip time of every answered MAD in nanoseconds.
+     *
+     * @param roundTripHistogram The histogram (nullptr to disable the measurement)
+     */
+    void SetRoundTripHistogram(LatencyHistogram *roundTripHistogram) {
+        m_roundTripHistogram = roundTripHistogram;
+    }
+
+private:
+    /**
+     * A MAD, that has been sent, but not been answered yet.
+     */
+    struct InFlight {
+        Query *query;
+        std::chrono::steady_clock::time_point sendTime;
+    };
+
+    /**
+     * Merge a response into its query.
+     *
+     * @param query The query
+     * @param response The response
+     */
+    void Complete(Query &query, const PmaResponse &response);
+
+private:
+
+    PmaTransport &m_transport;
+
+    uint32_t m_maxOutstanding;
+    std::chrono::milliseconds m_timeout;
+
+    uint32_t m_nextTid;
+
+    std::unordered_map<uint32_t, InFlight> m_inFlight;
+    std::deque<std::pair<uint32_t, std::chrono::steady_clock::time_point>> m_deadlines;
+
+    uint64_t m_sentCount;
+    uint64_t m_timeoutCount;
+
+    LatencyHistogram *m_roundTripHistogram;
+};
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef IBSCANNER_PMATRANSPORT_H
+#define IBSCANNER_PMATRANSPORT_H
+
+#include <cstdint>
+#include "CounterSample.h"
+
+namespace Scanner {
+
+/**
+ * The attributes of the performance management class, that can be queried via a PmaTransport.
+ */
+enum PmaAttribute : uint8_t {
+    PORT_COUNTERS,
+    PORT_COUNTERS_EXTENDED
+};
+
+/**
+ * A decoded response of a performance management agent.
+ */
+struct PmaResponse {
+
+    uint32_t tid;
+
+    PmaAttribute attribute;
+
+    bool success;
+
+    /**
+     * The decoded counters. Only the counters contained in the queried attribute are valid.
+     */
+    uint64_t values[PERF_COUNTER_COUNT];
+};
+
+/**
+ * Sends performance management queries and receives their responses.
+ *
+ * A transport must not block on Send(), so that many queries can be in flight at the same time.
+ * Responses may arrive in any order and are matched to their queries by the transaction ID.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class PmaTransport {
+
+public:
+    /**
+     * Destructor.
+     */
+    virtual ~PmaTransport() = default;
+
+    /**
+     * Send a query.
+     *
+     * @param tid The transaction ID
+     * @param lid The destination LID
+     * @param portNum The port to be queried (0xff for all ports of the node)
+     * @param attribute The attribute to be queried
+     *
+     * @return true, if the query has been sent
+     */
+    virtual bool Send(uint32_t tid, uint16_t lid, uint8_t portNum, PmaAttribute attribute) = 0;
+
+    /**
+     * Wait for the next response.
+     *
+     * @param response Receives the response
+     * @param timeout Maximum time to wait in milliseconds
+     *
+     * @return true, if a response has been received; false on timeout
+     */
+    virtual bool Receive(PmaResponse &response, uint32_t timeout) = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "Recorder.h"
+
+namespace Scanner {
+
+/**
+ * The amount of pages, that are mapped at once (rounded to a multiple of the record size).
+ */
+static const uint64_t CHUNK_PAGES = 64;
+
+Recorder::DeviceListener::DeviceListener(Recorder &recorder, uint32_t deviceId) :
+        m_recorder(recorder),
+        m_deviceId(deviceId) {
+
+}
+
+void Recorder::DeviceListener::OnSample(const CounterSample &sample) {
+    m_recorder.m_batch.emplace_back();
+    Recording::Record &record = m_recorder.m_batch.back();
+
+    record.timestamp = sample.timestamp;
+    record.deviceId = m_deviceId;
+    record.flags = sample.hasDiag ? Recording::RECORD_HAS_DIAG : 0;
+
+    memcpy(record.values, sample.values, sizeof(record.values));
+}
+
+void Recorder::DeviceListener::OnSampleError(const char *message) {
+    m_recorder.m_batch.emplace_back();
+    Recording::Record &record = m_recorder.m_batch.back();
+
+    memset(&record, 0, sizeof(record));
+
+    // A timestamp of 0 marks unwritten records, so error records need a timestamp as well
+    record.timestamp = CounterSample::GetMonotonicTime();
+    record.deviceId = m_deviceId;
+    record.flags = Recording::RECORD_ERROR;
+}
+
+Recorder::Recorder(const char *path, const Topology &topology, Sampler &sampler) :
+        m_sampler(sampler),
+        m_sweep(0),
+        m_isRunning(true),
+        m_fd(-1),
+        m_recordOffset(0),
+        m_recordCount(0),
+        m_chunk(nullptr),
+        m_chunkIndex(0),
+        m_chunkRecords(0) {
+    m_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (m_fd < 0) {
+        throw std::runtime_error(std::string("Unable to create '") + path + "': " + strerror(errno));
+    }
+
+    // Chunks must start at a page boundary and contain a whole number of records
+    auto pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t a = pageSize, b = sizeof(Recording::Record);
+
+    while (b != 0) {
+        uint64_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+
+    m_chunkRecords = pageSize / a * CHUNK_PAGES;
+
+    Recording::Header header{};
+    std::vector<Recording::Device> devices(topology.GetDeviceCount());
+
+    memcpy(header.magic, Recording::MAGIC, sizeof(header.magic));
+    header.version = Recording::VERSION;
+    header.recordSize = sizeof(Recording::Record);
+    header.deviceCount = topology.GetDeviceCount();
+    header.counterCount = COUNTER_COUNT;
+    header.clockOffset = sampler.GetClockOffset();
+
+    uint64_t tableEnd = sizeof(header) + devices.size() * sizeof(Recording::Device);
+    header.recordOffset = (tableEnd + pageSize - 1) / pageSize * pageSize;
+
+    m_recordOffset = header.recordOffset;
+
+    for (uint32_t i = 0; i < topology.GetDeviceCount(); i++) {
+        const Device &device = topology.GetDevice(i);
+
+        devices[i] = Recording::Device{};
+        devices[i].guid = device.guid;
+        devices[i].nodeId = device.nodeId;
+        devices[i].lid = device.lid;
+        devices[i].portNum = device.portNum;
+        strncpy(devices[i].name, device.name.c_str(), sizeof(devices[i].name));
+    }
+
+    size_t tableSize = devices.size() * sizeof(Recording::Device);
+
+    if (pwrite(m_fd, &header, sizeof(header), 0) != sizeof(header) ||
+            pwrite(m_fd, devices.data(), tableSize, sizeof(header)) != static_cast<ssize_t>(tableSize)) {
+        close(m_fd);
+        throw std::runtime_error(std::string("Unable to write to '") + path + "': " + strerror(errno));
+    }
+
+    m_thread = std::thread(&Recorder::Run, this);
+
+    for (uint32_t i = 0; i < topology.GetDeviceCount(); i++) {
+        m_listeners.push_back(new DeviceListener(*this, i));
+        m_sampler.Subscribe(m_listeners.back(), &topology.GetDevice(i));
+    }
+
+    m_sampler.AddSweepCallback([this] { OnSweep(); });
+}
+
+Recorder::~Recorder() {
+    for (DeviceListener *listener : m_listeners) {
+        m_sampler.Unsubscribe(listener);
+        delete listener;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        m_isRunning = false;
+    }
+
+    m_condition.notify_all();
+    m_thread.join();
+
+    if (m_chunk != nullptr) {
+        munmap(m_chunk, m_chunkRecords * sizeof(Recording::Record));
+    }
+
+    // Remove the preallocated space behind the last record
+    if (ftruncate(m_fd, static_cast<off_t>(m_recordOffset + m_recordCount * sizeof(Recording::Record))) != 0) {
+        // The player ignores empty records at the end of the file
+    }
+
+    close(m_fd);
+}
+
+void Recorder::OnSweep() {
+    if (m_batch.empty()) {
+        return;
+    }
+
+    std::sort(m_batch.begin(), m_batch.end(), [](const Recording::Record &a, const Recording::Record &b) {
+        return a.deviceId < b.deviceId;
+    });
+
+    for (Recording::Record &record : m_batch) {
+        record.sweep = m_sweep;
+    }
+
+    m_sweep++;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        m_queue.insert(m_queue.end(), m_batch.begin(), m_batch.end());
+    }
+
+    m_batch.clear();
+    m_condition.notify_all();
+}
+
+void Recorder::Run() {
+    std::vector<Recording::Record> records;
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    while (m_isRunning || !m_queue.empty()) {
+        m_condition.wait(lock, [this] { return !m_isRunning || !m_queue.empty(); });
+
+        records.swap(m_queue);
+
+        // Write without holding the lock, so that the sampling thread never waits for the file
+        lock.unlock();
+
+        for (const Recording::Record &record : records) {
+            WriteRecord(record);
+        }
+
+        records.clear();
+
+        lock.lock();
+    }
+}
+
+void Recorder::WriteRecord(const Recording::Record &record) {
+    if (m_chunk == nullptr || m_recordCount / m_chunkRecords != m_chunkIndex) {
+        MapChunk(m_recordCount);
+
+        if (m_chunk == nullptr) {
+            // Out of disk space; Further records are dropped
+            return;
+        }
+    }
+
+    memcpy(m_chunk + (m_recordCount % m_chunkRecords) * sizeof(Recording::Record), &record, sizeof(record));
+
+    m_recordCount++;
+}
+
+void Recorder::MapChunk(uint64_t index) {
+    uint64_t chunkSize = m_chunkRecords * sizeof(Recording::Record);
+
+    if (m_chunk != nullptr) {
+        munmap(m_chunk, chunkSize);
+        m_chunk = nullptr;
+    }
+
+    m_chunkIndex = index / m_chunkRecords;
+
+    auto offset = static_cast<off_t>(m_recordOffset + m_chunkIndex * chunkSize);
+
+    // Allocate an entire chunk at once, so that the file only has to be resized once per chunk.
+    // Unlike ftruncate(), this fails if the disk is full, instead of raising SIGBUS when writing to the mapping.
+    if (posix_fallocate(m_fd, offset, static_cast<off_t>(chunkSize)) != 0) {
+        return;
+    }
+
+    void *chunk = mmap(nullptr, chunkSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, offset);
+
+    if (chunk != MAP_FAILED) {
+        m_chunk = static_cast<uint8_t*>(chunk);
+    }
+}
+
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_RECORDER_H
+#define IBSCANNER_RECORDER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Recording.h"
+#include "Sampler.h"
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * Records the samples of all devices of a topology into a binary file, which can be replayed by a Player.
+ *
+ * The recorder subscribes every device to the sampler. The sampling thread only copies the samples of a sweep into
+ * a batch, which is handed over to the recorder's own thread. That thread appends the records to the file via a
+ * memory mapping, that is extended chunk by chunk.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class Recorder {
+
+public:
+    /**
+     * Constructor.
+     *
+     * Creates the file and writes the header and the device table.
+     * Throws std::runtime_error, if the file cannot be created.
+     *
+     * @param path The file's path
+     * @param topology The devices to record
+     * @param sampler The sampler, that the devices are subscribed to; Must not have been started yet
+     */
+    Recorder(const char *path, const Topology &topology, Sampler &sampler);
+
+    /**
+     * Destructor.
+     *
+     * Unsubscribes all devices, writes the remaining records and truncates the file to its actual size.
+     * The sampler must have been stopped before, because it keeps calling the recorder after each sweep.
+     */
+    ~Recorder();
+
+    Recorder(const Recorder &copy) = delete;
+
+    Recorder& operator=(const Recorder &other) = delete;
+
+private:
+    /**
+     * Receives the samples of a single device.
+     */
+    class DeviceListener : public Sampler::Listener {
+
+    public:
+        DeviceListener(Recorder &recorder, uint32_t deviceId);
+
+        void OnSample(const CounterSample &sample) override;
+
+        void OnSampleError(const char *message) override;
+
+    private:
+
+        Recorder &m_recorder;
+        uint32_t m_deviceId;
+    };
+
+    /**
+     * Called by the sampler after each sweep.
+     */
+    void OnSweep();
+
+    /**
+     * The writing thread.
+     */
+    void Run();
+
+    /**
+     * Write a record to the file.
+     */
+    void WriteRecord(const Recording::Record &record);
+
+    /**
+     * Map the chunk of the file, that contains a given record.
+     */
+    void MapChunk(uint64_t index);
+
+private:
+
+    Sampler &m_sampler;
+
+    std::vector<DeviceListener*> m_listeners;
+
+    /**
+     * The records of the current sweep (only accessed by the sampling thread).
+     */
+    std::vector<Recording::Record> m_batch;
+    uint64_t m_sweep;
+
+    /**
+     * Records, that have been handed over to the writing thread.
+     */
+    std::vector<Recording::Record> m_queue;
+
+    std::mutex m_lock;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+    bool m_isRunning;
+
+    int m_fd;
+    uint64_t m_recordOffset;
+    uint64_t m_recordCount;
+
+    uint8_t *m_chunk;
+    uint64_t m_chunkIndex;
+    uint64_t m_chunkRecords;
+};
+
+}
+
+#endif
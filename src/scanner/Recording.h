@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_RECORDING_H
+#define IBSCANNER_RECORDING_H
+
+#include <cstdint>
+#include "CounterSample.h"
+
+namespace Scanner {
+
+/**
+ * The binary format of recordings, which are written by Recorder and read by Player.
+ *
+ * A recording consists of a header, the table of recorded devices and the records. The records start at a page
+ * aligned offset and have a fixed size, so that any record can be located without parsing the file. Records are
+ * appended sweep by sweep; inside a sweep they are sorted by device id.
+ *
+ * All values are stored in the byte order of the recording machine.
+ */
+namespace Recording {
+
+static const char MAGIC[8] = { 'I', 'B', 'S', 'C', 'R', 'E', 'C', '\0' };
+
+static const uint32_t VERSION = 1;
+
+/**
+ * Flags of a record.
+ */
+enum RecordFlags : uint32_t {
+    RECORD_ERROR = 1,
+    RECORD_HAS_DIAG = 2
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t deviceCount;
+    uint32_t counterCount;
+
+    /**
+     * The offset of the first record in bytes.
+     */
+    uint64_t recordOffset;
+
+    /**
+     * Difference between CLOCK_REALTIME and CLOCK_MONOTONIC in nanoseconds at the start of the recording.
+     */
+    int64_t clockOffset;
+};
+
+struct Device {
+    uint64_t guid;
+    uint32_t nodeId;
+    uint16_t lid;
+    uint8_t portNum;
+    uint8_t reserved;
+    char name[64];
+};
+
+struct Record {
+    /**
+     * CLOCK_MONOTONIC in nanoseconds (0 for records, that have not been written yet).
+     */
+    uint64_t timestamp;
+    uint64_t sweep;
+    uint32_t deviceId;
+    uint32_t flags;
+    uint64_t values[COUNTER_COUNT];
+};
+
+}
+
+}
+
+#endif
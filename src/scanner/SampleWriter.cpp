@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cstring>
+#include "SampleWriter.h"
+
+namespace Scanner {
+
+const CounterId SampleWriter::RATE_COUNTERS[4] = { XMIT_DATA_BYTES, RCV_DATA_BYTES, XMIT_PKTS, RCV_PKTS };
+
+/**
+ * An upper bound for the size of a sample without the description, in bytes.
+ */
+static const size_t MAX_SAMPLE_SIZE = 4096;
+
+SampleWriter::SampleWriter(FILE *file, Format format, size_t bufferSize) :
+        m_file(file),
+        m_format(format),
+        m_buffer(bufferSize > MAX_SAMPLE_SIZE ? bufferSize : MAX_SAMPLE_SIZE),
+        m_length(0),
+        m_failed(false) {
+
+}
+
+SampleWriter::~SampleWriter() {
+    Flush();
+}
+
+void SampleWriter::WriteHeader() {
+    if (m_format != CSV) {
+        return;
+    }
+
+    Reserve(MAX_SAMPLE_SIZE);
+
+    Append("time,description,guid,lid,port");
+
+    for (uint8_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+        Append(',');
+        Append(CounterSample::GetCounterName(static_cast<CounterId>(i)));
+    }
+
+    for (CounterId id : RATE_COUNTERS) {
+        Append(',');
+        Append(CounterSample::GetCounterName(id));
+        Append("_per_sec");
+    }
+
+    Append(",error\n");
+}
+
+void SampleWriter::WriteSample(uint64_t time, const char *description, uint64_t guid, uint16_t lid,
+                               uint8_t portNum, const CounterSample &sample, const uint64_t *rates) {
+    Reserve(MAX_SAMPLE_SIZE + 2 * strlen(description));
+
+    AppendDevice(time, description, guid, lid, portNum);
+
+    if (m_format == CSV) {
+        for (uint8_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+            Append(',');
+            AppendUnsigned(sample.values[i]);
+        }
+
+        for (uint8_t i = 0; i < sizeof(RATE_COUNTERS) / sizeof(RATE_COUNTERS[0]); i++) {
+            Append(',');
+            AppendUnsigned(rates[i]);
+        }
+
+        Append(",\n");
+    } else {
+        Append(",\"counters\":{");
+
+        for (uint8_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+            if (i > 0) {
+                Append(',');
+            }
+
+            Append('"');
+            Append(CounterSample::GetCounterName(static_cast<CounterId>(i)));
+            Append("\":");
+            AppendUnsigned(sample.values[i]);
+        }
+
+        Append("},\"rates\":{");
+
+        for (uint8_t i = 0; i < sizeof(RATE_COUNTERS) / sizeof(RATE_COUNTERS[0]); i++) {
+            if (i > 0) {
+                Append(',');
+            }
+
+            Append('"');
+            Append(CounterSample::GetCounterName(RATE_COUNTERS[i]));
+            Append("\":");
+            AppendUnsigned(rates[i]);
+        }
+
+        Append("}}\n");
+    }
+}
+
+void SampleWriter::WriteError(uint64_t time, const char *description, uint64_t guid, uint16_t lid,
+                              uint8_t portNum, const char *message) {
+    Reserve(MAX_SAMPLE_SIZE + 2 * strlen(description) + 2 * strlen(message));
+
+    AppendDevice(time, description, guid, lid, portNum);
+
+    if (m_format == CSV) {
+        // Leave all counter columns empty
+        for (uint8_t i = 0; i < PERF_COUNTER_COUNT + sizeof(RATE_COUNTERS) / sizeof(RATE_COUNTERS[0]); i++) {
+            Append(',');
+        }
+
+        Append(',');
+        AppendQuoted(message);
+        Append('\n');
+    } else {
+        Append(",\"error\":");
+        AppendQuoted(message);
+        Append("}\n");
+    }
+}
+
+bool SampleWriter::Flush() {
+    if (m_length > 0 && !m_failed) {
+        m_failed = fwrite(m_buffer.data(), 1, m_length, m_file) != m_length || fflush(m_file) != 0;
+    }
+
+    m_length = 0;
+
+    return !m_failed;
+}
+
+void SampleWriter::AppendDevice(uint64_t time, const char *description, uint64_t guid, uint16_t lid,
+                                uint8_t portNum) {
+    if (m_format == CSV) {
+        AppendTime(time);
+        Append(',');
+        AppendQuoted(description);
+        Append(',');
+        AppendHex(guid);
+        Append(',');
+        AppendUnsigned(lid);
+        Append(',');
+        AppendUnsigned(portNum);
+    } else {
+        Append("{\"time\":");
+        AppendTime(time);
+        Append(",\"description\":");
+        AppendQuoted(description);
+        Append(",\"guid\":\"");
+        AppendHex(guid);
+        Append("\",\"lid\":");
+        AppendUnsigned(lid);
+        Append(",\"port\":");
+        AppendUnsigned(portNum);
+    }
+}
+
+void SampleWriter::Reserve(size_t size) {
+    if (m_length + size <= m_buffer.size()) {
+        return;
+    }
+
+    Flush();
+
+    if (size > m_buffer.size()) {
+        m_buffer.resize(size);
+    }
+}
+
+void SampleWriter::Append(const char *string) {
+    size_t length = strlen(string);
+
+    memcpy(&m_buffer[m_length], string, length);
+    m_length += length;
+}
+
+void SampleWriter::AppendQuoted(const char *string) {
+    Append('"');
+
+    for (const char *c = string; *c != '\0'; c++) {
+        if (*c == '"') {
+            // CSV escapes quotes by doubling them, JSON uses a backslash
+            Append(m_format == CSV ? '"' : '\\');
+            Append('"');
+        } else if (*c == '\\' && m_format == JSON) {
+            Append('\\');
+            Append('\\');
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            // Control characters are not allowed inside a single line
+            Append(' ');
+        } else {
+            Append(*c);
+        }
+    }
+
+    Append('"');
+}
+
+void SampleWriter::AppendUnsigned(uint64_t value) {
+    char digits[20];
+    uint8_t count = 0;
+
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (count > 0) {
+        Append(digits[--count]);
+    }
+}
+
+void SampleWriter::AppendHex(uint64_t value) {
+    static const char hexDigits[] = "0123456789abcdef";
+
+    Append("0x");
+
+    for (int8_t shift = 60; shift >= 0; shift -= 4) {
+        Append(hexDigits[(value >> shift) & 0xf]);
+    }
+}
+
+void SampleWriter::AppendTime(uint64_t time) {
+    uint64_t fraction = time % 1000000;
+
+    AppendUnsigned(time / 1000000);
+    Append('.');
+
+    for (uint32_t divisor = 100000; divisor > 0; divisor /= 10) {
+        Append(static_cast<char>('0' + (fraction / divisor) % 10));
+    }
+}
+
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef IBSCANNER_SAMPLEWRITER_H
+#define IBSCANNER_SAMPLEWRITER_H
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include "CounterSample.h"
+
+namespace Scanner {
+
+/**
+ * Writes samples as CSV or JSON lines to a file.
+ *
+ * All output is collected in a large buffer, which is only written to the file if it is full or if Flush() is called
+ * (usually once per sweep). Numbers are formatted by hand, so that writing a sample does not involve printf().
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class SampleWriter {
+
+public:
+
+    enum Format {
+        CSV,
+        JSON
+    };
+
+    /**
+     * The counters, for which a rate per second is written in addition to the raw value.
+     */
+    static const CounterId RATE_COUNTERS[4];
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param file The file to write to (e.g. stdout); Is not closed by the writer
+     * @param format The output format
+     * @param bufferSize The size of the output buffer in bytes
+     */
+    SampleWriter(FILE *file, Format format, size_t bufferSize = 1 << 20);
+
+    /**
+     * Destructor.
+     *
+     * Flushes all buffered output.
+     */
+    ~SampleWriter();
+
+    /**
+     * Write the CSV header line (does nothing in JSON mode).
+     */
+    void WriteHeader();
+
+    /**
+     * Write a single sample.
+     *
+     * @param time The wall clock time of the sample in microseconds since the epoch
+     * @param description The node's description
+     * @param guid The node's GUID
+     * @param lid The port's LID
+     * @param portNum The port number (0xff for the entire node)
+     * @param sample The sample
+     * @param rates The rates per second of the RATE_COUNTERS
+     */
+    void WriteSample(uint64_t time, const char *description, uint64_t guid, uint16_t lid, uint8_t portNum,
+                     const CounterSample &sample, const uint64_t *rates);
+
+    /**
+     * Write an error, that occurred while sampling a device.
+     *
+     * @param time The wall clock time in microseconds since the epoch
+     * @param description The node's description
+     * @param guid The node's GUID
+     * @param lid The port's LID
+     * @param portNum The port number (0xff for the entire node)
+     * @param message The error message
+     */
+    void WriteError(uint64_t time, const char *description, uint64_t guid, uint16_t lid, uint8_t portNum,
+                    const char *message);
+
+    /**
+     * Write all buffered output to the file.
+     *
+     * @return false, if writing to the file failed (e.g. because the reading end of a pipe has been closed)
+     */
+    bool Flush();
+
+private:
+    /**
+     * Write the columns/fields, that identify a device.
+     */
+    void AppendDevice(uint64_t time, const char *description, uint64_t guid, uint16_t lid, uint8_t portNum);
+
+    /**
+     * Make sure, that the buffer can hold at least the given amount of bytes.
+     */
+    void Reserve(size_t size);
+
+    void Append(char c) {
+        m_buffer[m_length++] = c;
+    }
+
+    void Append(const char *string);
+
+    /**
+     * Append a string as quoted CSV field or JSON string.
+     */
+    void AppendQuoted(const char *string);
+
+    void AppendUnsigned(uint64_t value);
+
+    void AppendHex(uint64_t value);
+
+    /**
+     * Append a time in microseconds as seconds with six decimal places.
+     */
+    void AppendTime(uint64_t time);
+
+private:
+
+    FILE *m_file;
+    Format m_format;
+
+    std::vector<char> m_buffer;
+    size_t m_length;
+
+    bool m_failed;
+};
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "SampledWindow.h"
+
+namespace Scanner {
+
+SampledWindow::SampledWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, const char *title,
+                             Sampler &sampler) :
+        Window(posX, posY, width, height, title),
+        m_sampler(sampler),
+        m_isActive(false) {
+
+}
+
+void SampledWindow::SetActive(bool active) {
+    if (active == m_isActive) {
+        return;
+    }
+
+    if (active) {
+        // The ports have not been sampled while the window was inactive, so old values must not be used for rates
+        ResetRates();
+
+        ForEachListener([this](Sampler::Listener *listener, const Device *port) {
+            m_sampler.Subscribe(listener, port);
+        });
+
+        m_isActive = true;
+
+        m_sampler.RequestSample();
+    } else {
+        m_isActive = false;
+
+        ForEachListener([this](Sampler::Listener *listener, const Device *port) {
+            m_sampler.Unsubscribe(listener);
+        });
+    }
+
+    Invalidate();
+}
+
+void SampledWindow::ScrollTo(uint32_t row, uint32_t &firstRow, uint32_t rowCount) {
+    if (row < firstRow) {
+        firstRow = row;
+    } else if (row >= firstRow + rowCount) {
+        firstRow = row - rowCount + 1;
+    }
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef IBSCANNER_SAMPLEDWINDOW_H
+#define IBSCANNER_SAMPLEDWINDOW_H
+
+#include <atomic>
+#include <functional>
+#include <curses/Window.h>
+#include "Sampler.h"
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * Base class of windows, which show the rates of many ports at once (e.g. TopWindow and DashboardWindow).
+ *
+ * The ports are only subscribed to the sampler, while the window is active, so that an inactive window does not
+ * slow down the sweeps. The sampling thread publishes the rates as immutable snapshots, which are dropped on
+ * activation, because rates must not be calculated across the gap in sampling.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class SampledWindow : public Curses::Window {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param posX X-coordinate of upper left corner
+     * @param posY Y-coordinate of upper left corner
+     * @param width The width
+     * @param height The height
+     * @param title The title
+     * @param sampler The sampler, which refreshes the counters
+     */
+    SampledWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, const char *title,
+                  Sampler &sampler);
+
+    /**
+     * Destructor.
+     *
+     * Derived classes must deactivate the window in their destructor, because their listeners are gone afterwards.
+     */
+    ~SampledWindow() override = default;
+
+    /**
+     * Activate/deactivate the window.
+     *
+     * Only an active window subscribes its ports to the sampler.
+     *
+     * @param active true, to activate the window
+     */
+    void SetActive(bool active);
+
+    bool IsActive() const {
+        return m_isActive;
+    }
+
+protected:
+    /**
+     * Forget the previous values of all ports and drop the published snapshot (called, before the window is
+     * activated).
+     */
+    virtual void ResetRates() = 0;
+
+    /**
+     * Call a function with the listener of every port, that is shown by the window.
+     *
+     * @param function The function, which receives the listener and its port
+     */
+    virtual void ForEachListener(const std::function<void(Sampler::Listener*, const Device*)> &function) = 0;
+
+    /**
+     * Scroll as little as possible, so that a row becomes visible.
+     *
+     * @param row The row, that shall be visible
+     * @param firstRow The first visible row, which is adjusted
+     * @param rowCount The amount of visible rows
+     */
+    static void ScrollTo(uint32_t row, uint32_t &firstRow, uint32_t rowCount);
+
+protected:
+
+    Sampler &m_sampler;
+
+    std::atomic<bool> m_isActive;
+};
+
+}
+
+#endif
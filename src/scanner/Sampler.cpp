@@ -0,0 +1,411 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include <ctime>
+#include <detector/exception/IbPerfException.h>
+#include "Player.h"
+#include "Sampler.h"
+
+namespace Scanner {
+
+static uint64_t getNanoseconds(std::chrono::steady_clock::duration duration) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+Sampler::Sampler(uint32_t refreshInterval) :
+        m_queryEngine(nullptr),
+        m_player(nullptr),
+        m_instrumentation(nullptr),
+        m_refreshInterval(refreshInterval > 0 ? refreshInterval : 1),
+        m_clockOffset(0),
+        m_isRunning(false),
+        m_isPaused(false),
+        m_isSweeping(false),
+        m_sampleRequested(false) {
+    timespec realTime{};
+    clock_gettime(CLOCK_REALTIME, &realTime);
+
+    m_clockOffset = static_cast<int64_t>(realTime.tv_sec) * 1000000000 + realTime.tv_nsec -
+                    static_cast<int64_t>(CounterSample::GetMonotonicTime());
+}
+
+Sampler::~Sampler() {
+    Stop();
+}
+
+void Sampler::Start() {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    if (m_isRunning) {
+        return;
+    }
+
+    m_isRunning = true;
+    m_thread = std::thread(&Sampler::Run, this);
+}
+
+void Sampler::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        m_isRunning = false;
+    }
+
+    m_condition.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void Sampler::Pause() {
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    m_isPaused = true;
+
+    m_condition.wait(lock, [this] { return !m_isSweeping; });
+}
+
+void Sampler::Resume() {
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        m_isPaused = false;
+        m_sampleRequested = true;
+    }
+
+    m_condition.notify_all();
+}
+
+void Sampler::Subscribe(Listener *listener, const Device *device) {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    auto index = m_subscriptionIndex.find(listener);
+
+    if (index != m_subscriptionIndex.end()) {
+        m_subscriptions[index->second].device = device;
+
+        return;
+    }
+
+    m_subscriptionIndex[listener] = m_subscriptions.size();
+    m_subscriptions.push_back(Subscription{listener, device});
+}
+
+void Sampler::Unsubscribe(Listener *listener) {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    auto index = m_subscriptionIndex.find(listener);
+
+    if (index == m_subscriptionIndex.end()) {
+        return;
+    }
+
+    // The order of the subscriptions does not matter, so the last one is moved into the gap
+    size_t position = index->second;
+    m_subscriptionIndex.erase(index);
+
+    if (position != m_subscriptions.size() - 1) {
+        m_subscriptions[position] = m_subscriptions.back();
+        m_subscriptionIndex[m_subscriptions[position].listener] = position;
+    }
+
+    m_subscriptions.pop_back();
+}
+
+void Sampler::ResetCounter(const Device *device) {
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        if (std::find(m_pendingResets.begin(), m_pendingResets.end(), device) == m_pendingResets.end()) {
+            m_pendingResets.push_back(device);
+        }
+
+        m_sampleRequested = true;
+    }
+
+    m_condition.notify_all();
+}
+
+void Sampler::RequestSample() {
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        m_sampleRequested = true;
+    }
+
+    m_condition.notify_all();
+}
+
+void Sampler::SetPlayer(Player *player) {
+    m_player = player;
+
+    if (m_player != nullptr) {
+        m_clockOffset = m_player->GetClockOffset();
+    }
+}
+
+void Sampler::SetInstrumentation(Instrumentation *instrumentation) {
+    m_instrumentation = instrumentation;
+
+    if (m_queryEngine != nullptr) {
+        m_queryEngine->SetRoundTripHistogram(instrumentation != nullptr ? &instrumentation->queryRoundTrip : nullptr);
+    }
+}
+
+void Sampler::SetRefreshInterval(uint32_t refreshInterval) {
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        m_refreshInterval = refreshInterval > 0 ? refreshInterval : 1;
+    }
+
+    m_condition.notify_all();
+}
+
+void Sampler::Run() {
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    std::vector<Result> results;
+    std::vector<const Device*> resets;
+
+    std::chrono::steady_clock::time_point lastSweepStart;
+    bool hasLastSweep = false;
+
+    while (m_isRunning) {
+        // The time spent paused does not count as a sweep interval
+        if (m_isPaused) {
+            hasLastSweep = false;
+        }
+
+        m_condition.wait(lock, [this] { return !m_isRunning || !m_isPaused; });
+
+        if (!m_isRunning) {
+            break;
+        }
+
+        m_isSweeping = true;
+
+        auto sweepStart = std::chrono::steady_clock::now();
+        uint32_t refreshInterval = m_refreshInterval;
+        auto nextSweep = sweepStart + std::chrono::milliseconds(refreshInterval);
+
+        if (m_instrumentation != nullptr && hasLastSweep) {
+            m_instrumentation->sweepInterval.Record(getNanoseconds(sweepStart - lastSweepStart));
+        }
+
+        lastSweepStart = sweepStart;
+        hasLastSweep = true;
+
+        m_sampleRequested = false;
+
+        // Collect every device exactly once, no matter how many listeners are subscribed to it
+        results.clear();
+        m_resultIndex.clear();
+
+        for (const Subscription &subscription : m_subscriptions) {
+            if (m_resultIndex.emplace(subscription.device, results.size()).second) {
+                results.push_back(Result{subscription.device, CounterSample{}, ""});
+            }
+        }
+
+        resets.clear();
+        resets.swap(m_pendingResets);
+
+        // Query the fabric without holding the lock, so that subscribing/unsubscribing never blocks on I/O
+        lock.unlock();
+
+        if (m_player != nullptr) {
+            // Recorded counters cannot be reset
+            ReadResults(results);
+
+            nextSweep = m_player->GetNextSweepTime();
+        } else {
+            for (const Device *device : resets) {
+                if (device->perfCounter == nullptr) {
+                    continue;
+                }
+
+                try {
+                    device->perfCounter->ResetCounters();
+                } catch (const Detector::IbPerfException &exception) {
+                    // The error will show up on the next refresh of this counter
+                }
+            }
+
+            RefreshResults(results);
+        }
+
+        lock.lock();
+
+        // Subscriptions may have changed in the meantime, so only notify listeners, that are still subscribed
+        for (const Subscription &subscription : m_subscriptions) {
+            auto index = m_resultIndex.find(subscription.device);
+
+            if (index == m_resultIndex.end()) {
+                continue;
+            }
+
+            const Result *result = &results[index->second];
+
+            if (result->error.empty()) {
+                subscription.listener->OnSample(result->sample);
+            } else {
+                subscription.listener->OnSampleError(result->error.c_str());
+            }
+        }
+
+        for (const std::function<void()> &sweepCallback : m_sweepCallbacks) {
+            sweepCallback();
+        }
+
+        if (m_instrumentation != nullptr) {
+            uint64_t errorCount = 0;
+
+            for (const Result &result : results) {
+                errorCount += result.error.empty() ? 0 : 1;
+            }
+
+            m_instrumentation->errorCount.fetch_add(errorCount, std::memory_order_relaxed);
+            m_instrumentation->sweepDuration.Record(getNanoseconds(std::chrono::steady_clock::now() - sweepStart));
+        }
+
+        // Wake up a thread, that is waiting in Pause()
+        m_isSweeping = false;
+        m_condition.notify_all();
+
+        // If a sweep takes longer than the interval, the next one is started immediately
+        m_condition.wait_until(lock, nextSweep, [&] {
+            return !m_isRunning || m_isPaused || m_sampleRequested || m_refreshInterval != refreshInterval;
+        });
+    }
+}
+
+template<typename Counter>
+void Sampler::RefreshCounter(Counter &counter) {
+    if (m_instrumentation == nullptr) {
+        counter.RefreshCounters();
+
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    m_instrumentation->queryCount.fetch_add(1, std::memory_order_relaxed);
+
+    // The round trip time is recorded even if the refresh fails, because a failing refresh may take just as long
+    try {
+        counter.RefreshCounters();
+    } catch (...) {
+        m_instrumentation->queryRoundTrip.Record(getNanoseconds(std::chrono::steady_clock::now() - start));
+
+        throw;
+    }
+
+    m_instrumentation->queryRoundTrip.Record(getNanoseconds(std::chrono::steady_clock::now() - start));
+}
+
+void Sampler::RefreshResults(std::vector<Result> &results) {
+    m_queries.clear();
+    m_queryResults.clear();
+
+    for (size_t i = 0; i < results.size(); i++) {
+        Result &result = results[i];
+        PmaQueryEngine::Query query{};
+
+        if (!result.device->isPresent) {
+            result.error = "The device has been removed from the fabric!";
+            continue;
+        }
+
+        // Nodes are queried via their first port's LID and the AllPortSelect port number (0xff)
+        if (m_queryEngine != nullptr && result.device->lid != 0) {
+            query.lid = result.device->lid;
+            query.portNum = result.device->portNum;
+
+            m_queries.push_back(query);
+            m_queryResults.push_back(i);
+
+            continue;
+        }
+
+        if (result.device->perfCounter == nullptr) {
+            result.error = "The device's counters are not available!";
+            continue;
+        }
+
+        try {
+            RefreshCounter(*result.device->perfCounter);
+            result.sample.ReadPerfCounter(*result.device->perfCounter);
+        } catch (const Detector::IbPerfException &exception) {
+            result.error = exception.what();
+        }
+    }
+
+    // Query all ports at once, so that the round trip times overlap
+    if (!m_queries.empty()) {
+        uint64_t timeoutCount = m_queryEngine->GetTimeoutCount();
+
+        m_queryEngine->Execute(m_queries.data(), m_queries.size());
+
+        if (m_instrumentation != nullptr) {
+            m_instrumentation->queryCount.fetch_add(m_queries.size(), std::memory_order_relaxed);
+            m_instrumentation->timeoutCount.fetch_add(m_queryEngine->GetTimeoutCount() - timeoutCount,
+                                                      std::memory_order_relaxed);
+        }
+
+        for (size_t i = 0; i < m_queries.size(); i++) {
+            Result &result = results[m_queryResults[i]];
+
+            result.sample = m_queries[i].sample;
+
+            if (m_queries[i].error != nullptr) {
+                result.error = m_queries[i].error;
+            }
+        }
+    }
+
+    // Diagnostic counters are read locally and are not available via the performance management agent
+    for (Result &result : results) {
+        if (result.device->diagPerfCounter == nullptr || !result.error.empty()) {
+            continue;
+        }
+
+        try {
+            RefreshCounter(*result.device->diagPerfCounter);
+            result.sample.ReadDiagPerfCounter(*result.device->diagPerfCounter);
+        } catch (const Detector::IbPerfException &exception) {
+            result.error = exception.what();
+        }
+    }
+}
+
+void Sampler::ReadResults(std::vector<Result> &results) {
+    m_player->Synchronize();
+
+    for (Result &result : results) {
+        const char *error = m_player->Read(result.device->id, result.sample);
+
+        if (error != nullptr) {
+            result.error = error;
+        }
+    }
+}
+
+}
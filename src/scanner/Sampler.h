@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef IBSCANNER_SAMPLER_H
+#define IBSCANNER_SAMPLER_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include "CounterSample.h"
+#include "Instrumentation.h"
+#include "PmaQueryEngine.h"
+#include "Topology.h"
+
+namespace Scanner {
+
+class Player;
+
+/**
+ * Refreshes the performance counters of all subscribed devices in a single thread.
+ *
+ * Each counter is queried at most once per interval, no matter how many listeners are subscribed to it.
+ * Sweeps are started at a fixed rate, so the time needed for querying does not add up to the interval.
+ * Counters without any subscribed listener are not queried at all.
+ * Subscriptions and results are indexed by hash tables, so that the overhead per sweep grows linearly with the
+ * amount of subscriptions, even when every port of a large fabric is subscribed.
+ *
+ * If a PmaQueryEngine is set, the counters of all subscribed ports are queried in one pipelined sweep.
+ * Otherwise (e.g. in compatibility mode), each counter is refreshed via Detector one after another.
+ * If a Player is set, the samples are read from a recording instead and sweeps follow the recording's timing.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class Sampler {
+
+public:
+    /**
+     * Gets notified by the sampler, after the counters it is subscribed to have been refreshed.
+     *
+     * The callbacks are executed in the sampler's thread.
+     */
+    class Listener {
+
+    public:
+        /**
+         * Destructor.
+         */
+        virtual ~Listener() = default;
+
+        /**
+         * Called after the counters have been refreshed successfully.
+         *
+         * @param sample The refreshed counters
+         */
+        virtual void OnSample(const CounterSample &sample) = 0;
+
+        /**
+         * Called if an error occurred while refreshing the counters.
+         *
+         * @param message The error message
+         */
+        virtual void OnSampleError(const char *message) = 0;
+    };
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param refreshInterval The interval in milliseconds, in which the counters shall be refreshed
+     */
+    explicit Sampler(uint32_t refreshInterval = 2000);
+
+    /**
+     * Destructor.
+     */
+    ~Sampler();
+
+    /**
+     * Start the sampling thread.
+     */
+    void Start();
+
+    /**
+     * Stop the sampling thread and wait for it to finish.
+     */
+    void Stop();
+
+    /**
+     * Wait for the current sweep to finish and hold back further sweeps until Resume() is called.
+     *
+     * While the sampler is paused, the devices of the topology may be changed (e.g. after a rescan).
+     */
+    void Pause();
+
+    /**
+     * Continue sampling after Pause() and start the next sweep immediately.
+     */
+    void Resume();
+
+    /**
+     * Subscribe a listener to the counters of a device.
+     *
+     * An existing subscription of the same listener is replaced.
+     *
+     * @param listener The listener
+     * @param device The device
+     */
+    void Subscribe(Listener *listener, const Device *device);
+
+    /**
+     * Remove a listener's subscription.
+     *
+     * After this function returns, the listener will not be called anymore.
+     *
+     * @param listener The listener
+     */
+    void Unsubscribe(Listener *listener);
+
+    /**
+     * Reset the counters of a device.
+     *
+     * The reset is performed by the sampling thread before the next refresh, which is triggered immediately.
+     *
+     * @param device The device
+     */
+    void ResetCounter(const Device *device);
+
+    /**
+     * Set the query engine, which is used to query the performance management agents.
+     *
+     * Must be called before Start().
+     *
+     * @param queryEngine The query engine (nullptr to refresh all counters via Detector)
+     */
+    void SetQueryEngine(PmaQueryEngine *queryEngine) {
+        m_queryEngine = queryEngine;
+    }
+
+    /**
+     * Set the instrumentation, which receives the round trip times of all queries and the timing of every sweep.
+     *
+     * Must be called before Start() and after SetQueryEngine().
+     *
+     * @param instrumentation The instrumentation (nullptr to disable the measurements)
+     */
+    void SetInstrumentation(Instrumentation *instrumentation);
+
+    /**
+     * Set the player, from which the samples are read instead of querying the fabric.
+     *
+     * Must be called before Start().
+     *
+     * @param player The player (nullptr to sample the fabric)
+     */
+    void SetPlayer(Player *player);
+
+    /**
+     * Add a function, that is called after each sweep, once all listeners have been notified.
+     *
+     * The function is executed in the sampler's thread. Must be called before Start().
+     *
+     * @param sweepCallback The function
+     */
+    void AddSweepCallback(const std::function<void()> &sweepCallback) {
+        m_sweepCallbacks.push_back(sweepCallback);
+    }
+
+    /**
+     * Advise the sampling thread to refresh all subscribed counters as soon as possible.
+     */
+    void RequestSample();
+
+    /**
+     * Get the refresh interval in milliseconds.
+     */
+    uint32_t GetRefreshInterval() const {
+        return m_refreshInterval;
+    }
+
+    /**
+     * Set the refresh interval.
+     *
+     * The next sweep is scheduled according to the new interval immediately.
+     *
+     * @param refreshInterval The interval in milliseconds (at least 1)
+     */
+    void SetRefreshInterval(uint32_t refreshInterval);
+
+    /**
+     * Get the difference between CLOCK_REALTIME and CLOCK_MONOTONIC in nanoseconds, which converts the timestamps
+     * of the delivered samples to wall clock time.
+     */
+    int64_t GetClockOffset() const {
+        return m_clockOffset;
+    }
+
+private:
+
+    struct Subscription {
+        Listener *listener;
+        const Device *device;
+    };
+
+    struct Result {
+        const Device *device;
+        CounterSample sample;
+        std::string error;
+    };
+
+    /**
+     * The sampling thread.
+     */
+    void Run();
+
+    /**
+     * Refresh the counters of all results.
+     *
+     * @param results The results
+     */
+    void RefreshResults(std::vector<Result> &results);
+
+    /**
+     * Read the results from the player's current sweep.
+     *
+     * @param results The results
+     */
+    void ReadResults(std::vector<Result> &results);
+
+    /**
+     * Refresh a counter via Detector and record the time needed as the query's round trip time.
+     *
+     * @param counter The counter
+     */
+    template<typename Counter>
+    void RefreshCounter(Counter &counter);
+
+private:
+
+    std::vector<Subscription> m_subscriptions;
+    std::unordered_map<Listener*, size_t> m_subscriptionIndex;
+    std::vector<const Device*> m_pendingResets;
+
+    PmaQueryEngine *m_queryEngine;
+    Player *m_player;
+    Instrumentation *m_instrumentation;
+    std::vector<std::function<void()>> m_sweepCallbacks;
+    std::vector<PmaQueryEngine::Query> m_queries;
+    std::vector<size_t> m_queryResults;
+
+    /**
+     * The index of each device's result in the current sweep (only accessed by the sampling thread).
+     */
+    std::unordered_map<const Device*, size_t> m_resultIndex;
+
+    std::mutex m_lock;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+
+    std::atomic<uint32_t> m_refreshInterval;
+    std::atomic<int64_t> m_clockOffset;
+
+    bool m_isRunning;
+    bool m_isPaused;
+    bool m_isSweeping;
+    bool m_sampleRequested;
+};
+
+}
+
+#endif
@@ -16,33 +16,73 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
 #include <ncurses.h>
 #include <detector/BuildConfig.h>
 #include <detector/exception/IbMadException.h>
 #include <detector/exception/IbFileException.h>
-#include <curses/YesNoMessageWindow.h>
 #include <verbs.h>
 #include <mad.h>
 #include "curses/WindowManager.h"
 #include "curses/OkMessageWindow.h"
 #include "BuildConfig.h"
 #include "MonitorWindow.h"
+#include "HeadlessScanner.h"
 #include "Scanner.h"
 
 namespace Scanner {
 
-Scanner::Scanner(bool network, bool compatibility) :
-        m_diagPerfCounterMap(std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*>()),
+/**
+ * The refresh intervals in milliseconds, that can be chosen at runtime.
+ */
+static const uint32_t refreshIntervals[] = { 50, 100, 250, 500, 1000, 2000, 5000, 10000 };
+
+static const char *compatibilityQuestion = "An error occurred, while scanning the fabric.\n"
+                                           "You probably don't have root privileges.\n"
+                                           "Do you want to continue in compatibility mode?\n"
+                                           "You will only be able to scan local devices,\n"
+                                           "but don't need root prvilieges.";
+
+Scanner::Scanner(bool network, bool compatibility, uint32_t maxOutstanding, uint32_t refreshInterval,
+                 const char *recordPath, const char *replayPath, uint32_t rescanInterval, bool freshScan,
+                 const char *alertRulesPath, const char *alertLogPath, SimulatedFabric *simulation,
+                 uint32_t maxFrameRate) :
         m_fabric(nullptr),
+        m_searchIndex(m_topology),
         m_manager(Curses::WindowManager::GetInstance()),
+        m_sampler(refreshInterval),
+        m_pmaConnection(nullptr),
+        m_simulation(simulation),
+        m_recorder(nullptr),
+        m_player(nullptr),
+        m_recordPath(recordPath != nullptr ? recordPath : ""),
+        m_replayPath(replayPath != nullptr ? replayPath : ""),
+        m_alertRulesPath(alertRulesPath != nullptr ? alertRulesPath : ""),
+        m_alertLogPath(alertLogPath != nullptr ? alertLogPath : ""),
         m_helpWindow(nullptr),
+        m_compatibilityWindow(nullptr),
         m_menuWindow(nullptr),
+        m_monitorWindow{},
+        m_windowCount(1),
+        m_dashboardWindow(nullptr),
+        m_topWindow(nullptr),
+        m_alertWindow(nullptr),
+        m_isAlertWindowShown(false),
+        m_alertMonitor(nullptr),
+        m_statsWindow(nullptr),
+        m_isStatsWindowShown(false),
         m_oldStderr(dup(2)),
         m_network(network),
         m_compatibility(compatibility),
-        m_isRunning(true)
+        m_maxOutstanding(maxOutstanding),
+        m_maxFrameRate(maxFrameRate),
+        m_isFreshScan(freshScan),
+        m_isRunning(true),
+        m_rescanInterval(rescanInterval),
+        m_isRescanning(false),
+        m_rescanRequested(false)
 {
-    snprintf(m_helpMessage, 512, "ib-scanner %s - git %s(%s)\n"
+    snprintf(m_helpMessage, sizeof(m_helpMessage), "ib-scanner %s - git %s(%s)\n"
                                  "Build date: %s\n"
                                  "Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,\n"
                                  "Institute of Computer Science, Department Operating Systems\n"
@@ -50,18 +90,32 @@ Scanner::Scanner(bool network, bool compatibility) :
                                  "Build against:\n"
                                  "Detector %s - git %s(%s)\n"
                                  "Build date: %s\n\n"
-                                 "Up/Down: Navigate menu\n"
+                                 "Up/Down/PageUp/PageDown/Home/End: Navigate menu\n"
                                  "Right/Left: Open/Close menu entry\n"
                                  "Enter: Select for single view\n"
+                                 "/: Search by description, GUID or LID\n"
                                  "1/2/3/4: Assign to window\n"
-                                 "Tab: Switch window", BuildConfig::VERSION, BuildConfig::GIT_REV,
-                                 BuildConfig::GIT_BRANCH, BuildConfig::BUILD_DATE, Detector::BuildConfig::VERSION,
+                                 "d: Add to/remove from dashboard (a node adds all of its ports)\n"
+                                 "Tab: Switch window\n"
+                                 "Top: 's' to change the order, Enter to monitor a port\n"
+                                 "Dashboard: Arrow keys to select a tile, Enter to monitor it, Del to remove it\n"
+                                 "Alerts: Enter to monitor a port",
+                                 BuildConfig::VERSION, BuildConfig::GIT_REV, BuildConfig::GIT_BRANCH, BuildConfig::BUILD_DATE, Detector::BuildConfig::VERSION,
                                  Detector::BuildConfig::GIT_REV, Detector::BuildConfig::GIT_BRANCH,
                                  Detector::BuildConfig::BUILD_DATE);
 }
 
 Scanner::~Scanner() {
+    m_sampler.Stop();
+
+    delete m_recorder;
+    delete m_player;
+
+    delete m_pmaConnection;
+    delete m_simulation;
+
     delete m_helpWindow;
+    delete m_compatibilityWindow;
     delete m_menuWindow;
     delete m_fabric;
 
@@ -70,9 +124,11 @@ Scanner::~Scanner() {
     delete m_monitorWindow[2];
     delete m_monitorWindow[3];
 
-    for(const auto &entry : m_diagPerfCounterMap) {
-        delete entry.second;
-    }
+    delete m_dashboardWindow;
+    delete m_topWindow;
+    delete m_alertWindow;
+    delete m_alertMonitor;
+    delete m_statsWindow;
 
     fdopen(m_oldStderr, "w");
 }
@@ -87,37 +143,142 @@ void Scanner::Run() {
 
     m_helpWindow = new Curses::OkMessageWindow("Help", m_helpMessage, [] {});
 
+    // The counters are refreshed independently of the frame rate; Samples, that arrive in between, share a frame
+    m_manager->SetMaxFrameRate(m_maxFrameRate);
+
+    m_manager->SetFrameObserver([&](uint64_t frameTime, uint64_t inputLatency) {
+        m_instrumentation.frameTime.Record(frameTime);
+
+        if(inputLatency > 0) {
+            m_instrumentation.inputLatency.Record(inputLatency);
+        }
+    });
+
     m_manager->Start();
 
-    ScanFabric();
+    if(!m_replayPath.empty()) {
+        OpenRecording();
+    } else if(m_simulation != nullptr) {
+        // The simulated fabric is discovered and rescanned like a real one, but it has no local devices
+        std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> diagPerfCounters;
+
+        BuildTopology(m_simulation->Discover(), diagPerfCounters);
+    } else if(!m_recordPath.empty()) {
+        // A recording's device table is fixed, so the entire fabric has to be known before recording
+        ScanFabric();
+    } else if((!m_isFreshScan && TopologyCache(m_network).Load(m_topology)) || AddLocalDevices()) {
+        // The known devices are shown immediately, the rest of the fabric is discovered in the background
+        RequestRescan();
+    } else {
+        ScanFabric();
+    }
 
     m_manager->AddMenuFunction("Help", [&] { m_manager->RegisterWindow(m_helpWindow); });
+
+    if(m_player != nullptr) {
+        AddReplayFunctions();
+    } else {
+        AddMonitorFunctions();
+    }
+
+    m_manager->AddMenuFunction("Top", [&] { ShowTopWindow(!m_topWindow->IsActive()); });
+    m_manager->AddMenuFunction("Dashboard", [&] { ShowDashboard(!m_dashboardWindow->IsActive()); });
+
+    if(!m_alertRulesPath.empty()) {
+        m_manager->AddMenuFunction("Alerts", [&] { ShowAlertWindow(!m_isAlertWindowShown); });
+    }
+
+    m_manager->AddMenuFunction("Stats", [&] { ShowStatsWindow(!m_isStatsWindowShown); });
+    m_manager->AddMenuFunction("Exit", [&] { Release(m_isRunning); });
+
+    StartMonitoring();
+
+    m_manager->DeregisterWindow(m_helpWindow);
+
+    m_manager->Stop();
+}
+
+void Scanner::AddMonitorFunctions() {
     m_manager->AddMenuFunction("Reset Counters", [&] {
         m_monitorWindow[0]->ResetValues();
         m_monitorWindow[1]->ResetValues();
         m_monitorWindow[2]->ResetValues();
         m_monitorWindow[3]->ResetValues();
+
+        if(m_dashboardWindow->IsActive()) {
+            m_dashboardWindow->ResetValues();
+        }
+
         m_manager->RequestRefresh();
     });
-    m_manager->AddMenuFunction("Single Window", [&] {
-        SetWindowCount(1);
+    m_manager->AddMenuFunction("Layout", [&] {
+        StepWindowCount();
         m_manager->SetFocus(m_menuWindow);
     });
-    m_manager->AddMenuFunction("Dual Window", [&] {
-        SetWindowCount(2);
+    m_manager->AddMenuFunction("Interval -", [&] { StepRefreshInterval(true); });
+    m_manager->AddMenuFunction("Interval +", [&] { StepRefreshInterval(false); });
+    m_manager->AddMenuFunction("Rescan", [&] { RequestRescan(); });
+}
+
+void Scanner::AddReplayFunctions() {
+    m_manager->AddMenuFunction("Layout", [&] {
+        StepWindowCount();
         m_manager->SetFocus(m_menuWindow);
     });
-    m_manager->AddMenuFunction("Quad Window", [&] {
-        SetWindowCount(4);
-        m_manager->SetFocus(m_menuWindow);
+    m_manager->AddMenuFunction("Pause", [&] {
+        m_player->SetPaused(!m_player->IsPaused());
+        UpdateReplayState();
     });
-    m_manager->AddMenuFunction("Exit", [&] { m_isRunning = false; });
+    m_manager->AddMenuFunction("Speed", [&] {
+        m_player->SetSpeed(m_player->GetSpeed() >= 100 ? 1 : m_player->GetSpeed() * 10);
+        UpdateReplayState();
+    });
+    m_manager->AddMenuFunction("Seek -", [&] {
+        m_player->SeekRelative(-0.05);
+        UpdateReplayState();
+    });
+    m_manager->AddMenuFunction("Seek +", [&] {
+        m_player->SeekRelative(0.05);
+        UpdateReplayState();
+    });
+}
 
-    StartMonitoring();
+void Scanner::UpdateReplayState() {
+    char title[32];
 
-    m_manager->DeregisterWindow(m_helpWindow);
+    if(m_player->IsPaused()) {
+        snprintf(title, sizeof(title), "Replay (paused)");
+    } else {
+        snprintf(title, sizeof(title), "Replay (%ux)", m_player->GetSpeed());
+    }
 
-    m_manager->Stop();
+    m_menuWindow->SetTitle(title);
+
+    // Show the sweep, that matches the new replay time, immediately
+    m_sampler.RequestSample();
+}
+
+void Scanner::StepRefreshInterval(bool shorter) {
+    uint32_t current = m_sampler.GetRefreshInterval();
+    uint32_t next = current;
+
+    // The current interval may have been set via the command line and not be part of the table
+    if (shorter) {
+        for (uint32_t interval : refreshIntervals) {
+            if (interval < current) {
+                next = interval;
+            }
+        }
+    } else {
+        for (uint32_t interval : refreshIntervals) {
+            if (interval > current) {
+                next = interval;
+                break;
+            }
+        }
+    }
+
+    m_sampler.SetRefreshInterval(next);
 }
 
 void Scanner::ScanFabric() {
@@ -126,13 +287,75 @@ void Scanner::ScanFabric() {
     Curses::MessageWindow scanMsg("scanner", "Scanning fabric! Please wait...");
     m_manager->RegisterWindow(&scanMsg);
 
-    // Scan for local devices and create an instance of Detector::IbDiagPerfCounter for each found device
+    std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> diagPerfCounters;
+
+    if(!CreateDiagPerfCounters(diagPerfCounters)) {
+        printf("Unable to get device list! Error: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    //Scan the entire fabric for devices
+    try {
+        m_fabric = new Detector::IbFabric(m_network, m_compatibility);
+    } catch (const Detector::IbMadException &exception) {
+        bool wait = true;
+
+        Curses::YesNoMessageWindow errorWindow("Error", compatibilityQuestion, [&](bool sel) {
+            if(sel){
+                m_network = false;
+                m_compatibility = true;
+
+                delete m_fabric;
+                m_fabric = new Detector::IbFabric(false, m_compatibility);
+
+                Release(wait);
+            } else {
+                m_manager->Stop();
+                exit(EXIT_FAILURE);
+            }
+        });
+
+        m_manager->RegisterWindow(&errorWindow);
+
+        WaitWhile(wait);
+    } catch (const Detector::IbFileException &exception) {
+        m_manager->Stop();
+        exit(EXIT_FAILURE);
+    }
+
+    BuildTopology(Topology::ListNodes(*m_fabric), diagPerfCounters);
+
+    TopologyCache(m_network).Save(m_topology);
+
+    m_manager->DeregisterWindow(&scanMsg);
+
+    bool wait = true;
+
+    snprintf(doneMsgBuf, 100, "Finished scanning fabric! %d nodes found.", m_fabric->GetNumNodes());
+
+    Curses::OkMessageWindow doneMsg("scanner", doneMsgBuf, [&] {
+        Release(wait);
+
+        if(m_fabric->GetNumNodes() == 0) {
+            m_manager->Stop();
+
+            exit(EXIT_SUCCESS);
+        }
+    });
+
+    Curses::WindowManager::GetInstance()->RegisterWindow(&doneMsg);
+
+    WaitWhile(wait);
+}
+
+bool Scanner::CreateDiagPerfCounters(std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> &diagPerfCounters) {
+    // Scan for local devices and create an instance of Detector::IbDiagPerfCounter for each found device.
+    // The counters of nodes are identified by their GUID, the counters of ports by their LID.
     int numDevices;
     ibv_device **deviceList = ibv_get_device_list(&numDevices);
 
     if(deviceList == nullptr) {
-        printf("Unable to get device list! Error: %s\n", strerror(errno));
-        exit(EXIT_FAILURE);
+        return false;
     }
 
     for(int32_t i = 0; i < numDevices; i++) {
@@ -151,7 +374,7 @@ void Scanner::ScanFabric() {
             continue;
         }
 
-        m_diagPerfCounterMap[ntohll(deviceAttributes.node_guid)] = new Detector::IbDiagPerfCounter(deviceName, 0);
+        diagPerfCounters[ntohll(deviceAttributes.node_guid)] = new Detector::IbDiagPerfCounter(deviceName, 0);
 
         for(uint8_t j = 1; j < deviceAttributes.phys_port_cnt + 1; j++) {
             ibv_port_attr portAttributes{};
@@ -161,7 +384,7 @@ void Scanner::ScanFabric() {
                 continue;
             }
 
-            m_diagPerfCounterMap[portAttributes.lid] = new Detector::IbDiagPerfCounter(deviceName, j);
+            diagPerfCounters[portAttributes.lid] = new Detector::IbDiagPerfCounter(deviceName, j);
         }
 
         ibv_close_device(deviceContext);
@@ -169,174 +392,269 @@ void Scanner::ScanFabric() {
 
     ibv_free_device_list(deviceList);
 
-    //Scan the entire fabric for devices
-    try {
-        m_fabric = new Detector::IbFabric(m_network, m_compatibility);
-    } catch (const Detector::IbMadException &exception) {
-        bool wait = true;
+    return true;
+}
 
-        Curses::YesNoMessageWindow errorWindow("Error", "An error occurred, while scanning the fabric.\n"
-                                                           "You probably don't have root privileges.\n"
-                                                           "Do you want to continue in compatibility mode?\n"
-                                                           "You will only be able to scan local devices,\n"
-                                                           "but don't need root prvilieges.",
-                                                           [&](bool sel) {
-            if(sel){
-                m_compatibility = true;
+bool Scanner::AddLocalDevices() {
+    int numDevices;
+    ibv_device **deviceList = ibv_get_device_list(&numDevices);
 
-                delete m_fabric;
-                m_fabric = new Detector::IbFabric(false, m_compatibility);
+    if(deviceList == nullptr) {
+        return false;
+    }
 
-                wait = false;
-            } else {
-                m_manager->Stop();
-                exit(EXIT_FAILURE);
+    for(int32_t i = 0; i < numDevices; i++) {
+        const char *deviceName = ibv_get_device_name(deviceList[i]);
+        ibv_context *deviceContext = ibv_open_device(deviceList[i]);
+
+        if(deviceContext == nullptr) {
+            continue;
+        }
+
+        ibv_device_attr deviceAttributes{};
+
+        if(ibv_query_device(deviceContext, &deviceAttributes) != 0) {
+            ibv_close_device(deviceContext);
+            continue;
+        }
+
+        // The node description is only known after scanning the fabric, so the device name is shown until then
+        Device &node = m_topology.AddNode(ntohll(deviceAttributes.node_guid), deviceName, 0, nullptr,
+                                          new Detector::IbDiagPerfCounter(deviceName, 0));
+
+        for(uint8_t j = 1; j < deviceAttributes.phys_port_cnt + 1; j++) {
+            ibv_port_attr portAttributes{};
+
+            if(ibv_query_port(deviceContext, j, &portAttributes) != 0) {
+                continue;
             }
-        });
 
-        m_manager->RegisterWindow(&errorWindow);
+            if(node.ports.empty()) {
+                node.lid = portAttributes.lid;
+            }
 
-        while(wait);
-    } catch (const Detector::IbFileException &exception) {
-        m_manager->Stop();
-        exit(EXIT_FAILURE);
+            m_topology.AddPort(node.id, portAttributes.lid, j, nullptr, new Detector::IbDiagPerfCounter(deviceName, j));
+        }
+
+        ibv_close_device(deviceContext);
     }
 
-    m_manager->DeregisterWindow(&scanMsg);
+    ibv_free_device_list(deviceList);
 
-    bool wait = true;
+    return !m_topology.GetNodes().empty();
+}
 
-    snprintf(doneMsgBuf, 100, "Finished scanning fabric! %d nodes found.", m_fabric->GetNumNodes());
+void Scanner::BuildTopology(const std::vector<DiscoveredNode> &nodes,
+                            std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> &diagPerfCounters) {
+    for (const DiscoveredNode &node : nodes) {
+        Detector::IbDiagPerfCounter *nodeDiagPerfCounter = nullptr;
 
-    Curses::OkMessageWindow doneMsg("scanner", doneMsgBuf, [&] {
-        wait = false;
+        if(diagPerfCounters.find(node.guid) != diagPerfCounters.end()) {
+            nodeDiagPerfCounter = diagPerfCounters[node.guid];
+            diagPerfCounters.erase(node.guid);
+        }
 
-        if(m_fabric->GetNumNodes() == 0) {
-            m_manager->Stop();
+        uint32_t nodeId = m_topology.AddNode(node.guid, node.description, node.lid, node.perfCounter,
+                                             nodeDiagPerfCounter).id;
 
-            exit(EXIT_SUCCESS);
+        for (const DiscoveredPort &port : node.ports) {
+            Detector::IbDiagPerfCounter *portDiagPerfCounter = nullptr;
+
+            if(diagPerfCounters.find(port.lid) != diagPerfCounters.end()) {
+                portDiagPerfCounter = diagPerfCounters[port.lid];
+                diagPerfCounters.erase(port.lid);
+            }
+
+            m_topology.AddPort(nodeId, port.lid, port.portNum, port.perfCounter, portDiagPerfCounter);
         }
-    });
+    }
 
-    Curses::WindowManager::GetInstance()->RegisterWindow(&doneMsg);
+    // The topology has taken ownership of all matched counters
+    for(const auto &entry : diagPerfCounters) {
+        delete entry.second;
+    }
+}
+
+void Scanner::OpenRecording() {
+    bool wait = true;
+
+    try {
+        m_player = new Player(m_replayPath.c_str());
+        m_player->AddDevices(m_topology);
+    } catch (const std::runtime_error &exception) {
+        Curses::OkMessageWindow errorWindow("Error", exception.what(), [&] {
+            m_manager->Stop();
+            exit(EXIT_FAILURE);
+        });
+
+        m_manager->RegisterWindow(&errorWindow);
+
+        WaitWhile(wait);
+    }
+
+    if(m_topology.GetNodes().empty()) {
+        m_manager->Stop();
+        exit(EXIT_SUCCESS);
+    }
+}
+
+void Scanner::CreateRecorder() {
+    if(m_recordPath.empty()) {
+        return;
+    }
+
+    try {
+        m_recorder = new Recorder(m_recordPath.c_str(), m_topology, m_sampler);
+    } catch (const std::runtime_error &exception) {
+        bool wait = true;
+
+        Curses::OkMessageWindow errorWindow("Error", exception.what(), [&] { Release(wait); });
+
+        m_manager->RegisterWindow(&errorWindow);
 
-    while(wait);
+        WaitWhile(wait);
+    }
 }
 
 void Scanner::StartMonitoring() {
     uint32_t termWidth = m_manager->GetTerminalWidth();
     uint32_t termHeight = m_manager->GetTerminalHeight();
 
-    m_menuWindow = new Curses::MenuWindow(0, 0, 70, termHeight - 1, "Menu");
+    const char *menuTitle = m_player != nullptr ? "Replay (1x)" : m_simulation != nullptr ? "Simulation" : "Menu";
 
-    Detector::IbDiagPerfCounter *diagPerfCounter = nullptr;
+    m_menuWindow = new Curses::MenuWindow(0, 0, 70, termHeight - 1, menuTitle);
 
-    if(m_diagPerfCounterMap.find(m_fabric->GetNodes()[0]->GetGuid()) != m_diagPerfCounterMap.end()) {
-        diagPerfCounter = m_diagPerfCounterMap[m_fabric->GetNodes()[0]->GetGuid()];
-    }
+    Device *firstNode = &m_topology.GetDevice(m_topology.GetNodes()[0]);
 
-    m_monitorWindow[0] = new MonitorWindow(70, 0, termWidth - 70, termHeight - 1,
-            m_fabric->GetNodes()[0]->GetDescription().c_str(), m_fabric->GetNodes()[0], diagPerfCounter);
-    m_monitorWindow[1] = new MonitorWindow(70, 0, termWidth - 70, termHeight - 1,
-            m_fabric->GetNodes()[0]->GetDescription().c_str(), m_fabric->GetNodes()[0], diagPerfCounter);
-    m_monitorWindow[2] = new MonitorWindow(70, 0, termWidth - 70, termHeight - 1,
-            m_fabric->GetNodes()[0]->GetDescription().c_str(), m_fabric->GetNodes()[0], diagPerfCounter);
-    m_monitorWindow[3] = new MonitorWindow(70, 0, termWidth - 70, termHeight - 1,
-            m_fabric->GetNodes()[0]->GetDescription().c_str(), m_fabric->GetNodes()[0], diagPerfCounter);
+    for(auto &monitorWindow : m_monitorWindow) {
+        monitorWindow = new MonitorWindow(70, 0, termWidth - 70, termHeight - 1, firstNode->name.c_str(), m_sampler,
+                                          firstNode);
+    }
 
-    m_menuWindow->AddKeyHandler('1', [&]() {
-        Curses::MenuItem &item = m_menuWindow->GetSelectedItem();
+    m_topWindow = new TopWindow(0, 0, termWidth, termHeight - 1, m_sampler, m_topology,
+                                [&](const Device *port) { MonitorPort(port); });
 
-        Detector::IbPerfCounter* perfCounter = reinterpret_cast<Detector::IbPerfCounter*>(item.GetData());
-        Detector::IbDiagPerfCounter* diagCounter = m_diagPerfCounterMap[reinterpret_cast<uint64_t>(perfCounter)];
+    m_dashboardWindow = new DashboardWindow(0, 0, termWidth, termHeight - 1, m_sampler, m_topology,
+                                            [&](const Device *port) { MonitorPort(port); });
 
-        m_monitorWindow[0]->SetPerfCounter(perfCounter, diagCounter);
-        m_monitorWindow[0]->SetTitle(item.GetName());
-    });
+    CreateAlertMonitor();
 
-    m_menuWindow->AddKeyHandler('2', [&]() {
-        Curses::MenuItem &item = m_menuWindow->GetSelectedItem();
+    m_statsWindow = new StatsWindow(termWidth > 74 ? termWidth - 74 : 0, 0, 74, 13, m_sampler, m_instrumentation);
 
-        Detector::IbPerfCounter* perfCounter = reinterpret_cast<Detector::IbPerfCounter*>(item.GetData());
-        Detector::IbDiagPerfCounter* diagCounter = m_diagPerfCounterMap[reinterpret_cast<uint64_t>(perfCounter)];
+    // The measurements of the sampler are shown after every sweep
+    m_sampler.AddSweepCallback([&] { m_statsWindow->Invalidate(); });
 
-        m_monitorWindow[1]->SetPerfCounter(perfCounter, diagCounter);
-        m_monitorWindow[1]->SetTitle(item.GetName());
-    });
+    for(uint8_t i = 0; i < 4; i++) {
+        m_menuWindow->AddKeyHandler('1' + i, [&, i]() {
+            auto *device = static_cast<Device*>(m_menuWindow->GetSelectedData());
 
-    m_menuWindow->AddKeyHandler('3', [&]() {
-        Curses::MenuItem &item = m_menuWindow->GetSelectedItem();
+            if(device != nullptr) {
+                m_monitorWindow[i]->SetDevice(device);
+                m_monitorWindow[i]->SetTitle(m_menuWindow->GetSelectedName());
+            }
+        });
+    }
 
-        Detector::IbPerfCounter* perfCounter = reinterpret_cast<Detector::IbPerfCounter*>(item.GetData());
-        Detector::IbDiagPerfCounter* diagCounter = m_diagPerfCounterMap[reinterpret_cast<uint64_t>(perfCounter)];
+    m_menuWindow->AddKeyHandler('d', [&]() {
+        auto *device = static_cast<Device*>(m_menuWindow->GetSelectedData());
 
-        m_monitorWindow[2]->SetPerfCounter(perfCounter, diagCounter);
-        m_monitorWindow[2]->SetTitle(item.GetName());
+        if(device != nullptr) {
+            ToggleDashboardTiles(device);
+        }
     });
 
-    m_menuWindow->AddKeyHandler('4', [&]() {
-        Curses::MenuItem &item = m_menuWindow->GetSelectedItem();
+    m_menuWindow->SetClickHandler([&](void *data) { ShowDevice(static_cast<Device*>(data)); });
+
+    m_menuWindow->SetExpandHandler([&](void *data) {
+        auto *node = static_cast<Device*>(data);
 
-        Detector::IbPerfCounter* perfCounter = reinterpret_cast<Detector::IbPerfCounter*>(item.GetData());
-        Detector::IbDiagPerfCounter* diagCounter = m_diagPerfCounterMap[reinterpret_cast<uint64_t>(perfCounter)];
+        for (uint32_t portId : node->ports) {
+            Device *port = &m_topology.GetDevice(portId);
+
+            if(port->isPresent) {
+                m_menuWindow->AddSubitem(node, port->name.c_str(), port);
+            }
+        }
 
-        m_monitorWindow[3]->SetPerfCounter(perfCounter, diagCounter);
-        m_monitorWindow[3]->SetTitle(item.GetName());
+        // The new items are not marked yet
+        if(m_alertMonitor != nullptr) {
+            UpdateAlertMarks();
+        }
     });
 
-    for (Detector::IbNode *node : m_fabric->GetNodes()) {
-        Detector::IbDiagPerfCounter *nodeDiagPerfCounter = nullptr;
+    for (uint32_t nodeId : m_topology.GetNodes()) {
+        AddNodeItem(&m_topology.GetDevice(nodeId));
+        m_searchIndex.Update(m_topology.GetDevice(nodeId));
+    }
 
-        if(m_diagPerfCounterMap.find(node->GetGuid()) != m_diagPerfCounterMap.end()) {
-            nodeDiagPerfCounter = m_diagPerfCounterMap[node->GetGuid()];
+    m_menuWindow->SetSearchFunction([&](const std::string &query, std::unordered_set<const void*> &matches) {
+        std::vector<uint32_t> nodeIds;
+        m_searchIndex.Search(query, nodeIds);
 
-            m_diagPerfCounterMap.erase(node->GetGuid());
-            m_diagPerfCounterMap[reinterpret_cast<uint64_t>(node)] = nodeDiagPerfCounter;
+        for (uint32_t nodeId : nodeIds) {
+            matches.insert(&m_topology.GetDevice(nodeId));
         }
+    });
+
+    if(m_player != nullptr) {
+        m_sampler.SetPlayer(m_player);
+    } else {
+        m_pmaConnection = new PmaConnection(m_sampler, m_compatibility, m_maxOutstanding, m_simulation);
+        CreateRecorder();
+    }
 
-        Curses::MenuItem item(node->GetDescription().c_str(), [&, node, nodeDiagPerfCounter]() {
-            SetWindowCount(1);
+    m_sampler.SetInstrumentation(&m_instrumentation);
 
-            m_manager->SetFocus(m_menuWindow);
+    m_monitorWindow[0]->SetActive(true);
+    m_sampler.Start();
 
-            m_monitorWindow[0]->SetPerfCounter(node, nodeDiagPerfCounter);
-            m_monitorWindow[0]->SetTitle(node->GetDescription().c_str());
+    m_manager->RegisterWindow(m_monitorWindow[0]);
+    m_manager->RegisterWindow(m_menuWindow);
 
-            m_manager->RequestRefresh();
-        }, node);
+    if(m_player == nullptr) {
+        m_isRescanning = true;
+        m_rescanThread = std::thread(&Scanner::RunRescans, this);
+    }
 
-        for (Detector::IbPort *port : node->GetPorts()) {
-            char portName[10];
-            snprintf(portName, 10, "Port %d", unsigned(port->GetNum()));
+    WaitWhile(m_isRunning);
 
-            Detector::IbDiagPerfCounter *portDiagPerfCounter = nullptr;
+    // A running rescan is cancelled; The discovery of the fabric is abandoned instead of waiting for it to finish
+    if(m_rescanThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_rescanLock);
 
-            if(m_diagPerfCounterMap.find(port->GetLid()) != m_diagPerfCounterMap.end()) {
-                portDiagPerfCounter = m_diagPerfCounterMap[port->GetLid()];
+            m_isRescanning = false;
 
-                m_diagPerfCounterMap.erase(port->GetLid());
-                m_diagPerfCounterMap[reinterpret_cast<uint64_t>(port)] = portDiagPerfCounter;
-            }
+            if(m_discovery != nullptr) {
+                std::lock_guard<std::mutex> discoveryLock(m_discovery->lock);
 
-            item.AddSubitem(Curses::MenuItem(portName, [&, port, portName, portDiagPerfCounter]() {
-                SetWindowCount(1);
+                m_discovery->isAbandoned = true;
+                m_discovery->condition.notify_all();
+            }
+        }
 
-                m_manager->SetFocus(m_menuWindow);
+        m_rescanCondition.notify_all();
+        m_rescanThread.join();
+    }
 
-                m_monitorWindow[0]->SetPerfCounter(port, portDiagPerfCounter);
-                m_monitorWindow[0]->SetTitle(portName);
+    m_sampler.Stop();
 
-                m_manager->RequestRefresh();
-            }, port));
-        }
+    ShowTopWindow(false);
+    ShowDashboard(false);
 
-        m_menuWindow->AddItem(item);
+    if(m_alertMonitor != nullptr) {
+        ShowAlertWindow(false);
     }
 
-    m_manager->RegisterWindow(m_monitorWindow[0]);
-    m_manager->RegisterWindow(m_menuWindow);
+    ShowStatsWindow(false);
 
-    while (m_isRunning);
+    // Writes the remaining samples
+    delete m_recorder;
+    m_recorder = nullptr;
+
+    if(m_compatibilityWindow != nullptr) {
+        m_manager->DeregisterWindow(m_compatibilityWindow);
+    }
 
     m_manager->DeregisterWindow(m_menuWindow);
     m_manager->DeregisterWindow(m_monitorWindow[0]);
@@ -345,41 +663,565 @@ void Scanner::StartMonitoring() {
     m_manager->DeregisterWindow(m_monitorWindow[3]);
 }
 
-void Scanner::SetWindowCount(uint8_t windowCount) {
-    uint32_t termWidth = m_manager->GetTerminalWidth();
-    uint32_t termHeight = m_manager->GetTerminalHeight();
+void Scanner::AddNodeItem(Device *node) {
+    bool hasPorts = std::any_of(node->ports.begin(), node->ports.end(), [this](uint32_t portId) {
+        return m_topology.GetDevice(portId).isPresent;
+    });
 
-    m_manager->DeregisterWindow(m_monitorWindow[0]);
-    m_manager->DeregisterWindow(m_monitorWindow[1]);
-    m_manager->DeregisterWindow(m_monitorWindow[2]);
-    m_manager->DeregisterWindow(m_monitorWindow[3]);
+    m_menuWindow->AddItem(node->name.c_str(), node, hasPorts);
+}
 
-    if(windowCount == 1) {
-        m_manager->RegisterWindow(m_monitorWindow[0]);
+void Scanner::ShowDevice(Device *device) {
+    SetWindowCount(1);
 
-        m_monitorWindow[0]->Move(70, 0);
-        m_monitorWindow[0]->Resize(termWidth - 70, (termHeight - 1));
-    } else if(windowCount == 2) {
-        m_manager->RegisterWindow(m_monitorWindow[1]);
-        m_manager->RegisterWindow(m_monitorWindow[0]);
+    m_manager->SetFocus(m_menuWindow);
 
-        m_monitorWindow[0]->Move(70, 0);
-        m_monitorWindow[0]->Resize(termWidth - 70, (termHeight - 1) / 2);
-        m_monitorWindow[1]->Move(70, (termHeight - 1) / 2);
-        m_monitorWindow[1]->Resize(termWidth - 70, (termHeight - 1) / 2);
-    } else if(windowCount == 4) {
-        m_manager->RegisterWindow(m_monitorWindow[3]);
-        m_manager->RegisterWindow(m_monitorWindow[2]);
-        m_manager->RegisterWindow(m_monitorWindow[1]);
-        m_manager->RegisterWindow(m_monitorWindow[0]);
+    m_monitorWindow[0]->SetDevice(device);
+    m_monitorWindow[0]->SetTitle(device->name.c_str());
 
-        m_monitorWindow[0]->Move(70, 0);
-        m_monitorWindow[0]->Resize(termWidth - 70, (termHeight - 1) / 4);
-        m_monitorWindow[1]->Move(70, (termHeight - 1) / 4);
-        m_monitorWindow[1]->Resize(termWidth - 70, (termHeight - 1) / 4);
-        m_monitorWindow[2]->Move(70, (termHeight - 1) / 2);
-        m_monitorWindow[2]->Resize(termWidth - 70, (termHeight - 1) / 4);
-        m_monitorWindow[3]->Move(70, (termHeight - 1) - (termHeight - 1) / 4);
+    m_manager->RequestRefresh();
+}
+
+void Scanner::RunRescans() {
+    std::unique_lock<std::mutex> lock(m_rescanLock);
+
+    while(m_isRescanning) {
+        auto isDue = [this] { return !m_isRescanning || m_rescanRequested; };
+
+        if(m_rescanInterval > 0) {
+            m_rescanCondition.wait_for(lock, std::chrono::milliseconds(m_rescanInterval), isDue);
+        } else {
+            m_rescanCondition.wait(lock, isDue);
+        }
+
+        if(!m_isRescanning) {
+            break;
+        }
+
+        m_rescanRequested = false;
+
+        lock.unlock();
+        Rescan();
+        lock.lock();
+    }
+}
+
+void Scanner::RequestRescan() {
+    {
+        std::lock_guard<std::mutex> lock(m_rescanLock);
+
+        m_rescanRequested = true;
+    }
+
+    m_rescanCondition.notify_all();
+}
+
+void Scanner::Rescan() {
+    std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> diagPerfCounters;
+    std::vector<DiscoveredNode> nodes;
+    Detector::IbFabric *fabric = nullptr;
+    bool network, compatibility;
+    bool isMadError = false;
+    auto discovery = std::make_shared<Discovery>();
+
+    {
+        std::lock_guard<std::mutex> lock(m_rescanLock);
+
+        // Exiting can only abandon a discovery, that it can see
+        if(!m_isRescanning) {
+            return;
+        }
+
+        network = m_network;
+        compatibility = m_compatibility;
+        m_discovery = discovery;
+    }
+
+    if(m_simulation != nullptr) {
+        // The simulated fabric is discovered instantly, so it is not handed to a thread, that may outlive it
+        nodes = m_simulation->Discover();
+    } else {
+        CreateDiagPerfCounters(diagPerfCounters);
+
+        fabric = DiscoverFabric(discovery, network, compatibility, isMadError);
+
+        if(fabric != nullptr) {
+            nodes = Topology::ListNodes(*fabric);
+        }
+    }
+
+    bool isCancelled;
+
+    {
+        std::lock_guard<std::mutex> lock(m_rescanLock);
+
+        m_discovery.reset();
+        isCancelled = !m_isRescanning;
+    }
+
+    // When exiting, the fabric is dropped without touching the sampler, the topology or the cache
+    if(isCancelled || (fabric == nullptr && m_simulation == nullptr)) {
+        delete fabric;
+
+        for(const auto &entry : diagPerfCounters) {
+            delete entry.second;
+        }
+
+        if(isCancelled) {
+            return;
+        }
+
+        // Without root privileges, the fabric cannot be scanned at all, so the user can switch to local devices
+        if(isMadError && !compatibility && m_fabric == nullptr) {
+            m_manager->Post([this] { AskForCompatibility(); });
+        }
+
+        m_manager->Post([this] { m_manager->SetStatus("Scanning fabric failed"); });
+
+        return;
+    }
+
+    // The sampler must not touch any device, while the topology is changed
+    m_sampler.Pause();
+
+    bool isApplied = false;
+
+    m_manager->Post([&] {
+        ApplyRescan(nodes, fabric, diagPerfCounters);
+
+        {
+            std::lock_guard<std::mutex> lock(m_rescanLock);
+
+            isApplied = true;
+        }
+
+        m_rescanCondition.notify_all();
+    });
+
+    {
+        std::unique_lock<std::mutex> lock(m_rescanLock);
+
+        m_rescanCondition.wait(lock, [&isApplied] { return isApplied; });
+    }
+
+    m_sampler.Resume();
+
+    // The topology is only changed by this thread (via the UI thread), so it can be read without the sampler.
+    // A simulated fabric must not replace the cached topology of the real one.
+    if(m_simulation == nullptr) {
+        TopologyCache(network).Save(m_topology);
+    }
+}
+
+Detector::IbFabric *Scanner::DiscoverFabric(const std::shared_ptr<Discovery> &discovery, bool network,
+                                            bool compatibility, bool &isMadError) {
+    // Detector does not report its progress, so the fabric is discovered in another thread, while this one shows
+    // the elapsed time. Neither the sampler nor the UI are disturbed by the discovery.
+    std::thread([discovery, network, compatibility] {
+        Detector::IbFabric *result = nullptr;
+        bool madError = false;
+
+        try {
+            result = new Detector::IbFabric(network, compatibility);
+        } catch (const Detector::IbMadException &exception) {
+            madError = true;
+        } catch (const std::exception &exception) {
+            // Reported as a failed scan
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(discovery->lock);
+
+            // Nobody waits for an abandoned discovery anymore
+            if(discovery->isAbandoned) {
+                delete result;
+                result = nullptr;
+            }
+
+            discovery->fabric = result;
+            discovery->isMadError = madError;
+            discovery->isFinished = true;
+        }
+
+        discovery->condition.notify_all();
+    }).detach();
+
+    std::unique_lock<std::mutex> lock(discovery->lock);
+    auto start = std::chrono::steady_clock::now();
+    auto isDone = [&discovery] { return discovery->isFinished || discovery->isAbandoned; };
+
+    do {
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start);
+        std::string status = "Scanning fabric... " + std::to_string(elapsed.count()) + "s";
+
+        m_manager->Post([this, status] { m_manager->SetStatus(status); });
+    } while(!discovery->condition.wait_for(lock, std::chrono::seconds(1), isDone));
+
+    Detector::IbFabric *fabric = discovery->fabric;
+    isMadError = discovery->isMadError;
+    discovery->fabric = nullptr;
+
+    return fabric;
+}
+
+void Scanner::AskForCompatibility() {
+    if(m_compatibilityWindow != nullptr) {
+        return;
+    }
+
+    m_compatibilityWindow = new Curses::YesNoMessageWindow("Error", compatibilityQuestion, [&](bool sel) {
+        if(sel) {
+            {
+                std::lock_guard<std::mutex> lock(m_rescanLock);
+
+                m_network = false;
+                m_compatibility = true;
+            }
+
+            RequestRescan();
+        } else {
+            Release(m_isRunning);
+        }
+    });
+
+    m_manager->RegisterWindow(m_compatibilityWindow);
+}
+
+void Scanner::ApplyRescan(const std::vector<DiscoveredNode> &nodes, Detector::IbFabric *fabric,
+                          std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> &diagPerfCounters) {
+    auto takeDiagPerfCounter = [&diagPerfCounters](uint64_t key) -> Detector::IbDiagPerfCounter* {
+        auto entry = diagPerfCounters.find(key);
+
+        if(entry == diagPerfCounters.end()) {
+            return nullptr;
+        }
+
+        Detector::IbDiagPerfCounter *diagPerfCounter = entry->second;
+        diagPerfCounters.erase(entry);
+
+        return diagPerfCounter;
+    };
+
+    std::vector<bool> isFound(m_topology.GetDeviceCount(), false);
+    uint32_t added = 0, changed = 0, removed = 0;
+
+    for (const DiscoveredNode &node : nodes) {
+        Device *device = m_topology.FindNode(node.guid);
+        bool isNew = device == nullptr || !device->isPresent;
+
+        // Unchanged nodes keep their device, so that their subscriptions and monitor windows are not affected
+        if(device == nullptr) {
+            device = &m_topology.AddNode(node.guid, node.description, node.lid, node.perfCounter,
+                                         takeDiagPerfCounter(node.guid));
+        } else {
+            if(m_topology.UpdateDevice(*device, node.lid, node.perfCounter) && !isNew) {
+                changed++;
+            }
+
+            if(device->diagPerfCounter == nullptr) {
+                m_topology.SetDiagPerfCounter(*device, takeDiagPerfCounter(node.guid));
+            }
+
+            if(device->name != node.description) {
+                device->name = node.description;
+
+                if(!isNew) {
+                    m_menuWindow->SetName(device, device->name.c_str());
+                    changed++;
+                }
+            }
+        }
+
+        isFound.resize(m_topology.GetDeviceCount(), false);
+        isFound[device->id] = true;
+
+        for (const DiscoveredPort &port : node.ports) {
+            Device *portDevice = m_topology.FindPort(*device, port.portNum);
+            bool isNewPort = portDevice == nullptr || !portDevice->isPresent;
+
+            if(portDevice == nullptr) {
+                portDevice = &m_topology.AddPort(device->id, port.lid, port.portNum, port.perfCounter,
+                                                 takeDiagPerfCounter(port.lid));
+
+                m_topWindow->AddPort(portDevice);
+
+                if(m_alertMonitor != nullptr) {
+                    m_alertMonitor->AddPort(portDevice);
+                }
+            } else {
+                if(m_topology.UpdateDevice(*portDevice, port.lid, port.perfCounter) && !isNewPort) {
+                    changed++;
+                }
+
+                if(portDevice->diagPerfCounter == nullptr) {
+                    m_topology.SetDiagPerfCounter(*portDevice, takeDiagPerfCounter(port.lid));
+                }
+            }
+
+            isFound.resize(m_topology.GetDeviceCount(), false);
+            isFound[portDevice->id] = true;
+
+            if(isNewPort && !isNew) {
+                m_menuWindow->AddSubitem(device, portDevice->name.c_str(), portDevice);
+                added++;
+            }
+        }
+
+        if(isNew) {
+            AddNodeItem(device);
+            added++;
+        }
+
+        // Only changed descriptions and LIDs are indexed again
+        m_searchIndex.Update(*device);
+    }
+
+    // Nodes precede their ports, so the ports of a removed node have already been removed with it
+    for (uint32_t id = 0; id < isFound.size(); id++) {
+        Device &device = m_topology.GetDevice(id);
+
+        if(device.isPresent && !isFound[id]) {
+            m_topology.RemoveDevice(device);
+            m_menuWindow->RemoveItem(&device);
+            removed++;
+        }
+    }
+
+    for(const auto &entry : diagPerfCounters) {
+        delete entry.second;
+    }
+
+    diagPerfCounters.clear();
+
+    // The devices do not refer to the old fabric's objects anymore
+    delete m_fabric;
+    m_fabric = fabric;
+
+    char status[64];
+
+    if(added + changed + removed == 0) {
+        snprintf(status, sizeof(status), "Scan finished: No changes");
+    } else {
+        snprintf(status, sizeof(status), "Scan finished: %u added, %u changed, %u removed", added, changed, removed);
+    }
+
+    m_manager->SetStatus(status);
+
+    // The menu items of new nodes and ports are not marked yet
+    if(m_alertMonitor != nullptr) {
+        UpdateAlertMarks();
+    }
+}
+
+void Scanner::WaitWhile(const bool &flag) {
+    std::unique_lock<std::mutex> lock(m_waitLock);
+
+    m_waitCondition.wait(lock, [&flag] { return !flag; });
+}
+
+void Scanner::Release(bool &flag) {
+    {
+        std::lock_guard<std::mutex> lock(m_waitLock);
+
+        flag = false;
+    }
+
+    m_waitCondition.notify_all();
+}
+
+void Scanner::ShowTopWindow(bool show) {
+    // Ranking all ports requires sampling all of them, so the window is only active, while it is shown
+    m_topWindow->SetActive(show);
+
+    if(show) {
+        m_manager->RegisterWindow(m_topWindow);
+    } else {
+        m_manager->DeregisterWindow(m_topWindow);
+    }
+
+    m_manager->RequestRefresh();
+}
+
+void Scanner::ShowDashboard(bool show) {
+    // The tiles are only sampled, while the dashboard is shown
+    m_dashboardWindow->SetActive(show);
+
+    if(show) {
+        m_manager->RegisterWindow(m_dashboardWindow);
+    } else {
+        m_manager->DeregisterWindow(m_dashboardWindow);
+    }
+
+    m_manager->RequestRefresh();
+}
+
+void Scanner::ToggleDashboardTiles(const Device *device) {
+    std::vector<const Device*> ports;
+
+    if(device->IsNode()) {
+        for(uint32_t portId : device->ports) {
+            const Device &port = m_topology.GetDevice(portId);
+
+            if(port.isPresent) {
+                ports.push_back(&port);
+            }
+        }
+    } else {
+        ports.push_back(device);
+    }
+
+    bool isShown = std::all_of(ports.begin(), ports.end(), [this](const Device *port) {
+        return m_dashboardWindow->HasTile(port);
+    });
+
+    for(const Device *port : ports) {
+        if(isShown) {
+            m_dashboardWindow->RemoveTile(port);
+        } else {
+            m_dashboardWindow->AddTile(port);
+        }
+    }
+
+    m_manager->SetStatus("Dashboard: " + std::to_string(m_dashboardWindow->GetTileCount()) + " tiles");
+}
+
+void Scanner::ShowStatsWindow(bool show) {
+    m_isStatsWindowShown = show;
+
+    if(show) {
+        m_manager->RegisterWindow(m_statsWindow);
+    } else {
+        m_manager->DeregisterWindow(m_statsWindow);
+    }
+
+    m_manager->RequestRefresh();
+}
+
+void Scanner::MonitorPort(const Device *port) {
+    std::string title = m_topology.GetDevice(port->nodeId).name + " / " + port->name;
+
+    ShowTopWindow(false);
+    ShowDashboard(false);
+
+    if(m_alertMonitor != nullptr) {
+        ShowAlertWindow(false);
+    }
+
+    SetWindowCount(1);
+
+    m_monitorWindow[0]->SetDevice(port);
+    m_monitorWindow[0]->SetTitle(title.c_str());
+
+    m_manager->SetFocus(m_menuWindow);
+}
+
+void Scanner::CreateAlertMonitor() {
+    if(m_alertRulesPath.empty()) {
+        return;
+    }
+
+    try {
+        AlertRules rules(m_alertRulesPath.c_str());
+
+        m_alertMonitor = new AlertMonitor(rules, m_sampler, m_topology,
+                                          m_alertLogPath.empty() ? nullptr : m_alertLogPath.c_str(),
+                                          [&](bool isChanged) {
+            m_alertWindow->Invalidate();
+
+            if(isChanged) {
+                m_manager->Post([&] { UpdateAlertMarks(); });
+            }
+        });
+    } catch (const std::runtime_error &exception) {
+        bool wait = true;
+
+        Curses::OkMessageWindow errorWindow("Error", exception.what(), [&] {
+            m_manager->Stop();
+            exit(EXIT_FAILURE);
+        });
+
+        m_manager->RegisterWindow(&errorWindow);
+
+        WaitWhile(wait);
+    }
+
+    m_alertWindow = new AlertWindow(0, 0, m_manager->GetTerminalWidth(), m_manager->GetTerminalHeight() - 1,
+                                    *m_alertMonitor, m_topology, [&](const Device *port) { MonitorPort(port); });
+}
+
+void Scanner::ShowAlertWindow(bool show) {
+    m_isAlertWindowShown = show;
+
+    if(show) {
+        m_manager->RegisterWindow(m_alertWindow);
+    } else {
+        m_manager->DeregisterWindow(m_alertWindow);
+    }
+
+    m_manager->RequestRefresh();
+}
+
+void Scanner::UpdateAlertMarks() {
+    std::shared_ptr<const AlertMonitor::Snapshot> snapshot = m_alertMonitor->GetSnapshot();
+    std::unordered_set<const void*> ports;
+
+    if(snapshot != nullptr) {
+        for(const AlertMonitor::Alert &alert : snapshot->alerts) {
+            ports.insert(alert.port);
+            // The items of a node's ports may not have been created yet, so the node is marked directly
+            ports.insert(&m_topology.GetDevice(alert.port->nodeId));
+        }
+    }
+
+    m_menuWindow->SetMarked([&ports](const void *data) { return ports.count(data) > 0; });
+}
+
+void Scanner::StepWindowCount() {
+    SetWindowCount(m_windowCount == 1 ? 2 : m_windowCount == 2 ? 4 : 1);
+}
+
+void Scanner::SetWindowCount(uint8_t windowCount) {
+    uint32_t termWidth = m_manager->GetTerminalWidth();
+    uint32_t termHeight = m_manager->GetTerminalHeight();
+
+    m_manager->DeregisterWindow(m_monitorWindow[0]);
+    m_manager->DeregisterWindow(m_monitorWindow[1]);
+    m_manager->DeregisterWindow(m_monitorWindow[2]);
+    m_manager->DeregisterWindow(m_monitorWindow[3]);
+
+    m_windowCount = windowCount;
+
+    // Only visible windows are sampled
+    for(uint8_t i = 0; i < 4; i++) {
+        m_monitorWindow[i]->SetActive(i < windowCount);
+    }
+
+    if(windowCount == 1) {
+        m_manager->RegisterWindow(m_monitorWindow[0]);
+
+        m_monitorWindow[0]->Move(70, 0);
+        m_monitorWindow[0]->Resize(termWidth - 70, (termHeight - 1));
+    } else if(windowCount == 2) {
+        m_manager->RegisterWindow(m_monitorWindow[1]);
+        m_manager->RegisterWindow(m_monitorWindow[0]);
+
+        m_monitorWindow[0]->Move(70, 0);
+        m_monitorWindow[0]->Resize(termWidth - 70, (termHeight - 1) / 2);
+        m_monitorWindow[1]->Move(70, (termHeight - 1) / 2);
+        m_monitorWindow[1]->Resize(termWidth - 70, (termHeight - 1) / 2);
+    } else if(windowCount == 4) {
+        m_manager->RegisterWindow(m_monitorWindow[3]);
+        m_manager->RegisterWindow(m_monitorWindow[2]);
+        m_manager->RegisterWindow(m_monitorWindow[1]);
+        m_manager->RegisterWindow(m_monitorWindow[0]);
+
+        m_monitorWindow[0]->Move(70, 0);
+        m_monitorWindow[0]->Resize(termWidth - 70, (termHeight - 1) / 4);
+        m_monitorWindow[1]->Move(70, (termHeight - 1) / 4);
+        m_monitorWindow[1]->Resize(termWidth - 70, (termHeight - 1) / 4);
+        m_monitorWindow[2]->Move(70, (termHeight - 1) / 2);
+        m_monitorWindow[2]->Resize(termWidth - 70, (termHeight - 1) / 4);
+        m_monitorWindow[3]->Move(70, (termHeight - 1) - (termHeight - 1) / 4);
         m_monitorWindow[3]->Resize(termWidth - 70, (termHeight - 1) / 4);
     }
 
@@ -390,6 +1232,22 @@ void Scanner::SetWindowCount(uint8_t windowCount) {
 
 bool network = true;
 bool compat = false;
+uint32_t maxOutstanding = 64;
+uint32_t refreshInterval = 2000;
+uint32_t rescanInterval = 0;
+uint32_t maxFrameRate = 30;
+bool freshScan = false;
+const char *alertRulesPath = nullptr;
+const char *alertLogPath = nullptr;
+bool headless = false;
+const char *targets = "all";
+const char *outputPath = nullptr;
+Scanner::SampleWriter::Format outputFormat = Scanner::SampleWriter::CSV;
+uint64_t sweepCount = 0;
+const char *recordPath = nullptr;
+const char *replayPath = nullptr;
+const char *exportAddress = nullptr;
+const char *simulation = nullptr;
 
 void printUsage() {
     printf("Usage: ./scanner [OPTION]...\n"
@@ -398,12 +1256,98 @@ void printUsage() {
            "    Set where to scan for devices, possible values are 'network' and 'local' (Default: 'network').\n"
            "-m, --mode\n"
            "    Set the operating mode to either 'mad' or 'compat' (Default: 'mad').\n"
+           "-o, --outstanding\n"
+           "    Set the maximum amount of performance management queries in flight (Default: 64).\n"
+           "-i, --interval\n"
+           "    Set the refresh interval, e.g. '100ms' or '2s'; Plain numbers are milliseconds (Default: 2000ms).\n"
+           "-u, --rescan\n"
+           "    Rescan the fabric periodically, e.g. '30s' (Default: only on demand via the menu).\n"
+           "-p, --fps\n"
+           "    Redraw the screen at most the given amount of times per second; 0 disables the limit (Default: 30).\n"
+           "-F, --fresh\n"
+           "    Discover the fabric from scratch, instead of starting with the devices found by the last scan.\n"
+           "-a, --alerts\n"
+           "    Check the rules in the given file on every sample of every port, e.g. 'SymbolErrors rate > 0',\n"
+           "    'XmitWait rate > 10%%' or 'RcvErrors delta > 100 over 60s'.\n"
+           "-A, --alert-log\n"
+           "    Append raised and cleared alerts to the given file.\n"
+           "-r, --record\n"
+           "    Record the samples of all devices to the given file.\n"
+           "-R, --replay\n"
+           "    Replay a recording instead of scanning the fabric (requires neither the fabric nor root privileges).\n"
+           "-S, --simulate\n"
+           "    Monitor a simulated fabric instead of the real one (requires neither the fabric nor root privileges);\n"
+           "    '<switches>:<HCA ports>[:<fraction of flaky ports>]', e.g. '500:20000' or '10:100:0.1'.\n"
+           "-H, --headless\n"
+           "    Stream samples without user interface instead of showing them on screen.\n"
+           "-x, --export\n"
+           "    Serve the latest samples of all devices in OpenMetrics format via HTTP at '/metrics' (implies\n"
+           "    '--headless'); Either a port (e.g. '9400') or an address and port (e.g. '127.0.0.1:9400').\n"
+           "-t, --targets\n"
+           "    Headless mode: Comma separated list of devices to sample; Either 'all' for every port,\n"
+           "    a node GUID (e.g. '0x0002c903000e8acc') or a node GUID and port number (e.g. '0x0002c903000e8acc:1')\n"
+           "    (Default: 'all').\n"
+           "-f, --format\n"
+           "    Headless mode: Set the output format to either 'csv' or 'json' lines (Default: 'csv').\n"
+           "-O, --output\n"
+           "    Headless mode: Set the file to write to; '-' writes to stdout (Default: '-', none with '--export').\n"
+           "-c, --count\n"
+           "    Headless mode: Stop after the given amount of sweeps; 0 runs until interrupted (Default: 0).\n"
            "-h, --help\n"
            "    Show this help message.\n");
 }
 
+bool parseInterval(const char *value, uint32_t &interval) {
+    char *end;
+    unsigned long number = strtoul(value, &end, 10);
+
+    if(end == value) {
+        return false;
+    }
+
+    if(!strcmp(end, "s")) {
+        number *= 1000;
+    } else if(*end != '\0' && strcmp(end, "ms") != 0) {
+        return false;
+    }
+
+    if(number == 0 || number > UINT32_MAX) {
+        return false;
+    }
+
+    interval = static_cast<uint32_t>(number);
+
+    return true;
+}
+
+Scanner::SimulatedFabric *parseSimulation(const char *value) {
+    unsigned int switchCount = 0;
+    unsigned int hcaPortCount = 0;
+    double errorRate = 0.01;
+    int length = 0;
+
+    // The fraction of flaky ports is optional
+    if(sscanf(value, "%u:%u%n:%lf%n", &switchCount, &hcaPortCount, &length, &errorRate, &length) < 2 ||
+       value[length] != '\0') {
+        return nullptr;
+    }
+
+    if(switchCount + hcaPortCount == 0 || errorRate < 0 || errorRate > 1) {
+        return nullptr;
+    }
+
+    try {
+        return new Scanner::SimulatedFabric(switchCount, hcaPortCount, errorRate);
+    } catch (const std::invalid_argument &exception) {
+        return nullptr;
+    }
+}
+
 void parseOpts(int argc, char *argv[]) {
     while(argc > 0) {
+        // Most options take a parameter
+        int optionLength = 2;
+
         if(!strcmp(argv[0], "-s") || !(strcmp(argv[0], "--scan"))) {
             if(argc < 2) {
                 printUsage();
@@ -442,6 +1386,204 @@ void parseOpts(int argc, char *argv[]) {
 
                 printf("\nUnrecognized parameter '%s' for option '%s'!\n", argv[1], argv[0]);
 
+                exit(EXIT_FAILURE);
+            }
+        } else if(!strcmp(argv[0], "-o") || !(strcmp(argv[0], "--outstanding"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            char *end;
+            maxOutstanding = static_cast<uint32_t>(strtoul(argv[1], &end, 10));
+
+            if(*end != '\0' || maxOutstanding == 0) {
+                printUsage();
+
+                printf("\nUnrecognized parameter '%s' for option '%s'!\n", argv[1], argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+        } else if(!strcmp(argv[0], "-i") || !(strcmp(argv[0], "--interval"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            if(!parseInterval(argv[1], refreshInterval)) {
+                printUsage();
+
+                printf("\nUnrecognized parameter '%s' for option '%s'!\n", argv[1], argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+        } else if(!strcmp(argv[0], "-u") || !(strcmp(argv[0], "--rescan"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            if(!parseInterval(argv[1], rescanInterval)) {
+                printUsage();
+
+                printf("\nUnrecognized parameter '%s' for option '%s'!\n", argv[1], argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+        } else if(!strcmp(argv[0], "-p") || !(strcmp(argv[0], "--fps"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            char *end;
+            unsigned long number = strtoul(argv[1], &end, 10);
+
+            if(*end != '\0' || end == argv[1] || number > 1000) {
+                printUsage();
+
+                printf("\nUnrecognized parameter '%s' for option '%s'!\n", argv[1], argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            maxFrameRate = static_cast<uint32_t>(number);
+        } else if(!strcmp(argv[0], "-F") || !(strcmp(argv[0], "--fresh"))) {
+            freshScan = true;
+            optionLength = 1;
+        } else if(!strcmp(argv[0], "-a") || !(strcmp(argv[0], "--alerts"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            alertRulesPath = argv[1];
+        } else if(!strcmp(argv[0], "-A") || !(strcmp(argv[0], "--alert-log"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            alertLogPath = argv[1];
+        } else if(!strcmp(argv[0], "-r") || !(strcmp(argv[0], "--record"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            recordPath = argv[1];
+        } else if(!strcmp(argv[0], "-R") || !(strcmp(argv[0], "--replay"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            replayPath = argv[1];
+        } else if(!strcmp(argv[0], "-S") || !(strcmp(argv[0], "--simulate"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            simulation = argv[1];
+        } else if(!strcmp(argv[0], "-H") || !(strcmp(argv[0], "--headless"))) {
+            headless = true;
+            optionLength = 1;
+        } else if(!strcmp(argv[0], "-x") || !(strcmp(argv[0], "--export"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            exportAddress = argv[1];
+            headless = true;
+        } else if(!strcmp(argv[0], "-t") || !(strcmp(argv[0], "--targets"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            targets = argv[1];
+        } else if(!strcmp(argv[0], "-f") || !(strcmp(argv[0], "--format"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            if(!strcmp(argv[1], "csv")) {
+                outputFormat = Scanner::SampleWriter::CSV;
+            } else if(!strcmp(argv[1], "json")) {
+                outputFormat = Scanner::SampleWriter::JSON;
+            } else {
+                printUsage();
+
+                printf("\nUnrecognized parameter '%s' for option '%s'!\n", argv[1], argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+        } else if(!strcmp(argv[0], "-O") || !(strcmp(argv[0], "--output"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            outputPath = argv[1];
+        } else if(!strcmp(argv[0], "-c") || !(strcmp(argv[0], "--count"))) {
+            if(argc < 2) {
+                printUsage();
+
+                printf("\n'%s' requires a parameter!\n", argv[0]);
+
+                exit(EXIT_FAILURE);
+            }
+
+            char *end;
+            sweepCount = strtoull(argv[1], &end, 10);
+
+            if(*end != '\0' || end == argv[1]) {
+                printUsage();
+
+                printf("\nUnrecognized parameter '%s' for option '%s'!\n", argv[1], argv[0]);
+
                 exit(EXIT_FAILURE);
             }
         } else if(!strcmp(argv[0], "-h") || !(strcmp(argv[0], "--help"))) {
@@ -456,15 +1598,73 @@ void parseOpts(int argc, char *argv[]) {
             exit(EXIT_FAILURE);
         }
 
-        argc -= 2;
-        argv = &argv[2];
+        argc -= optionLength;
+        argv = &argv[optionLength];
     }
 }
 
 int main(int argc, char *argv[]) {
     parseOpts(argc - 1, &argv[1]);
 
-    Scanner::Scanner perfMon(network, compat);
+    if(recordPath != nullptr && replayPath != nullptr) {
+        printUsage();
+
+        printf("\n'--record' and '--replay' cannot be used together!\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(simulation != nullptr && replayPath != nullptr) {
+        printUsage();
+
+        printf("\n'--simulate' and '--replay' cannot be used together!\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    Scanner::SimulatedFabric *simulatedFabric = nullptr;
+
+    if(simulation != nullptr) {
+        simulatedFabric = parseSimulation(simulation);
+
+        if(simulatedFabric == nullptr) {
+            printUsage();
+
+            printf("\nInvalid simulation '%s'!\n", simulation);
+
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if(headless) {
+        // These options only affect the user interface, so they are rejected instead of being ignored silently
+        const char *unsupported = replayPath != nullptr ? "--replay" :
+                                  alertRulesPath != nullptr ? "--alerts" :
+                                  alertLogPath != nullptr ? "--alert-log" :
+                                  rescanInterval > 0 ? "--rescan" :
+                                  freshScan ? "--fresh" : nullptr;
+
+        if(unsupported != nullptr) {
+            printUsage();
+
+            printf("\n'%s' is not available in headless mode!\n", unsupported);
+
+            exit(EXIT_FAILURE);
+        }
+
+        // When exporting, samples are only streamed, if an output has been given explicitly
+        if(outputPath == nullptr && exportAddress == nullptr) {
+            outputPath = "-";
+        }
+
+        Scanner::HeadlessScanner scanner(network, compat, maxOutstanding, refreshInterval, simulatedFabric);
+
+        exit(scanner.Run(targets, outputPath, outputFormat, sweepCount, recordPath, exportAddress));
+    }
+
+    Scanner::Scanner perfMon(network, compat, maxOutstanding, refreshInterval, recordPath, replayPath,
+                                 rescanInterval, freshScan, alertRulesPath, alertLogPath, simulatedFabric,
+                                 maxFrameRate);
 
     perfMon.Run();
 
@@ -19,11 +19,35 @@
 #ifndef IBSCANNER_IBSCANNER_H
 #define IBSCANNER_IBSCANNER_H
 
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <detector/IbDiagPerfCounter.h>
 #include <detector/IbFabric.h>
 #include <curses/OkMessageWindow.h>
+#include <curses/YesNoMessageWindow.h>
 #include <curses/MenuWindow.h>
+#include "AlertMonitor.h"
+#include "AlertRules.h"
+#include "AlertWindow.h"
+#include "DashboardWindow.h"
+#include "Instrumentation.h"
+#include "Sampler.h"
+#include "PmaConnection.h"
 #include "MonitorWindow.h"
+#include "StatsWindow.h"
+#include "TopWindow.h"
+#include "Player.h"
+#include "Recorder.h"
+#include "SearchIndex.h"
+#include "SimulatedFabric.h"
+#include "Topology.h"
+#include "TopologyCache.h"
 
 namespace Scanner {
 
@@ -41,9 +65,24 @@ public:
     /**
      * Constructor.
      *
+     * @param network Set to true, to scan the entire network instead of local devices only.
      * @param compatibility Set to true, to activate compatibility mode.
+     * @param maxOutstanding The maximum amount of performance management queries in flight.
+     * @param refreshInterval The interval in milliseconds, in which the counters are refreshed.
+     * @param recordPath The file to record all samples to (nullptr to disable recording).
+     * @param replayPath The recording to replay instead of scanning the fabric (nullptr to scan the fabric).
+     * @param rescanInterval The interval in milliseconds, in which the fabric is rescanned (0 to disable).
+     * @param freshScan Set to true, to scan the fabric on startup instead of starting with the cached topology.
+     * @param alertRulesPath The file with the rules, that are checked on every sample (nullptr to disable alerts).
+     * @param alertLogPath The file, which raised and cleared alerts are appended to (nullptr to disable logging).
+     * @param simulation The fabric to be monitored instead of the real one (nullptr to scan the real fabric);
+     *                   Is deleted by the scanner.
+     * @param maxFrameRate The maximum amount of times per second, that the screen is redrawn (0 for no limit).
      */
-    explicit Scanner(bool network, bool compatibility);
+    Scanner(bool network, bool compatibility, uint32_t maxOutstanding, uint32_t refreshInterval,
+            const char *recordPath = nullptr, const char *replayPath = nullptr, uint32_t rescanInterval = 0,
+            bool freshScan = false, const char *alertRulesPath = nullptr, const char *alertLogPath = nullptr,
+            SimulatedFabric *simulation = nullptr, uint32_t maxFrameRate = 30);
 
     /**
      * Destructor.
@@ -56,16 +95,151 @@ public:
     void Run();
 
 private:
+    /**
+     * The state of a fabric discovery during a rescan, which is shared with the discovery thread.
+     *
+     * The discovery thread is detached, so that exiting does not have to wait for it. When the discovery has been
+     * abandoned, the thread deletes the discovered fabric itself.
+     */
+    struct Discovery {
+        std::mutex lock;
+        std::condition_variable condition;
+        Detector::IbFabric *fabric = nullptr;
+        bool isMadError = false;
+        bool isFinished = false;
+        bool isAbandoned = false;
+    };
+
     /**
      * Scan the entire Infiniband fabric for devices.
      */
     void ScanFabric();
 
+    /**
+     * Create the diagnostic performance counters of all local devices.
+     *
+     * @param diagPerfCounters Receives the counters of nodes (by GUID) and ports (by LID)
+     *
+     * @return false, if the local devices cannot be listed
+     */
+    static bool CreateDiagPerfCounters(std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> &diagPerfCounters);
+
+    /**
+     * Add the local devices to the topology without scanning the fabric, so that they can be monitored right away.
+     *
+     * @return false, if there are no local devices
+     */
+    bool AddLocalDevices();
+
+    /**
+     * Fill the topology with the nodes and ports of the scanned or simulated fabric.
+     *
+     * @param nodes The discovered nodes
+     * @param diagPerfCounters The diagnostic performance counters of local nodes (by GUID) and ports (by LID);
+     *                         Counters, that do not belong to any device, are deleted
+     */
+    void BuildTopology(const std::vector<DiscoveredNode> &nodes,
+                       std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> &diagPerfCounters);
+
+    /**
+     * Open the recording to be replayed and fill the topology with the recorded devices.
+     */
+    void OpenRecording();
+
+    /**
+     * Start recording all devices of the topology, if a record path has been given.
+     */
+    void CreateRecorder();
+
+    /**
+     * Add the menu functions, that control live monitoring.
+     */
+    void AddMonitorFunctions();
+
+    /**
+     * Add the menu functions, that control the replay of a recording.
+     */
+    void AddReplayFunctions();
+
+    /**
+     * Show the player's state and refresh the monitor windows after it has changed.
+     */
+    void UpdateReplayState();
+
     /**
      * Show the MenuWindow and the MonitorWindow.
      */
     void StartMonitoring();
 
+    /**
+     * Add the menu item of a node. The items of its present ports are created, when it is expanded.
+     *
+     * @param node The node
+     */
+    void AddNodeItem(Device *node);
+
+    /**
+     * Show a node or port in a single MonitorWindow (called, when its menu item is chosen).
+     *
+     * @param device The device
+     */
+    void ShowDevice(Device *device);
+
+    /**
+     * The rescanning thread. Rescans the fabric periodically or when requested via RequestRescan().
+     */
+    void RunRescans();
+
+    /**
+     * Advise the rescanning thread to rescan the fabric as soon as possible.
+     */
+    void RequestRescan();
+
+    /**
+     * Scan the fabric (or the simulated fabric) again and apply the differences to the topology.
+     *
+     * The fabric is scanned in the rescanning thread, while the elapsed time is shown in the status bar.
+     * Afterwards, the sampler is paused and the differences are applied by the UI-thread, which owns the menu.
+     * When the scanner exits during the discovery, the discovery is abandoned and nothing is changed.
+     */
+    void Rescan();
+
+    /**
+     * Scan the fabric via Detector in a detached thread and wait for the result, while showing the elapsed time.
+     *
+     * @param discovery The discovery, which is shared with the detached thread
+     * @param network Set to true, to scan the entire network instead of local devices only
+     * @param compatibility Set to true, to scan in compatibility mode
+     * @param isMadError Set to true, if the performance management agents could not be accessed
+     *
+     * @return The fabric or nullptr, if scanning has failed or the discovery has been abandoned
+     */
+    Detector::IbFabric *DiscoverFabric(const std::shared_ptr<Discovery> &discovery, bool network, bool compatibility,
+                                       bool &isMadError);
+
+    /**
+     * Ask the user to continue in compatibility mode, after the first scan has failed. Must be executed by the
+     * UI-thread.
+     */
+    void AskForCompatibility();
+
+    /**
+     * Compare the freshly discovered nodes to the topology by GUID and port number and add, update or remove only
+     * the devices and menu items, that have changed. Must be executed by the UI-thread, while the sampler is paused.
+     *
+     * @param nodes The discovered nodes
+     * @param fabric The Detector fabric, that the nodes' Detector objects belong to, which replaces the current one
+     *               (nullptr for a simulated fabric)
+     * @param diagPerfCounters The diagnostic performance counters of local devices; Unused counters are deleted
+     */
+    void ApplyRescan(const std::vector<DiscoveredNode> &nodes, Detector::IbFabric *fabric,
+                     std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> &diagPerfCounters);
+
+    /**
+     * Switch to the next layout of monitor windows (1, 2, 4 and back to 1).
+     */
+    void StepWindowCount();
+
     /**
      * Set the amount of monitor windows to either 1, 2, or 4.
      *
@@ -73,25 +247,145 @@ private:
      */
     void SetWindowCount(uint8_t windowCount);
 
-private:
+    /**
+     * Show or hide the window, that ranks all ports.
+     *
+     * @param show Set to true, to show the window
+     */
+    void ShowTopWindow(bool show);
 
-    std::unordered_map<uint64_t, Detector::IbDiagPerfCounter*> m_diagPerfCounterMap;
+    /**
+     * Show or hide the dashboard, which shows the ports added via the menu as tiles.
+     *
+     * @param show Set to true, to show the dashboard
+     */
+    void ShowDashboard(bool show);
+
+    /**
+     * Add the tile of a port to the dashboard or remove it, if the port already has a tile. A node adds all of its
+     * present ports, or removes them, if all of them already have a tile.
+     *
+     * @param device The port or node
+     */
+    void ToggleDashboardTiles(const Device *device);
+
+    /**
+     * Show or hide the window with the scanner's own measurements.
+     *
+     * @param show Set to true, to show the window
+     */
+    void ShowStatsWindow(bool show);
+
+    /**
+     * Show the counters of a port, that has been selected in the top window or the alert window.
+     *
+     * @param port The port
+     */
+    void MonitorPort(const Device *port);
+
+    /**
+     * Read the alert rules and start checking them on every port.
+     */
+    void CreateAlertMonitor();
+
+    /**
+     * Show or hide the window, that lists the raised alerts.
+     *
+     * @param show Set to true, to show the window
+     */
+    void ShowAlertWindow(bool show);
+
+    /**
+     * Mark the menu items of all ports (and their nodes), that have raised alerts. Must be executed by the UI-thread.
+     */
+    void UpdateAlertMarks();
+
+    /**
+     * Switch to the next shorter or longer refresh interval.
+     *
+     * @param shorter Set to true, to refresh the counters more often
+     */
+    void StepRefreshInterval(bool shorter);
+
+    /**
+     * Block the calling thread until a flag has been cleared via Release().
+     *
+     * @param flag The flag
+     */
+    void WaitWhile(const bool &flag);
+
+    /**
+     * Clear a flag and wake up all threads waiting for it.
+     *
+     * @param flag The flag
+     */
+    void Release(bool &flag);
+
+private:
 
     Detector::IbFabric *m_fabric;
 
+    Topology m_topology;
+    SearchIndex m_searchIndex;
+
     Curses::WindowManager *m_manager;
 
-    char m_helpMessage[512];
+    Sampler m_sampler;
+
+    PmaConnection *m_pmaConnection;
+    SimulatedFabric *m_simulation;
+
+    Recorder *m_recorder;
+    Player *m_player;
+
+    std::string m_recordPath;
+    std::string m_replayPath;
+    std::string m_alertRulesPath;
+    std::string m_alertLogPath;
+
+    char m_helpMessage[1024];
     Curses::OkMessageWindow *m_helpWindow;
+    Curses::YesNoMessageWindow *m_compatibilityWindow;
     Curses::MenuWindow *m_menuWindow;
     MonitorWindow *m_monitorWindow[4];
+    uint8_t m_windowCount;
+    DashboardWindow *m_dashboardWindow;
+    TopWindow *m_topWindow;
+    AlertWindow *m_alertWindow;
+    bool m_isAlertWindowShown;
+
+    AlertMonitor *m_alertMonitor;
+
+    Instrumentation m_instrumentation;
+    StatsWindow *m_statsWindow;
+    bool m_isStatsWindowShown;
 
     int m_oldStderr;
 
     bool m_network;
     bool m_compatibility;
 
+    uint32_t m_maxOutstanding;
+    uint32_t m_maxFrameRate;
+
+    bool m_isFreshScan;
     bool m_isRunning;
+
+    std::mutex m_waitLock;
+    std::condition_variable m_waitCondition;
+
+    uint32_t m_rescanInterval;
+    std::thread m_rescanThread;
+    bool m_isRescanning;
+    bool m_rescanRequested;
+
+    /**
+     * The discovery of the running rescan (nullptr, if the fabric is not being discovered).
+     */
+    std::shared_ptr<Discovery> m_discovery;
+
+    std::mutex m_rescanLock;
+    std::condition_variable m_rescanCondition;
 };
 
 }
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include "SearchIndex.h"
+
+namespace Scanner {
+
+SearchIndex::SearchIndex(const Topology &topology) :
+        m_topology(topology) {
+
+}
+
+void SearchIndex::Update(const Device &node) {
+    if (m_names.size() < m_topology.GetDeviceCount()) {
+        m_names.resize(m_topology.GetDeviceCount());
+        m_lids.resize(m_topology.GetDeviceCount(), 0);
+        m_isIndexed.resize(m_topology.GetDeviceCount(), false);
+    }
+
+    if (!m_isIndexed[node.id]) {
+        char guid[17];
+        snprintf(guid, sizeof(guid), "%" PRIx64, node.guid);
+
+        auto entry = std::make_pair(std::string(guid), node.id);
+        m_guids.insert(std::lower_bound(m_guids.begin(), m_guids.end(), entry), entry);
+
+        m_isIndexed[node.id] = true;
+    }
+
+    std::string name = ToLower(node.name);
+
+    if (name != m_names[node.id]) {
+        for (uint32_t i = 0; i + 3 <= name.size(); i++) {
+            std::vector<uint32_t> &nodeIds = m_trigrams[GetTrigram(name.c_str() + i)];
+
+            // A trigram, that occurs several times in the same name, is only added once
+            if (nodeIds.empty() || nodeIds.back() != node.id) {
+                nodeIds.push_back(node.id);
+            }
+        }
+
+        m_names[node.id] = std::move(name);
+    }
+
+    UpdateLid(node);
+
+    for (uint32_t portId : node.ports) {
+        UpdateLid(m_topology.GetDevice(portId));
+    }
+}
+
+void SearchIndex::UpdateLid(const Device &device) {
+    if (device.lid != 0 && device.lid != m_lids[device.id]) {
+        m_lidIndex[device.lid].push_back(device.id);
+        m_lids[device.id] = device.lid;
+    }
+}
+
+void SearchIndex::Search(const std::string &query, std::vector<uint32_t> &nodeIds) const {
+    nodeIds.clear();
+
+    std::string text = ToLower(query);
+
+    if (text.empty()) {
+        return;
+    }
+
+    // Descriptions: Only the nodes, that contain the query's rarest trigram, need to be compared
+    if (text.size() >= 3) {
+        static const std::vector<uint32_t> none;
+        const std::vector<uint32_t> *candidates = nullptr;
+
+        for (uint32_t i = 0; i + 3 <= text.size(); i++) {
+            auto entry = m_trigrams.find(GetTrigram(text.c_str() + i));
+            const std::vector<uint32_t> *list = entry == m_trigrams.end() ? &none : &entry->second;
+
+            if (candidates == nullptr || list->size() < candidates->size()) {
+                candidates = list;
+            }
+        }
+
+        for (uint32_t id : *candidates) {
+            if (m_names[id].find(text) != std::string::npos) {
+                nodeIds.push_back(id);
+            }
+        }
+    } else {
+        // Shorter queries have no trigram; They match so many nodes, that a scan is not much slower anyway
+        for (uint32_t id = 0; id < m_names.size(); id++) {
+            if (m_isIndexed[id] && m_names[id].find(text) != std::string::npos) {
+                nodeIds.push_back(id);
+            }
+        }
+    }
+
+    // GUIDs
+    std::string guid = text.compare(0, 2, "0x") == 0 ? text.substr(2) : text;
+    guid.erase(0, std::min(guid.find_first_not_of('0'), guid.size()));
+
+    if (!guid.empty() && guid.size() <= 16 && std::all_of(guid.begin(), guid.end(), ::isxdigit)) {
+        auto entry = std::lower_bound(m_guids.begin(), m_guids.end(), std::make_pair(guid, uint32_t(0)));
+
+        for (; entry != m_guids.end() && entry->first.compare(0, guid.size(), guid) == 0; entry++) {
+            nodeIds.push_back(entry->second);
+        }
+    }
+
+    // LIDs
+    if (text.size() <= 5 && std::all_of(text.begin(), text.end(), ::isdigit)) {
+        unsigned long lid = strtoul(text.c_str(), nullptr, 10);
+        auto entry = lid <= UINT16_MAX ? m_lidIndex.find(static_cast<uint16_t>(lid)) : m_lidIndex.end();
+
+        if (entry != m_lidIndex.end()) {
+            for (uint32_t id : entry->second) {
+                if (m_topology.GetDevice(id).lid == lid) {
+                    nodeIds.push_back(m_topology.GetDevice(id).nodeId);
+                }
+            }
+        }
+    }
+
+    std::sort(nodeIds.begin(), nodeIds.end());
+    nodeIds.erase(std::unique(nodeIds.begin(), nodeIds.end()), nodeIds.end());
+
+    nodeIds.erase(std::remove_if(nodeIds.begin(), nodeIds.end(), [this](uint32_t id) {
+        return !m_topology.GetDevice(id).isPresent;
+    }), nodeIds.end());
+}
+
+std::string SearchIndex::ToLower(const std::string &text) {
+    std::string lower(text);
+
+    for (char &c : lower) {
+        c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+
+    return lower;
+}
+
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_SEARCHINDEX_H
+#define IBSCANNER_SEARCHINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * Finds the nodes of a topology by a part of their description, a prefix of their GUID or the LID of any of their
+ * ports, without searching through all nodes.
+ *
+ * Descriptions are indexed by their trigrams (case-insensitive); A query is only compared to the nodes, that contain
+ * its rarest trigram. GUIDs are kept as sorted hexadecimal strings (without leading zeros), so that a prefix is found
+ * by a binary search.
+ *
+ * The index is not updated automatically. Stale entries of renamed nodes or changed LIDs are kept, but every
+ * candidate is verified against the topology, so they never show up as results.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class SearchIndex {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param topology The topology, whose nodes are indexed
+     */
+    explicit SearchIndex(const Topology &topology);
+
+    /**
+     * Destructor.
+     */
+    ~SearchIndex() = default;
+
+    SearchIndex(const SearchIndex &copy) = delete;
+
+    SearchIndex& operator=(const SearchIndex &other) = delete;
+
+    /**
+     * Add a node and its ports to the index, or update them after the node's description or LIDs have changed.
+     *
+     * Updating a node, that has not changed, is cheap, so all nodes can be updated after a rescan.
+     *
+     * @param node The node
+     */
+    void Update(const Device &node);
+
+    /**
+     * Find all present nodes, whose description contains the query, whose GUID starts with the query
+     * (with or without '0x' and leading zeros) or which have a port with the query as decimal LID.
+     *
+     * @param query The query (case-insensitive)
+     * @param nodeIds Receives the ids of the matching nodes in ascending order
+     */
+    void Search(const std::string &query, std::vector<uint32_t> &nodeIds) const;
+
+private:
+
+    /**
+     * Add a device's LID to the index, if it has changed since the last update.
+     */
+    void UpdateLid(const Device &device);
+
+    /**
+     * Pack the first three characters of a string into a trigram key.
+     */
+    static uint32_t GetTrigram(const char *text) {
+        return static_cast<uint32_t>(static_cast<uint8_t>(text[0])) << 16u |
+               static_cast<uint32_t>(static_cast<uint8_t>(text[1])) << 8u |
+               static_cast<uint8_t>(text[2]);
+    }
+
+    static std::string ToLower(const std::string &text);
+
+private:
+
+    const Topology &m_topology;
+
+    // The indexed state of each device (by id), to detect changes
+    std::vector<std::string> m_names;
+    std::vector<uint16_t> m_lids;
+    std::vector<bool> m_isIndexed;
+
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_trigrams;
+    std::vector<std::pair<std::string, uint32_t>> m_guids;
+    std::unordered_map<uint16_t, std::vector<uint32_t>> m_lidIndex;
+};
+
+}
+
+#endif
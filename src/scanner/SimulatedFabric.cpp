@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "SimulatedFabric.h"
+
+namespace Scanner {
+
+const constexpr uint8_t SimulatedFabric::SWITCH_PORT_COUNT;
+const constexpr uint32_t SimulatedFabric::MAX_LID_COUNT;
+
+/**
+ * The data rate of a 4x EDR link in bytes per second.
+ */
+static const double LINE_RATE = 12.5e9;
+
+/**
+ * The length of the time slots in seconds, for which a port decides whether it is bursting.
+ */
+static const uint64_t BURST_SLOT = 5;
+
+/**
+ * The probability of a port to burst during a time slot.
+ */
+static const double BURST_CHANCE = 0.05;
+
+/**
+ * The probability of a flaky port to lose its link during a time slot.
+ */
+static const double LINK_DOWN_CHANCE = 0.02;
+
+/**
+ * The average amount of symbol errors per second of a flaky port.
+ */
+static const double SYMBOL_ERROR_RATE = 5;
+
+/**
+ * The length of the time slots in seconds, for which a flaky port decides whether it drops out of the fabric.
+ */
+static const uint64_t CHURN_SLOT = 30;
+
+/**
+ * The probability of a flaky port to be absent from the fabric during a time slot.
+ */
+static const double ABSENT_CHANCE = 0.1;
+
+SimulatedFabric::SimulatedFabric(uint32_t switchCount, uint32_t hcaPortCount, double errorRate) :
+        m_switchCount(switchCount),
+        m_hcaPortCount(hcaPortCount),
+        m_errorRate(errorRate),
+        m_random(switchCount * 31u + hcaPortCount) {
+    // Every switch and every HCA port needs its own LID
+    if (static_cast<uint64_t>(switchCount) + hcaPortCount > MAX_LID_COUNT) {
+        throw std::invalid_argument("The simulated fabric needs more LIDs than can be assigned!");
+    }
+
+    m_ports.resize(static_cast<size_t>(switchCount) * SWITCH_PORT_COUNT + hcaPortCount);
+
+    for (Port &port : m_ports) {
+        memset(&port, 0, sizeof(port));
+    }
+}
+
+std::vector<DiscoveredNode> SimulatedFabric::Discover() const {
+    std::vector<DiscoveredNode> nodes;
+    uint64_t elapsed = GetElapsedTime();
+    char name[64];
+
+    nodes.reserve(m_switchCount + m_hcaPortCount);
+
+    // Switches get the LIDs 1 - switchCount, the HCA ports get the following LIDs
+    for (uint32_t i = 0; i < m_switchCount; i++) {
+        auto lid = static_cast<uint16_t>(i + 1);
+
+        snprintf(name, sizeof(name), "sim-switch%04u", i);
+
+        nodes.push_back(DiscoveredNode{0x0008f10500000000ull | i, name, lid, nullptr, {}});
+
+        for (uint8_t portNum = 1; portNum <= SWITCH_PORT_COUNT; portNum++) {
+            if (!IsAbsent(i * SWITCH_PORT_COUNT + portNum - 1u, elapsed)) {
+                nodes.back().ports.push_back(DiscoveredPort{lid, portNum, nullptr});
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < m_hcaPortCount; i++) {
+        auto lid = static_cast<uint16_t>(m_switchCount + i + 1);
+
+        if (IsAbsent(m_switchCount * SWITCH_PORT_COUNT + i, elapsed)) {
+            continue;
+        }
+
+        snprintf(name, sizeof(name), "sim-node%05u HCA-1", i);
+
+        nodes.push_back(DiscoveredNode{0x0002c90300000000ull | i, name, lid, nullptr, {}});
+        nodes.back().ports.push_back(DiscoveredPort{lid, 1, nullptr});
+    }
+
+    return nodes;
+}
+
+void SimulatedFabric::GenerateCounters(uint16_t lid, uint8_t portNum, uint64_t elapsed, PmaResponse &response) {
+    uint32_t first, count;
+
+    for (uint64_t &value : response.values) {
+        value = 0;
+    }
+
+    if (lid == 0 || lid > m_switchCount + m_hcaPortCount) {
+        response.success = false;
+        return;
+    }
+
+    if (lid <= m_switchCount) {
+        // The counters of an entire switch (port number 0xff) are the sums of the counters of all its ports
+        first = (lid - 1u) * SWITCH_PORT_COUNT + (portNum == 0xff ? 0 : portNum - 1u);
+        count = portNum == 0xff ? SWITCH_PORT_COUNT : 1;
+
+        if (portNum != 0xff && (portNum == 0 || portNum > SWITCH_PORT_COUNT)) {
+            response.success = false;
+            return;
+        }
+    } else {
+        first = m_switchCount * SWITCH_PORT_COUNT + (lid - m_switchCount - 1u);
+        count = 1;
+    }
+
+    if (count == 1 && IsAbsent(first, elapsed)) {
+        response.success = false;
+        return;
+    }
+
+    for (uint32_t i = first; i < first + count; i++) {
+        // The counters of absent ports do not add to the counters of their switch
+        if (IsAbsent(i, elapsed)) {
+            continue;
+        }
+
+        Advance(i, elapsed);
+
+        for (uint8_t id = 0; id < PERF_COUNTER_COUNT; id++) {
+            response.values[id] += m_ports[i].values[id];
+        }
+    }
+}
+
+void SimulatedFabric::Advance(uint32_t index, uint64_t elapsed) {
+    Port &port = m_ports[index];
+
+    // Responses are delivered in the order of their due times, but a whole node may have been advanced already
+    if (elapsed <= port.elapsed) {
+        return;
+    }
+
+    double seconds = (elapsed - port.elapsed) / 1000000.0;
+    double second = elapsed / 1000000.0;
+    bool isXmitBurst, isRcvBurst;
+
+    // Larger ports send larger packets
+    double packetSize = 256 << (Hash(index * 7u + 3) % 5);
+
+    auto xmitBytes = static_cast<uint64_t>(GetRate(index, second, true, isXmitBurst) * seconds);
+    auto rcvBytes = static_cast<uint64_t>(GetRate(index, second, false, isRcvBurst) * seconds);
+    auto xmitPkts = static_cast<uint64_t>(xmitBytes / packetSize);
+    auto rcvPkts = static_cast<uint64_t>(rcvBytes / packetSize);
+
+    port.values[XMIT_DATA_BYTES] += xmitBytes;
+    port.values[RCV_DATA_BYTES] += rcvBytes;
+    port.values[XMIT_PKTS] += xmitPkts;
+    port.values[RCV_PKTS] += rcvPkts;
+    port.values[UNICAST_XMIT_PKTS] += xmitPkts - xmitPkts / 20;
+    port.values[UNICAST_RCV_PKTS] += rcvPkts - rcvPkts / 20;
+    port.values[MULTICAST_XMIT_PKTS] += xmitPkts / 20;
+    port.values[MULTICAST_RCV_PKTS] += rcvPkts / 20;
+
+    // A bursting port congests its link, so that it has to wait for credits
+    if (isXmitBurst) {
+        double ticks = seconds * 1000000000 / XMIT_WAIT_TICK;
+
+        port.values[XMIT_WAIT] += static_cast<uint64_t>(ticks * GetChance(index, elapsed));
+    }
+
+    if (GetChance(index, 0x5eed) < m_errorRate) {
+        std::poisson_distribution<uint32_t> symbolErrors(SYMBOL_ERROR_RATE * seconds);
+        uint32_t errors = symbolErrors(m_random);
+
+        port.values[SYMBOL_ERRORS] += errors;
+        port.values[RCV_ERRORS] += errors / 4;
+        port.values[LOCAL_LINK_INTEGRITY_ERRORS] += errors / 8;
+
+        // A link goes down at most once per time slot
+        uint64_t slot = elapsed / 1000000 / BURST_SLOT;
+
+        if (slot != port.elapsed / 1000000 / BURST_SLOT && GetChance(index, ~slot) < LINK_DOWN_CHANCE) {
+            port.values[LINK_DOWNED]++;
+            port.values[LINK_RECOVERIES]++;
+        }
+    }
+
+    port.elapsed = elapsed;
+}
+
+bool SimulatedFabric::IsAbsent(uint32_t index, uint64_t elapsed) const {
+    uint64_t slot = elapsed / 1000000 / CHURN_SLOT;
+
+    return GetChance(index, 0x5eed) < m_errorRate && GetChance(index, slot ^ 0xc4a7) < ABSENT_CHANCE;
+}
+
+double SimulatedFabric::GetRate(uint32_t index, double second, bool isXmit, bool &isBurst) {
+    uint64_t key = index * 2ull + (isXmit ? 1 : 0);
+    auto slot = static_cast<uint64_t>(second) / BURST_SLOT;
+
+    isBurst = GetChance(key, slot) < BURST_CHANCE;
+
+    if (isBurst) {
+        return LINE_RATE * (0.8 + 0.2 * GetChance(key, slot + 1));
+    }
+
+    // 40% of the ports are almost idle, the others have a base load between 10 MB/s and 2 GB/s
+    double base = GetChance(key, 0) < 0.4 ? 1e5 : 1e7 * std::pow(200, GetChance(key, 1));
+
+    // The load changes slowly with a period of one to five minutes
+    double period = 60 + 240 * GetChance(key, 2);
+    double phase = 2 * M_PI * GetChance(key, 3);
+
+    return base * (1 + 0.5 * std::sin(2 * M_PI * second / period + phase));
+}
+
+uint64_t SimulatedFabric::Hash(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+
+    return value ^ (value >> 31);
+}
+
+double SimulatedFabric::GetChance(uint64_t a, uint64_t b) {
+    return (Hash(Hash(a) ^ b) >> 11) / static_cast<double>(1ull << 53);
+}
+
+}
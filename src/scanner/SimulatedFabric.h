@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_SIMULATEDFABRIC_H
+#define IBSCANNER_SIMULATEDFABRIC_H
+
+#include <random>
+#include <vector>
+#include "FakePmaTransport.h"
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * A synthetic fabric of switches and HCAs, whose performance management agents are simulated in-process.
+ *
+ * The devices are discovered like the devices of a scanned fabric and their counters are queried via the
+ * PmaQueryEngine, so that the rescans, the menu, the sampler and all windows go through the same code paths as
+ * with real hardware. Thus, the scanner can be load-tested with fabrics far larger than any lab.
+ *
+ * Every port has its own base load, which changes slowly over time. Randomly chosen ports run at line rate for a few
+ * seconds (bursts), which also lets their XmitWait counter grow. A configurable fraction of the ports is flaky and
+ * accumulates symbol errors, receive errors and occasional link downs; Now and then, a flaky port drops out of the
+ * fabric entirely. The model only depends on the port and the time, so a simulation with the same size always
+ * behaves the same.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class SimulatedFabric : public FakePmaTransport {
+
+public:
+    /**
+     * The amount of ports of every simulated switch.
+     */
+    static const constexpr uint8_t SWITCH_PORT_COUNT = 36;
+
+    /**
+     * The largest amount of LIDs, that can be assigned (unicast LIDs are 0x0001 - 0xbfff).
+     */
+    static const constexpr uint32_t MAX_LID_COUNT = 0xbfff;
+
+    /**
+     * Constructor.
+     *
+     * Throws std::invalid_argument, if the fabric needs more LIDs than can be assigned.
+     *
+     * @param switchCount The amount of switches
+     * @param hcaPortCount The amount of HCA ports (every HCA has a single port)
+     * @param errorRate The fraction of ports, that are flaky (0.0 - 1.0)
+     */
+    SimulatedFabric(uint32_t switchCount, uint32_t hcaPortCount, double errorRate = 0.01);
+
+    /**
+     * Destructor.
+     */
+    ~SimulatedFabric() override = default;
+
+    /**
+     * Discover the simulated fabric like Detector discovers a real one.
+     *
+     * Flaky ports drop out of the fabric for a while now and then (an HCA disappears with its only port), so that
+     * rescans find nodes and ports to add and remove. While a port is absent, its counters cannot be queried.
+     *
+     * @return The present nodes and ports (without Detector objects)
+     */
+    std::vector<DiscoveredNode> Discover() const;
+
+protected:
+    /**
+     * Overriding function from FakePmaTransport.
+     */
+    void GenerateCounters(uint16_t lid, uint8_t portNum, uint64_t elapsed, PmaResponse &response) override;
+
+private:
+    /**
+     * The counters of a single port, which are advanced each time the port is queried.
+     */
+    struct Port {
+        uint64_t values[PERF_COUNTER_COUNT];
+
+        /**
+         * The time in microseconds, up to which the counters have been advanced.
+         */
+        uint64_t elapsed;
+    };
+
+    /**
+     * Advance the counters of a port to a point in time.
+     *
+     * @param index The port's index
+     * @param elapsed The time in microseconds since the simulation has been started
+     */
+    void Advance(uint32_t index, uint64_t elapsed);
+
+    /**
+     * Check, if a port has dropped out of the fabric at a point in time.
+     *
+     * @param index The port's index
+     * @param elapsed The time in microseconds since the simulation has been started
+     */
+    bool IsAbsent(uint32_t index, uint64_t elapsed) const;
+
+    /**
+     * Get the current transmit or receive rate of a port in bytes per second.
+     *
+     * @param index The port's index
+     * @param second The current time in seconds since the simulation has been started
+     * @param isXmit true for the transmit rate, false for the receive rate
+     * @param isBurst Set to true, if the port is bursting
+     */
+    static double GetRate(uint32_t index, double second, bool isXmit, bool &isBurst);
+
+    /**
+     * Map a value to a well-distributed pseudo random number (splitmix64).
+     *
+     * @param value The value
+     */
+    static uint64_t Hash(uint64_t value);
+
+    /**
+     * Get a pseudo random number between 0.0 and 1.0, that only depends on the given values.
+     *
+     * @param a The first value
+     * @param b The second value
+     */
+    static double GetChance(uint64_t a, uint64_t b);
+
+private:
+
+    uint32_t m_switchCount;
+    uint32_t m_hcaPortCount;
+    double m_errorRate;
+
+    /**
+     * The switch ports precede the HCA ports.
+     */
+    std::vector<Port> m_ports;
+
+    std::minstd_rand m_random;
+};
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cstdio>
+#include "StatsWindow.h"
+
+namespace Scanner {
+
+StatsWindow::StatsWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, const Sampler &sampler,
+                         const Instrumentation &instrumentation) :
+        Window(posX, posY, width, height, "Stats"),
+        m_sampler(sampler),
+        m_instrumentation(instrumentation),
+        m_lastQueryCount(instrumentation.queryCount),
+        m_lastRateTime(std::chrono::steady_clock::now()),
+        m_queryRate(0) {
+
+}
+
+void StatsWindow::FormatDuration(char *buffer, size_t size, uint64_t duration) {
+    if (duration < 1000) {
+        snprintf(buffer, size, "%u ns", static_cast<uint32_t>(duration));
+    } else if (duration < 1000000) {
+        snprintf(buffer, size, "%.1f us", duration / 1000.0);
+    } else if (duration < 1000000000) {
+        snprintf(buffer, size, "%.1f ms", duration / 1000000.0);
+    } else {
+        snprintf(buffer, size, "%.2f s", duration / 1000000000.0);
+    }
+}
+
+void StatsWindow::FormatHistogram(char *buffer, size_t size, const char *name, const LatencyHistogram &histogram) {
+    static const double percentiles[] = { 50, 90, 99 };
+    char columns[4][16];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        FormatDuration(columns[i], sizeof(columns[i]), histogram.GetPercentile(percentiles[i]));
+    }
+
+    FormatDuration(columns[3], sizeof(columns[3]), histogram.GetMax());
+
+    snprintf(buffer, size, "%-16s %10llu %10s %10s %10s %10s", name,
+             static_cast<unsigned long long>(histogram.GetCount()), columns[0], columns[1], columns[2], columns[3]);
+}
+
+void StatsWindow::DrawContent() {
+    Window::DrawContent();
+
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastRateTime).count();
+    uint64_t queryCount = m_instrumentation.queryCount;
+
+    // The window is redrawn after every sweep, so the rate is averaged over at least a second to keep it stable
+    if (elapsed >= 1000) {
+        m_queryRate = (queryCount - m_lastQueryCount) * 1000.0 / elapsed;
+        m_lastQueryCount = queryCount;
+        m_lastRateTime = now;
+    }
+
+    char line[256];
+    uint32_t y = 0;
+
+    snprintf(line, sizeof(line), "%-16s %10s %10s %10s %10s %10s", "", "Count", "p50", "p90", "p99", "Max");
+    PrintLineAt(y++, line, A_BOLD);
+
+    FormatHistogram(line, sizeof(line), "Query RTT", m_instrumentation.queryRoundTrip);
+    PrintLineAt(y++, line);
+
+    FormatHistogram(line, sizeof(line), "Sweep interval", m_instrumentation.sweepInterval);
+    PrintLineAt(y++, line);
+
+    FormatHistogram(line, sizeof(line), "Sweep duration", m_instrumentation.sweepDuration);
+    PrintLineAt(y++, line);
+
+    FormatHistogram(line, sizeof(line), "Frame time", m_instrumentation.frameTime);
+    PrintLineAt(y++, line);
+
+    FormatHistogram(line, sizeof(line), "Input latency", m_instrumentation.inputLatency);
+    PrintLineAt(y++, line);
+
+    PrintLineAt(y++, "");
+
+    snprintf(line, sizeof(line), "Queries: %llu (%.1f/s), Timeouts: %llu, Errors: %llu",
+             static_cast<unsigned long long>(queryCount), m_queryRate,
+             static_cast<unsigned long long>(m_instrumentation.timeoutCount.load()),
+             static_cast<unsigned long long>(m_instrumentation.errorCount.load()));
+    PrintLineAt(y++, line);
+
+    snprintf(line, sizeof(line), "Requested interval: %u ms", m_sampler.GetRefreshInterval());
+    PrintLineAt(y++, line);
+
+    snprintf(line, sizeof(line), "Resident memory: %.1f MiB",
+             Instrumentation::GetResidentMemory() / (1024.0 * 1024.0));
+    PrintLineAt(y++, line);
+
+    for (uint32_t height = GetHeight(); y < height; y++) {
+        PrintLineAt(y, "");
+    }
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_STATSWINDOW_H
+#define IBSCANNER_STATSWINDOW_H
+
+#include <chrono>
+#include <curses/Window.h>
+#include "Instrumentation.h"
+#include "Sampler.h"
+
+namespace Scanner {
+
+/**
+ * Window, which shows the scanner's own measurements.
+ *
+ * For every histogram of the instrumentation, the amount of values and their percentiles are shown. Together with the
+ * query rate, the timeouts and the resident memory, this shows whether the fabric, the MAD layer or the UI is slow.
+ * Drawing only reads the lock-free histograms, so the window can be shown at any time.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class StatsWindow : public Curses::Window {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param posX X-coordinate of upper left corner
+     * @param posY Y-coordinate of upper left corner
+     * @param width The width
+     * @param height The height
+     * @param sampler The sampler, whose requested refresh interval is shown
+     * @param instrumentation The measurements
+     */
+    StatsWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, const Sampler &sampler,
+                const Instrumentation &instrumentation);
+
+    /**
+     * Destructor.
+     */
+    ~StatsWindow() override = default;
+
+private:
+    /**
+     * Format a duration with a fitting unit.
+     *
+     * @param buffer Receives the formatted duration
+     * @param size The buffer's size
+     * @param duration The duration in nanoseconds
+     */
+    static void FormatDuration(char *buffer, size_t size, uint64_t duration);
+
+    /**
+     * Format the percentiles of a histogram as a single line.
+     *
+     * @param buffer Receives the line
+     * @param size The buffer's size
+     * @param name The histogram's name
+     * @param histogram The histogram
+     */
+    static void FormatHistogram(char *buffer, size_t size, const char *name, const LatencyHistogram &histogram);
+
+    /**
+     * Overriding function from Window.
+     */
+    void DrawContent() override;
+
+private:
+
+    const Sampler &m_sampler;
+
+    const Instrumentation &m_instrumentation;
+
+    /**
+     * The amount of queries at the time, when the query rate has been calculated last.
+     */
+    uint64_t m_lastQueryCount;
+
+    std::chrono::steady_clock::time_point m_lastRateTime;
+
+    double m_queryRate;
+};
+
+}
+
+#endif
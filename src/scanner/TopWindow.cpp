@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "CounterDelta.h"
+#include "TopWindow.h"
+
+namespace Scanner {
+
+/**
+ * The maximum amount of ports, that are ranked for each sort key.
+ */
+static const uint32_t MAX_ROWS = 500;
+
+static const char *sortKeyNames[TopWindow::SORT_KEY_COUNT] = {
+        "Xmit Bytes/s",
+        "Rcv Bytes/s",
+        "Xmit Pkts/s",
+        "Rcv Pkts/s",
+        "Errors/s",
+        "Symbol Errors/s",
+        "Link Downed/s",
+        "Link Recoveries/s",
+        "Rcv Errors/s",
+        "Rcv Remote Physical Errors/s",
+        "Rcv Switch Relay Errors/s",
+        "Xmit Discards/s",
+        "Xmit Constraint Errors/s",
+        "Rcv Constraint Errors/s",
+        "Local Link Integrity Errors/s",
+        "Excessive Buffer Overrun Errors/s",
+        "VL15 Dropped/s"
+};
+
+static const char *columnNames[TopWindow::SORT_KEY_COUNT] = {
+        "Xmit",
+        "Rcv",
+        "Xmit Pkts",
+        "Rcv Pkts",
+        "Errors",
+        "Symbol",
+        "LinkDowned",
+        "LinkRecov",
+        "RcvErrors",
+        "RcvRemPhys",
+        "RcvSwRelay",
+        "XmitDiscard",
+        "XmitConstr",
+        "RcvConstr",
+        "LinkIntegr",
+        "BufOverrun",
+        "VL15Dropped"
+};
+
+/**
+ * The amount of rate columns; The last one shows the sum of all errors or the error counter, that is sorted by.
+ */
+static const uint8_t COLUMN_COUNT = TopWindow::ERRORS + 1;
+
+/**
+ * The width of a single rate column (including the separating space).
+ */
+static const uint32_t COLUMN_WIDTH = 13;
+
+TopWindow::PortListener::PortListener(TopWindow &window, uint32_t index) :
+        m_window(window),
+        m_index(index) {
+
+}
+
+void TopWindow::PortListener::OnSample(const CounterSample &sample) {
+    Port &port = m_window.m_ports[m_index];
+    uint64_t values[SORT_KEY_COUNT] = {
+            sample.values[XMIT_DATA_BYTES],
+            sample.values[RCV_DATA_BYTES],
+            sample.values[XMIT_PKTS],
+            sample.values[RCV_PKTS]
+    };
+
+    values[ERRORS] = CounterDelta::GetErrorSum(sample);
+
+    for (uint8_t id = SYMBOL_ERRORS; id <= VL15_DROPPED; id++) {
+        values[FIRST_ERROR_COUNTER + id - SYMBOL_ERRORS] = sample.values[id];
+    }
+
+    // Only the summed up values are kept, so the rates are not calculated via CounterDelta::Calculate()
+    if (port.hasValues && sample.timestamp > port.timestamp) {
+        double elapsed = (sample.timestamp - port.timestamp) / 1000000000.0;
+
+        for (uint8_t key = 0; key < SORT_KEY_COUNT; key++) {
+            port.row.rates[key] = CounterDelta::GetDelta(port.values[key], values[key]) / elapsed;
+        }
+
+        port.hasRates = true;
+    }
+
+    memcpy(port.values, values, sizeof(port.values));
+    port.timestamp = sample.timestamp;
+    port.hasValues = true;
+}
+
+void TopWindow::PortListener::OnSampleError(const char *message) {
+    Port &port = m_window.m_ports[m_index];
+
+    port.hasValues = false;
+    port.hasRates = false;
+}
+
+TopWindow::TopWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, Sampler &sampler,
+                     const Topology &topology, std::function<void(const Device*)> selectHandler) :
+        SampledWindow(posX, posY, width, height, "", sampler),
+        m_topology(topology),
+        m_selectHandler(std::move(selectHandler)),
+        m_sortKey(XMIT_BYTES),
+        m_highlight(0),
+        m_scrollOffset(0) {
+    for (uint32_t i = 0; i < topology.GetDeviceCount(); i++) {
+        const Device &device = topology.GetDevice(i);
+
+        if (!device.IsNode()) {
+            AddPort(&device);
+        }
+    }
+
+    m_sampler.AddSweepCallback([this] { OnSweep(); });
+
+    SetTitle((std::string("Top Ports by ") + sortKeyNames[m_sortKey]).c_str());
+}
+
+TopWindow::~TopWindow() {
+    SetActive(false);
+
+    for (PortListener *listener : m_listeners) {
+        delete listener;
+    }
+}
+
+void TopWindow::AddPort(const Device *port) {
+    Port state{};
+    state.row.device = port;
+
+    m_listeners.push_back(new PortListener(*this, static_cast<uint32_t>(m_ports.size())));
+    m_ports.push_back(state);
+
+    if (m_isActive) {
+        m_sampler.Subscribe(m_listeners.back(), port);
+    }
+}
+
+void TopWindow::ResetRates() {
+    for (Port &port : m_ports) {
+        port.hasValues = false;
+        port.hasRates = false;
+    }
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>());
+}
+
+void TopWindow::ForEachListener(const std::function<void(Sampler::Listener*, const Device*)> &function) {
+    for (uint32_t i = 0; i < m_ports.size(); i++) {
+        function(m_listeners[i], m_ports[i].row.device);
+    }
+}
+
+void TopWindow::OnSweep() {
+    if (!m_isActive) {
+        return;
+    }
+
+    std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+    snapshot->rankedCount = 0;
+    snapshot->errorCount = 0;
+
+    for (const Port &port : m_ports) {
+        if (!port.row.device->isPresent) {
+            continue;
+        }
+
+        if (port.hasRates) {
+            snapshot->rankedCount++;
+        } else if (!port.hasValues) {
+            snapshot->errorCount++;
+        }
+    }
+
+    for (uint8_t key = 0; key < SORT_KEY_COUNT; key++) {
+        Rank(static_cast<SortKey>(key), snapshot->rows[key]);
+    }
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(snapshot));
+
+    Invalidate();
+}
+
+void TopWindow::Rank(SortKey key, std::vector<Row> &rows) {
+    // Ports with equal rates are ordered by their id, so that idle ports do not swap places on every sweep
+    auto isBusier = [key](const Row &a, const Row &b) {
+        return a.rates[key] > b.rates[key] || (a.rates[key] == b.rates[key] && a.device->id < b.device->id);
+    };
+
+    rows.reserve(std::min(MAX_ROWS, static_cast<uint32_t>(m_ports.size())));
+
+    // The heap's front is the least busy of the ports selected so far, so every port costs at most O(log MAX_ROWS)
+    for (const Port &port : m_ports) {
+        if (!port.hasRates || !port.row.device->isPresent) {
+            continue;
+        }
+
+        if (rows.size() < MAX_ROWS) {
+            rows.push_back(port.row);
+            std::push_heap(rows.begin(), rows.end(), isBusier);
+        } else if (isBusier(port.row, rows.front())) {
+            std::pop_heap(rows.begin(), rows.end(), isBusier);
+            rows.back() = port.row;
+            std::push_heap(rows.begin(), rows.end(), isBusier);
+        }
+    }
+
+    std::sort_heap(rows.begin(), rows.end(), isBusier);
+}
+
+void TopWindow::DrawContent() {
+    Window::DrawContent();
+
+    m_shownSnapshot = std::atomic_load(&m_snapshot);
+
+    uint32_t width = GetWidth();
+    uint32_t height = GetHeight();
+    uint32_t nameWidth = width > COLUMN_COUNT * COLUMN_WIDTH + 10 ? width - COLUMN_COUNT * COLUMN_WIDTH : 10;
+    char line[512];
+
+    if (m_shownSnapshot == nullptr) {
+        PrintLineAt(0, "Waiting for the first sweep...");
+
+        for (uint32_t i = 1; i < height; i++) {
+            PrintLineAt(i, "");
+        }
+
+        return;
+    }
+
+    const std::vector<Row> &rows = m_shownSnapshot->rows[m_sortKey];
+
+    // When sorting by a single error counter, its rates are shown instead of the sum of all errors
+    uint8_t columnKeys[COLUMN_COUNT] = { XMIT_BYTES, RCV_BYTES, XMIT_PACKETS, RCV_PACKETS,
+                                         m_sortKey >= ERRORS ? m_sortKey : ERRORS };
+
+    snprintf(line, sizeof(line), "%u ports ranked, %u unreachable", m_shownSnapshot->rankedCount,
+             m_shownSnapshot->errorCount);
+    PrintLineAt(0, line);
+
+    int length = snprintf(line, sizeof(line), "%-*.*s", nameWidth, nameWidth, "Port");
+
+    for (uint8_t column = 0; column < COLUMN_COUNT && length < static_cast<int>(sizeof(line)); column++) {
+        uint8_t key = columnKeys[column];
+        char header[COLUMN_WIDTH];
+        snprintf(header, sizeof(header), "%s%s", key == m_sortKey ? "*" : "", columnNames[key]);
+
+        length += snprintf(line + length, sizeof(line) - length, " %*s", COLUMN_WIDTH - 1, header);
+    }
+
+    PrintLineAt(1, line, A_BOLD);
+
+    // The ranking may have become shorter since the last frame
+    if (m_highlight + m_scrollOffset >= rows.size()) {
+        m_highlight = 0;
+        m_scrollOffset = 0;
+    }
+
+    for (uint32_t i = 0; i + 2 < height; i++) {
+        if (i + m_scrollOffset >= rows.size()) {
+            PrintLineAt(i + 2, "");
+            continue;
+        }
+
+        const Row &row = rows[i + m_scrollOffset];
+        std::string name = m_topology.GetDevice(row.device->nodeId).name + " / " + row.device->name;
+
+        length = snprintf(line, sizeof(line), "%-*.*s", nameWidth, nameWidth, name.c_str());
+
+        for (uint8_t column = 0; column < COLUMN_COUNT && length < static_cast<int>(sizeof(line)); column++) {
+            uint8_t key = columnKeys[column];
+            char rate[32];
+            CounterDelta::FormatRate(rate, sizeof(rate), row.rates[key], key < XMIT_PACKETS ? "B/s" : "/s");
+
+            length += snprintf(line + length, sizeof(line) - length, " %*s", COLUMN_WIDTH - 1, rate);
+        }
+
+        PrintLineAt(i + 2, line, i == m_highlight ? A_REVERSE : A_NORMAL);
+    }
+}
+
+void TopWindow::HandleKey(int c) {
+    uint32_t rowCount = m_shownSnapshot == nullptr ? 0 : m_shownSnapshot->rows[m_sortKey].size();
+    uint32_t pageSize = GetHeight() > 3 ? GetHeight() - 2 : 1;
+    uint32_t position = m_highlight + m_scrollOffset;
+
+    switch (c) {
+        case KEY_UP:
+            position = position > 0 ? position - 1 : 0;
+            break;
+        case KEY_DOWN:
+            position++;
+            break;
+        case KEY_PPAGE:
+            position = position > pageSize ? position - pageSize : 0;
+            break;
+        case KEY_NPAGE:
+            position += pageSize;
+            break;
+        case KEY_HOME:
+            position = 0;
+            break;
+        case KEY_END:
+            position = rowCount;
+            break;
+        case 's':
+        case 'S':
+            m_sortKey = static_cast<SortKey>((m_sortKey + (c == 's' ? 1 : SORT_KEY_COUNT - 1)) % SORT_KEY_COUNT);
+            position = 0;
+
+            SetTitle((std::string("Top Ports by ") + sortKeyNames[m_sortKey]).c_str());
+            break;
+        case KEY_ENTER:
+        case 10:
+            if (position < rowCount) {
+                m_selectHandler(m_shownSnapshot->rows[m_sortKey][position].device);
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (position >= rowCount) {
+        position = rowCount > 0 ? rowCount - 1 : 0;
+    }
+
+    ScrollTo(position, m_scrollOffset, pageSize);
+
+    m_highlight = position - m_scrollOffset;
+
+    Window::HandleKey(c);
+
+    Invalidate();
+}
+
+}
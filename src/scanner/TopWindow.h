@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_TOPWINDOW_H
+#define IBSCANNER_TOPWINDOW_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "SampledWindow.h"
+
+namespace Scanner {
+
+/**
+ * Window, which ranks all ports of the fabric by their throughput, packet rate, error rate or the rate of a single
+ * error counter (like top).
+ *
+ * While the window is active, every port is subscribed to the sampler. After each sweep, the sampling thread
+ * selects the busiest ports for every sort key with a bounded heap and publishes the rankings as an immutable
+ * snapshot. Drawing only formats the visible rows of the snapshot, so that the UI stays responsive, no matter how
+ * many ports the fabric has. Switching the sort key does not require a new sweep.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class TopWindow : public SampledWindow {
+
+public:
+    /**
+     * The rates, that the ports can be ranked by.
+     */
+    enum SortKey : uint8_t {
+        XMIT_BYTES,
+        RCV_BYTES,
+        XMIT_PACKETS,
+        RCV_PACKETS,
+
+        /**
+         * The sum of all error counters.
+         */
+        ERRORS,
+
+        /**
+         * The keys of the single error counters (SYMBOL_ERRORS to VL15_DROPPED) follow in the order of their ids.
+         */
+        FIRST_ERROR_COUNTER,
+        SORT_KEY_COUNT = FIRST_ERROR_COUNTER + VL15_DROPPED - SYMBOL_ERRORS + 1
+    };
+
+    /**
+     * Constructor.
+     *
+     * Must be called before the sampler is started.
+     *
+     * @param posX X-coordinate of upper left corner
+     * @param posY Y-coordinate of upper left corner
+     * @param width The width
+     * @param height The height
+     * @param sampler The sampler, which refreshes the counters
+     * @param topology The topology, whose ports are ranked
+     * @param selectHandler Called with the highlighted port, when Enter is pressed
+     */
+    TopWindow(uint32_t posX, uint32_t posY, uint32_t width, uint32_t height, Sampler &sampler,
+              const Topology &topology, std::function<void(const Device*)> selectHandler);
+
+    /**
+     * Destructor.
+     */
+    ~TopWindow() override;
+
+    /**
+     * Add a port, that has been found by a rescan.
+     *
+     * Must only be called, while the sampler is paused.
+     *
+     * @param port The port
+     */
+    void AddPort(const Device *port);
+
+    /**
+     * Overriding function from Window.
+     */
+    void HandleKey(int c) override;
+
+private:
+    /**
+     * Receives the samples of a single port.
+     */
+    class PortListener : public Sampler::Listener {
+
+    public:
+        PortListener(TopWindow &window, uint32_t index);
+
+        void OnSample(const CounterSample &sample) override;
+
+        void OnSampleError(const char *message) override;
+
+    private:
+
+        TopWindow &m_window;
+        uint32_t m_index;
+    };
+
+    /**
+     * The rates of a single port.
+     */
+    struct Row {
+        const Device *device;
+        double rates[SORT_KEY_COUNT];
+    };
+
+    /**
+     * The state of a single port (only accessed by the sampling thread).
+     */
+    struct Port {
+        Row row;
+        uint64_t values[SORT_KEY_COUNT];
+        uint64_t timestamp;
+        bool hasValues;
+        bool hasRates;
+    };
+
+    /**
+     * The rankings of a sweep.
+     *
+     * Snapshots are never modified after they have been published.
+     */
+    struct Snapshot {
+        std::vector<Row> rows[SORT_KEY_COUNT];
+        uint32_t rankedCount;
+        uint32_t errorCount;
+    };
+
+    /**
+     * Called by the sampler after each sweep.
+     */
+    void OnSweep();
+
+    /**
+     * Select the busiest ports for a sort key.
+     *
+     * @param key The sort key
+     * @param rows Receives the ports, sorted by descending rate
+     */
+    void Rank(SortKey key, std::vector<Row> &rows);
+
+    /**
+     * Overriding function from SampledWindow.
+     */
+    void ResetRates() override;
+
+    /**
+     * Overriding function from SampledWindow.
+     */
+    void ForEachListener(const std::function<void(Sampler::Listener*, const Device*)> &function) override;
+
+    /**
+     * Overriding function from Window.
+     */
+    void DrawContent() override;
+
+private:
+
+    const Topology &m_topology;
+
+    std::function<void(const Device*)> m_selectHandler;
+
+    std::vector<PortListener*> m_listeners;
+    std::vector<Port> m_ports;
+
+    /**
+     * Written by the sampler thread and read by the UI thread.
+     * Must only be accessed via std::atomic_load()/std::atomic_store().
+     */
+    std::shared_ptr<const Snapshot> m_snapshot;
+
+    /**
+     * The snapshot, that is shown (only accessed by the UI thread).
+     */
+    std::shared_ptr<const Snapshot> m_shownSnapshot;
+
+    SortKey m_sortKey;
+
+    uint32_t m_highlight;
+    uint32_t m_scrollOffset;
+};
+
+}
+
+#endif
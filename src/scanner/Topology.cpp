@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cstdio>
+#include <detector/IbFabric.h>
+#include "Topology.h"
+
+namespace Scanner {
+
+Topology::~Topology() {
+    for (const Device &device : m_devices) {
+        delete device.diagPerfCounter;
+    }
+}
+
+std::vector<DiscoveredNode> Topology::ListNodes(Detector::IbFabric &fabric) {
+    std::vector<DiscoveredNode> nodes;
+
+    nodes.reserve(fabric.GetNodes().size());
+
+    for (Detector::IbNode *node : fabric.GetNodes()) {
+        uint16_t lid = node->GetPorts().empty() ? 0 : node->GetPorts()[0]->GetLid();
+
+        nodes.push_back(DiscoveredNode{node->GetGuid(), node->GetDescription(), lid, node, {}});
+
+        for (Detector::IbPort *port : node->GetPorts()) {
+            nodes.back().ports.push_back(DiscoveredPort{port->GetLid(), port->GetNum(), port});
+        }
+    }
+
+    return nodes;
+}
+
+Device &Topology::AddNode(uint64_t guid, const std::string &description, uint16_t lid,
+                          Detector::IbPerfCounter *perfCounter, Detector::IbDiagPerfCounter *diagPerfCounter) {
+    auto id = static_cast<uint32_t>(m_devices.size());
+
+    m_devices.push_back(Device{id, id, guid, lid, 0xff, description, {}, perfCounter, diagPerfCounter, true});
+    m_nodes.push_back(id);
+    m_nodeIndex[guid] = id;
+
+    return m_devices.back();
+}
+
+Device &Topology::AddPort(uint32_t nodeId, uint16_t lid, uint8_t portNum, Detector::IbPerfCounter *perfCounter,
+                          Detector::IbDiagPerfCounter *diagPerfCounter) {
+    auto id = static_cast<uint32_t>(m_devices.size());
+    char name[10];
+
+    snprintf(name, sizeof(name), "Port %u", static_cast<unsigned>(portNum));
+
+    m_devices.push_back(Device{id, nodeId, m_devices[nodeId].guid, lid, portNum, name, {}, perfCounter,
+                               diagPerfCounter, true});
+    m_devices[nodeId].ports.push_back(id);
+
+    return m_devices.back();
+}
+
+bool Topology::UpdateDevice(Device &device, uint16_t lid, Detector::IbPerfCounter *perfCounter) {
+    bool changed = device.lid != lid || !device.isPresent;
+
+    device.lid = lid;
+    device.perfCounter = perfCounter;
+    device.isPresent = true;
+
+    return changed;
+}
+
+void Topology::SetDiagPerfCounter(Device &device, Detector::IbDiagPerfCounter *diagPerfCounter) {
+    if (device.diagPerfCounter != diagPerfCounter) {
+        delete device.diagPerfCounter;
+        device.diagPerfCounter = diagPerfCounter;
+    }
+}
+
+void Topology::RemoveDevice(Device &device) {
+    device.isPresent = false;
+    device.perfCounter = nullptr;
+
+    // The local device may have been unplugged, so its diagnostic counters are not usable anymore
+    SetDiagPerfCounter(device, nullptr);
+
+    for (uint32_t portId : device.ports) {
+        RemoveDevice(m_devices[portId]);
+    }
+}
+
+Device *Topology::FindNode(uint64_t guid) {
+    auto node = m_nodeIndex.find(guid);
+
+    return node == m_nodeIndex.end() ? nullptr : &m_devices[node->second];
+}
+
+Device *Topology::FindPort(const Device &node, uint8_t portNum) {
+    for (uint32_t portId : node.ports) {
+        if (m_devices[portId].portNum == portNum) {
+            return &m_devices[portId];
+        }
+    }
+
+    return nullptr;
+}
+
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_TOPOLOGY_H
+#define IBSCANNER_TOPOLOGY_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <detector/IbPerfCounter.h>
+#include <detector/IbDiagPerfCounter.h>
+
+namespace Detector {
+
+class IbFabric;
+
+}
+
+namespace Scanner {
+
+/**
+ * A node or a single port of a node, whose counters can be sampled.
+ */
+struct Device {
+
+    /**
+     * The device's index inside its topology.
+     */
+    uint32_t id;
+
+    /**
+     * The id of the node, that the device belongs to (the device's own id, if it is a node).
+     */
+    uint32_t nodeId;
+
+    uint64_t guid;
+    uint16_t lid;
+
+    /**
+     * The port number (0xff for an entire node).
+     */
+    uint8_t portNum;
+
+    /**
+     * The node description or 'Port <n>'.
+     */
+    std::string name;
+
+    /**
+     * The ids of a node's ports (empty for ports).
+     */
+    std::vector<uint32_t> ports;
+
+    /**
+     * The Detector object, that provides the counters (nullptr, if the device is not part of a scanned fabric).
+     */
+    Detector::IbPerfCounter *perfCounter;
+
+    /**
+     * The diagnostic counters of a local device (nullptr for remote devices).
+     */
+    Detector::IbDiagPerfCounter *diagPerfCounter;
+
+    /**
+     * false, if the device has disappeared from the fabric. Removed devices are kept, so that they can be revived
+     * with their history and window assignments, if they reappear.
+     */
+    bool isPresent;
+
+    bool IsNode() const {
+        return portNum == 0xff;
+    }
+};
+
+/**
+ * A port, that has been found by discovering the fabric.
+ */
+struct DiscoveredPort {
+    uint16_t lid;
+    uint8_t portNum;
+
+    /**
+     * The Detector object, that provides the counters (nullptr, if the fabric is not scanned via Detector).
+     */
+    Detector::IbPerfCounter *perfCounter;
+};
+
+/**
+ * A node, that has been found by discovering the fabric.
+ *
+ * Discoveries are described by lists of these nodes, so that a scanned fabric and a simulated one can be applied to
+ * a topology the same way.
+ */
+struct DiscoveredNode {
+    uint64_t guid;
+    std::string description;
+
+    /**
+     * The LID of the node's first port.
+     */
+    uint16_t lid;
+
+    /**
+     * The Detector object, that provides the counters (nullptr, if the fabric is not scanned via Detector).
+     */
+    Detector::IbPerfCounter *perfCounter;
+
+    std::vector<DiscoveredPort> ports;
+};
+
+/**
+ * The nodes and ports known to the scanner.
+ *
+ * The scanner works with this table instead of Detector's fabric, so that the same user interface can be used for
+ * devices, which are not backed by Detector objects (e.g. when replaying a recording).
+ *
+ * Devices are only ever added and marked as removed, but never deleted. They are stored in a deque, so that pointers
+ * to them stay valid for the lifetime of the topology.
+ * The devices' Detector objects may only be changed, while the sampler is paused.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class Topology {
+
+public:
+    /**
+     * Constructor.
+     */
+    Topology() = default;
+
+    /**
+     * Destructor.
+     *
+     * Deletes all diagnostic performance counters, that have been passed to the topology.
+     */
+    ~Topology();
+
+    Topology(const Topology &copy) = delete;
+
+    Topology& operator=(const Topology &other) = delete;
+
+    /**
+     * List the nodes and ports of a fabric, that has been scanned by Detector.
+     *
+     * @param fabric The fabric, which must outlive the returned nodes' Detector objects
+     *
+     * @return The nodes in Detector's order
+     */
+    static std::vector<DiscoveredNode> ListNodes(Detector::IbFabric &fabric);
+
+    /**
+     * Add a node.
+     *
+     * @param guid The node GUID
+     * @param description The node description
+     * @param lid The LID of the node's first port
+     * @param perfCounter The Detector object (may be nullptr)
+     * @param diagPerfCounter The diagnostic performance counter (may be nullptr); Is deleted by the topology
+     *
+     * @return The new device
+     */
+    Device &AddNode(uint64_t guid, const std::string &description, uint16_t lid,
+                    Detector::IbPerfCounter *perfCounter = nullptr,
+                    Detector::IbDiagPerfCounter *diagPerfCounter = nullptr);
+
+    /**
+     * Add a port to a node.
+     *
+     * @param nodeId The node's id
+     * @param lid The port's LID
+     * @param portNum The port number
+     * @param perfCounter The Detector object (may be nullptr)
+     * @param diagPerfCounter The diagnostic performance counter (may be nullptr); Is deleted by the topology
+     *
+     * @return The new device
+     */
+    Device &AddPort(uint32_t nodeId, uint16_t lid, uint8_t portNum, Detector::IbPerfCounter *perfCounter = nullptr,
+                    Detector::IbDiagPerfCounter *diagPerfCounter = nullptr);
+
+    /**
+     * Update a device, which has been found again by a rescan, and mark it as present.
+     *
+     * @param device The device
+     * @param lid The new LID
+     * @param perfCounter The new Detector object
+     *
+     * @return true, if the LID has changed or the device has been absent before
+     */
+    bool UpdateDevice(Device &device, uint16_t lid, Detector::IbPerfCounter *perfCounter);
+
+    /**
+     * Set the diagnostic performance counter of a device.
+     *
+     * @param device The device
+     * @param diagPerfCounter The diagnostic performance counter; Is deleted by the topology
+     */
+    void SetDiagPerfCounter(Device &device, Detector::IbDiagPerfCounter *diagPerfCounter);
+
+    /**
+     * Mark a device (and all ports of a node) as removed from the fabric and drop its counters.
+     *
+     * @param device The device
+     */
+    void RemoveDevice(Device &device);
+
+    /**
+     * Find a node by its GUID (including removed nodes).
+     *
+     * @return The node or nullptr, if there is none
+     */
+    Device *FindNode(uint64_t guid);
+
+    /**
+     * Find a port of a node by its number (including removed ports).
+     *
+     * @return The port or nullptr, if there is none
+     */
+    Device *FindPort(const Device &node, uint8_t portNum);
+
+    /**
+     * Get the amount of devices (nodes and ports).
+     */
+    uint32_t GetDeviceCount() const {
+        return static_cast<uint32_t>(m_devices.size());
+    }
+
+    Device &GetDevice(uint32_t id) {
+        return m_devices[id];
+    }
+
+    const Device &GetDevice(uint32_t id) const {
+        return m_devices[id];
+    }
+
+    /**
+     * Get the ids of all nodes in the order, in which they have been added.
+     */
+    const std::vector<uint32_t> &GetNodes() const {
+        return m_nodes;
+    }
+
+private:
+
+    std::deque<Device> m_devices;
+    std::vector<uint32_t> m_nodes;
+    std::unordered_map<uint64_t, uint32_t> m_nodeIndex;
+};
+
+}
+
+#endif
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/stat.h>
+#include "Recording.h"
+#include "TopologyCache.h"
+
+namespace Scanner {
+
+static const char CACHE_MAGIC[8] = { 'I', 'B', 'S', 'C', 'T', 'O', 'P', '\0' };
+
+static const uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t deviceSize;
+    uint32_t deviceCount;
+    uint32_t isNetwork;
+};
+
+TopologyCache::TopologyCache(bool network, const char *path) :
+        m_network(network) {
+    if (path != nullptr) {
+        m_path = path;
+        return;
+    }
+
+    const char *cacheHome = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+
+    if (cacheHome != nullptr && *cacheHome != '\0') {
+        m_path = cacheHome;
+    } else if (home != nullptr && *home != '\0') {
+        m_path = std::string(home) + "/.cache";
+    } else {
+        m_path = "/tmp";
+    }
+
+    m_path += network ? "/ib-scanner-network.topology" : "/ib-scanner-local.topology";
+}
+
+bool TopologyCache::Load(Topology &topology) const {
+    FILE *file = fopen(m_path.c_str(), "rb");
+
+    if (file == nullptr) {
+        return false;
+    }
+
+    CacheHeader header{};
+    std::vector<Recording::Device> devices;
+    struct stat fileStatus{};
+
+    bool isValid = fread(&header, sizeof(header), 1, file) == 1 &&
+                   memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+                   header.version == CACHE_VERSION && header.deviceSize == sizeof(Recording::Device) &&
+                   header.isNetwork == (m_network ? 1 : 0) && header.deviceCount > 0;
+
+    // The device count is only trusted, if the file is exactly as large as it claims to be,
+    // so that a corrupt or foreign cache cannot make the table below allocate gigabytes of memory
+    if (isValid) {
+        isValid = fstat(fileno(file), &fileStatus) == 0 &&
+                  static_cast<uint64_t>(fileStatus.st_size) ==
+                  sizeof(CacheHeader) + static_cast<uint64_t>(header.deviceCount) * sizeof(Recording::Device);
+    }
+
+    if (isValid) {
+        devices.resize(header.deviceCount);
+        isValid = fread(devices.data(), sizeof(Recording::Device), devices.size(), file) == devices.size();
+    }
+
+    fclose(file);
+
+    if (!isValid) {
+        return false;
+    }
+
+    // The whole table is checked first, so that a corrupt cache does not leave a partial topology behind
+    for (uint32_t i = 0; i < devices.size(); i++) {
+        const Recording::Device &device = devices[i];
+
+        if (device.portNum != 0xff && (device.nodeId >= i || devices[device.nodeId].portNum != 0xff)) {
+            return false;
+        }
+    }
+
+    for (const Recording::Device &device : devices) {
+        if (device.portNum == 0xff) {
+            topology.AddNode(device.guid, std::string(device.name, strnlen(device.name, sizeof(device.name))),
+                             device.lid);
+        } else {
+            topology.AddPort(device.nodeId, device.lid, device.portNum);
+        }
+    }
+
+    return true;
+}
+
+bool TopologyCache::Save(const Topology &topology) const {
+    std::vector<Recording::Device> devices;
+
+    // Removed devices are left out, so the ids inside the cache differ from the ids inside the topology
+    for (uint32_t nodeId : topology.GetNodes()) {
+        const Device &node = topology.GetDevice(nodeId);
+        auto cacheNodeId = static_cast<uint32_t>(devices.size());
+
+        if (!node.isPresent) {
+            continue;
+        }
+
+        devices.push_back(Recording::Device{node.guid, cacheNodeId, node.lid, node.portNum, 0, {}});
+        strncpy(devices.back().name, node.name.c_str(), sizeof(devices.back().name));
+
+        for (uint32_t portId : node.ports) {
+            const Device &port = topology.GetDevice(portId);
+
+            if (port.isPresent) {
+                devices.push_back(Recording::Device{port.guid, cacheNodeId, port.lid, port.portNum, 0, {}});
+            }
+        }
+    }
+
+    if (devices.empty()) {
+        return false;
+    }
+
+    size_t separator = m_path.rfind('/');
+
+    if (separator != std::string::npos && separator > 0) {
+        // Only the last directory is created, because the parent directories are expected to exist
+        mkdir(m_path.substr(0, separator).c_str(), 0755);
+    }
+
+    std::string tempPath = m_path + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+
+    if (file == nullptr) {
+        return false;
+    }
+
+    CacheHeader header{};
+
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.deviceSize = sizeof(Recording::Device);
+    header.deviceCount = static_cast<uint32_t>(devices.size());
+    header.isNetwork = m_network ? 1 : 0;
+
+    bool isWritten = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                     fwrite(devices.data(), sizeof(Recording::Device), devices.size(), file) == devices.size();
+
+    if (fclose(file) != 0 || !isWritten) {
+        remove(tempPath.c_str());
+
+        return false;
+    }
+
+    return rename(tempPath.c_str(), m_path.c_str()) == 0;
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef IBSCANNER_TOPOLOGYCACHE_H
+#define IBSCANNER_TOPOLOGYCACHE_H
+
+#include <string>
+#include "Topology.h"
+
+namespace Scanner {
+
+/**
+ * Stores the nodes and ports of a scanned fabric on disk, so that the next start does not have to wait for a scan.
+ *
+ * The cache contains the same device table as a recording (see Recording::Device). Devices, that are loaded from the
+ * cache, are not backed by Detector objects; They have to be validated by a rescan.
+ * Local and network scans are cached separately, because they find different devices.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class TopologyCache {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param network true, if the cache holds the result of a network scan; false for a local scan
+     * @param path The cache file's path (nullptr for a file inside $XDG_CACHE_HOME or ~/.cache)
+     */
+    explicit TopologyCache(bool network, const char *path = nullptr);
+
+    /**
+     * Destructor.
+     */
+    ~TopologyCache() = default;
+
+    /**
+     * Add the cached devices to an empty topology.
+     *
+     * @return false, if there is no usable cache; The topology is left empty in this case
+     */
+    bool Load(Topology &topology) const;
+
+    /**
+     * Replace the cache with the devices, that are currently present in a topology.
+     *
+     * The file is replaced atomically, so that an interrupted save never leaves a corrupt cache behind.
+     *
+     * @return false, if the cache could not be written
+     */
+    bool Save(const Topology &topology) const;
+
+    const std::string &GetPath() const {
+        return m_path;
+    }
+
+private:
+
+    bool m_network;
+
+    std::string m_path;
+};
+
+}
+
+#endif
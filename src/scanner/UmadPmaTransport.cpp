@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <cstring>
+#include <stdexcept>
+#include <mad.h>
+#include <umad.h>
+#include "UmadPmaTransport.h"
+
+namespace Scanner {
+
+UmadPmaTransport::UmadPmaTransport(uint32_t timeout) :
+        m_port(nullptr),
+        m_fd(-1),
+        m_agent(-1),
+        m_timeout(timeout),
+        m_sendBuffer(nullptr),
+        m_recvBuffer(nullptr) {
+    int mgmtClasses[] = { IB_PERFORMANCE_CLASS };
+
+    m_port = mad_rpc_open_port(nullptr, 0, mgmtClasses, 1);
+
+    if (m_port == nullptr) {
+        throw std::runtime_error("Unable to open MAD port!");
+    }
+
+    m_fd = mad_rpc_portid(m_port);
+    m_agent = mad_rpc_class_agent(m_port, IB_PERFORMANCE_CLASS);
+
+    m_sendBuffer = umad_alloc(1, umad_size() + IB_MAD_SIZE);
+    m_recvBuffer = umad_alloc(1, umad_size() + IB_MAD_SIZE);
+
+    if (m_agent < 0 || m_sendBuffer == nullptr || m_recvBuffer == nullptr) {
+        umad_free(m_sendBuffer);
+        umad_free(m_recvBuffer);
+        mad_rpc_close_port(m_port);
+
+        throw std::runtime_error("Unable to register performance management agent!");
+    }
+}
+
+UmadPmaTransport::~UmadPmaTransport() {
+    umad_free(m_sendBuffer);
+    umad_free(m_recvBuffer);
+    mad_rpc_close_port(m_port);
+}
+
+bool UmadPmaTransport::Send(uint32_t tid, uint16_t lid, uint8_t portNum, PmaAttribute attribute) {
+    uint8_t data[IB_PC_DATA_SZ] = {};
+    ib_rpc_t rpc{};
+
+    rpc.mgtclass = IB_PERFORMANCE_CLASS;
+    rpc.method = IB_MAD_METHOD_GET;
+    rpc.attr.id = attribute == PORT_COUNTERS_EXTENDED ? IB_GSI_PORT_COUNTERS_EXT : IB_GSI_PORT_COUNTERS;
+    rpc.attr.mod = 0;
+    rpc.timeout = m_timeout;
+    rpc.datasz = IB_PC_DATA_SZ;
+    rpc.dataoffs = IB_PC_DATA_OFFS;
+    rpc.trid = tid;
+
+    mad_set_field(data, 0, attribute == PORT_COUNTERS_EXTENDED ? IB_PC_EXT_PORT_SELECT_F : IB_PC_PORT_SELECT_F,
+                  portNum);
+
+    memset(m_sendBuffer, 0, umad_size() + IB_MAD_SIZE);
+
+    if (mad_encode(umad_get_mad(m_sendBuffer), &rpc, nullptr, data) == nullptr) {
+        return false;
+    }
+
+    umad_set_addr(m_sendBuffer, lid, 1, 0, IB_DEFAULT_QP1_QKEY);
+
+    // The kernel copies the MAD, so the buffer can be reused immediately.
+    // A timeout is required, or else the kernel drops the response, because it does not expect one.
+    return umad_send(m_fd, m_agent, m_sendBuffer, IB_MAD_SIZE, m_timeout, 0) == 0;
+}
+
+bool UmadPmaTransport::Receive(PmaResponse &response, uint32_t timeout) {
+    int length = IB_MAD_SIZE;
+
+    if (umad_recv(m_fd, m_recvBuffer, &length, static_cast<int>(timeout)) < 0) {
+        return false;
+    }
+
+    auto *mad = static_cast<uint8_t*>(umad_get_mad(m_recvBuffer));
+    uint8_t *data = mad + IB_PC_DATA_OFFS;
+
+    // The kernel uses the upper 32 bits of the transaction ID to identify the agent
+    response.tid = static_cast<uint32_t>(mad_get_field64(mad, 0, IB_MAD_TRID_F));
+    response.attribute = mad_get_field(mad, 0, IB_MAD_ATTRID_F) == IB_GSI_PORT_COUNTERS_EXT ?
+            PORT_COUNTERS_EXTENDED : PORT_COUNTERS;
+    response.success = umad_status(m_recvBuffer) == 0 && mad_get_field(mad, 0, IB_MAD_STATUS_F) == 0;
+
+    if (!response.success) {
+        return true;
+    }
+
+    if (response.attribute == PORT_COUNTERS_EXTENDED) {
+        // Data counters are given in octets divided by 4
+        response.values[XMIT_DATA_BYTES] = mad_get_field64(data, 0, IB_PC_EXT_XMT_BYTES_F) * 4;
+        response.values[RCV_DATA_BYTES] = mad_get_field64(data, 0, IB_PC_EXT_RCV_BYTES_F) * 4;
+        response.values[XMIT_PKTS] = mad_get_field64(data, 0, IB_PC_EXT_XMT_PKTS_F);
+        response.values[RCV_PKTS] = mad_get_field64(data, 0, IB_PC_EXT_RCV_PKTS_F);
+        response.values[UNICAST_XMIT_PKTS] = mad_get_field64(data, 0, IB_PC_EXT_XMT_UPKTS_F);
+        response.values[UNICAST_RCV_PKTS] = mad_get_field64(data, 0, IB_PC_EXT_RCV_UPKTS_F);
+        response.values[MULTICAST_XMIT_PKTS] = mad_get_field64(data, 0, IB_PC_EXT_XMT_MPKTS_F);
+        response.values[MULTICAST_RCV_PKTS] = mad_get_field64(data, 0, IB_PC_EXT_RCV_MPKTS_F);
+    } else {
+        response.values[SYMBOL_ERRORS] = mad_get_field(data, 0, IB_PC_ERR_SYM_F);
+        response.values[LINK_DOWNED] = mad_get_field(data, 0, IB_PC_LINK_DOWNED_F);
+        response.values[LINK_RECOVERIES] = mad_get_field(data, 0, IB_PC_LINK_RECOVERS_F);
+        response.values[RCV_ERRORS] = mad_get_field(data, 0, IB_PC_ERR_RCV_F);
+        response.values[RCV_REMOTE_PHYSICAL_ERRORS] = mad_get_field(data, 0, IB_PC_ERR_PHYSRCV_F);
+        response.values[RCV_SWITCH_RELAY_ERRORS] = mad_get_field(data, 0, IB_PC_ERR_SWITCH_REL_F);
+        response.values[XMIT_DISCARDS] = mad_get_field(data, 0, IB_PC_XMT_DISCARDS_F);
+        response.values[XMIT_CONSTRAINT_ERRORS] = mad_get_field(data, 0, IB_PC_ERR_XMTCONSTR_F);
+        response.values[RCV_CONSTRAINT_ERRORS] = mad_get_field(data, 0, IB_PC_ERR_RCVCONSTR_F);
+        response.values[LOCAL_LINK_INTEGRITY_ERRORS] = mad_get_field(data, 0, IB_PC_ERR_LOCALINTEG_F);
+        response.values[EXCESSIVE_BUFFER_OVERRUN_ERRORS] = mad_get_field(data, 0, IB_PC_ERR_EXCESS_OVR_F);
+        response.values[VL15_DROPPED] = mad_get_field(data, 0, IB_PC_VL15_DROPPED_F);
+        response.values[XMIT_WAIT] = mad_get_field(data, 0, IB_PC_XMT_WAIT_F);
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef IBSCANNER_UMADPMATRANSPORT_H
+#define IBSCANNER_UMADPMATRANSPORT_H
+
+#include "PmaTransport.h"
+
+struct ibmad_port;
+
+namespace Scanner {
+
+/**
+ * PmaTransport, which sends MADs directly via libibumad.
+ *
+ * Unlike mad_rpc(), sending does not wait for the response, so that many queries can be outstanding at once.
+ * Requires root privileges (or access to /dev/infiniband/umad*).
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class UmadPmaTransport : public PmaTransport {
+
+public:
+    /**
+     * Constructor.
+     *
+     * Throws std::runtime_error, if the MAD port cannot be opened.
+     *
+     * @param timeout The time in milliseconds, after which the kernel gives up waiting for a response
+     */
+    explicit UmadPmaTransport(uint32_t timeout = 500);
+
+    /**
+     * Destructor.
+     */
+    ~UmadPmaTransport() override;
+
+    /**
+     * Overriding function from PmaTransport.
+     */
+    bool Send(uint32_t tid, uint16_t lid, uint8_t portNum, PmaAttribute attribute) override;
+
+    /**
+     * Overriding function from PmaTransport.
+     */
+    bool Receive(PmaResponse &response, uint32_t timeout) override;
+
+private:
+
+    ibmad_port *m_port;
+
+    int m_fd;
+    int m_agent;
+
+    uint32_t m_timeout;
+
+    void *m_sendBuffer;
+    void *m_recvBuffer;
+};
+
+}
+
+#endif
@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) 2018 Heinrich-Heine-Universitaet Duesseldorf,
+ * Institute of Computer Science, Department Operating Systems
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <curses/benchmark/AllocationCounter.h>
+#include <scanner/CounterDelta.h>
+#include <scanner/MonitorWindow.h>
+#include <scanner/Sampler.h>
+
+/**
+ * Receives the results of measured functions, so that the compiler cannot drop the calls.
+ */
+static volatile size_t resultSink;
+
+namespace Scanner {
+
+/**
+ * IbPerfCounter, which does not query any hardware.
+ *
+ * Refreshing the counters only costs a virtual call, so that the benchmark measures the scanner's own code.
+ */
+class FakePerfCounter : public Detector::IbPerfCounter {
+
+public:
+
+    void ResetCounters() override {
+
+    }
+
+    void RefreshCounters() override {
+        m_refreshCount++;
+    }
+
+private:
+
+    uint64_t m_refreshCount = 0;
+};
+
+/**
+ * Drives the counter-to-screen pipeline of the MonitorWindow for a fabric of fake ports.
+ *
+ * Every refresh of a port consists of three stages:
+ *  - sample: Refresh the fake IbPerfCounter and read it into a CounterSample (like the Sampler does)
+ *  - rate: Calculate the deltas and rates and publish the snapshot (MonitorWindow::OnSample())
+ *  - format: Take the snapshot and rebuild the window's lines from it (MonitorWindow::UpdateItems())
+ *
+ * Each stage depends on fresh results of the previous one (e.g. formatting a snapshot without rates is much cheaper),
+ * so the stages are measured cumulatively: The line of a stage includes the costs of all previous stages.
+ *
+ * Every port has its own window, which is driven through its public interface only. The windows are never drawn,
+ * so ncurses does not need to be initialized and no terminal is needed.
+ *
+ * @author agent, agent@local
+ * @date October 2026
+ */
+class PipelineBenchmark {
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param portCount The amount of fake ports
+     */
+    explicit PipelineBenchmark(uint32_t portCount);
+
+    /**
+     * Destructor.
+     */
+    ~PipelineBenchmark();
+
+    /**
+     * Refresh all ports repeatedly, until the given time has passed, and print the results of every stage.
+     *
+     * @param duration The minimum time in milliseconds, that each stage is measured for
+     */
+    void Run(uint32_t duration);
+
+    /**
+     * Measure MonitorWindow::FormatValue() on its own and print the results.
+     *
+     * @param duration The minimum time in milliseconds
+     */
+    static void RunFormatValue(uint32_t duration);
+
+private:
+    /**
+     * The state of a single fake port.
+     */
+    struct Port {
+        FakePerfCounter perfCounter;
+        CounterSample sample;
+        MonitorWindow *window;
+    };
+
+    /**
+     * Read the counters of a port and let them grow at the port's own rate.
+     *
+     * @param index The port's index
+     */
+    void Sample(uint32_t index);
+
+    /**
+     * Publish the current sample of a port as a new snapshot of the window.
+     *
+     * @param index The port's index
+     */
+    void Rate(uint32_t index);
+
+    /**
+     * Rebuild the lines of a port's window from the snapshot, that has been published last.
+     *
+     * @param index The port's index
+     */
+    void Format(uint32_t index);
+
+    /**
+     * Refresh all ports repeatedly, until the given time has passed, and print the results.
+     *
+     * @param name The name of the last executed stage
+     * @param duration The minimum time in milliseconds
+     * @param stageCount The amount of stages, that are executed for every refresh (1 - 3)
+     */
+    void Measure(const char *name, uint32_t duration, uint8_t stageCount);
+
+    /**
+     * Print a line of results.
+     *
+     * @param portCount The amount of ports
+     * @param name The stage's name
+     * @param refreshCount The amount of executed refreshes
+     * @param elapsed The time needed in nanoseconds
+     * @param allocations The amount of heap allocations
+     */
+    static void PrintResult(uint32_t portCount, const char *name, uint64_t refreshCount, uint64_t elapsed,
+                            uint64_t allocations);
+
+private:
+
+    Sampler m_sampler;
+
+    std::vector<Port> m_ports;
+
+    /**
+     * The simulated time in nanoseconds; Each sweep over all ports advances it by one second, so that the shown
+     * rates are as large as in a real fabric.
+     */
+    uint64_t m_time;
+};
+
+PipelineBenchmark::PipelineBenchmark(uint32_t portCount) :
+        m_sampler(1000),
+        m_ports(portCount),
+        m_time(1000000000) {
+    for (Port &port : m_ports) {
+        memset(&port.sample, 0, sizeof(port.sample));
+        port.window = new MonitorWindow(0, 0, 120, 50, "Benchmark", m_sampler, nullptr);
+    }
+}
+
+PipelineBenchmark::~PipelineBenchmark() {
+    for (Port &port : m_ports) {
+        delete port.window;
+    }
+}
+
+void PipelineBenchmark::Sample(uint32_t index) {
+    Port &port = m_ports[index];
+
+    port.perfCounter.RefreshCounters();
+    port.sample.ReadPerfCounter(port.perfCounter);
+
+    // Every port gets its own constant rate between 1 MB/s and 100 MB/s (like the FakePmaTransport)
+    uint64_t bytes = ((index * 31u) % 100 + 1) * 1000000 * (m_time / 1000000000);
+
+    port.sample.values[XMIT_DATA_BYTES] = bytes;
+    port.sample.values[RCV_DATA_BYTES] = bytes / 2;
+    port.sample.values[XMIT_PKTS] = bytes / 2048;
+    port.sample.values[RCV_PKTS] = bytes / 4096;
+    port.sample.values[UNICAST_XMIT_PKTS] = bytes / 2048;
+    port.sample.values[UNICAST_RCV_PKTS] = bytes / 4096;
+    port.sample.values[XMIT_WAIT] = bytes / 65536;
+    port.sample.timestamp = m_time;
+}
+
+void PipelineBenchmark::Rate(uint32_t index) {
+    m_ports[index].window->OnSample(m_ports[index].sample);
+}
+
+void PipelineBenchmark::Format(uint32_t index) {
+    m_ports[index].window->UpdateItems();
+}
+
+void PipelineBenchmark::Run(uint32_t duration) {
+    // Warm up, so that every port has a previous sample and the rates are calculated in every measured refresh
+    for (uint32_t sweep = 0; sweep < 2; sweep++) {
+        for (uint32_t i = 0; i < m_ports.size(); i++) {
+            Sample(i);
+            Rate(i);
+            Format(i);
+        }
+
+        m_time += 1000000000;
+    }
+
+    Measure("sample", duration, 1);
+    Measure("+rate", duration, 2);
+    Measure("+format", duration, 3);
+}
+
+void PipelineBenchmark::Measure(const char *name, uint32_t duration, uint8_t stageCount) {
+    uint64_t refreshCount = 0;
+    uint64_t allocations = Curses::AllocationCounter::GetAllocationCount();
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::milliseconds(duration);
+
+    // The clock is only read after a whole sweep, so that it does not distort the measurement of small fabrics
+    do {
+        for (uint32_t i = 0; i < m_ports.size(); i++) {
+            Sample(i);
+
+            if (stageCount > 1) {
+                Rate(i);
+            }
+
+            if (stageCount > 2) {
+                Format(i);
+            }
+        }
+
+        m_time += 1000000000;
+        refreshCount += m_ports.size();
+    } while (std::chrono::steady_clock::now() < end);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    PrintResult(static_cast<uint32_t>(m_ports.size()), name, refreshCount, static_cast<uint64_t>(elapsed.count()),
+                Curses::AllocationCounter::GetAllocationCount() - allocations);
+}
+
+void PipelineBenchmark::RunFormatValue(uint32_t duration) {
+    static const uint64_t values[] = { 0, 7, 999, 1234, 56789012, 3500000000000 };
+
+    char buffer[32];
+
+    uint64_t callCount = 0;
+    uint64_t allocations = Curses::AllocationCounter::GetAllocationCount();
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::milliseconds(duration);
+
+    do {
+        for (uint32_t i = 0; i < 1000; i++) {
+            resultSink = MonitorWindow::FormatValue(buffer, sizeof(buffer), values[i % 6], i % 2 * 50, "B/s");
+        }
+
+        callCount += 1000;
+    } while (std::chrono::steady_clock::now() < end);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    PrintResult(1, "FormatValue", callCount, static_cast<uint64_t>(elapsed.count()),
+                Curses::AllocationCounter::GetAllocationCount() - allocations);
+}
+
+void PipelineBenchmark::PrintResult(uint32_t portCount, const char *name, uint64_t refreshCount, uint64_t elapsed,
+                                    uint64_t allocations) {
+    printf("%8u  %-12s %12.1f %14.2f %16.0f\n", portCount, name, static_cast<double>(elapsed) / refreshCount,
+           static_cast<double>(allocations) / refreshCount, refreshCount * 1000000000.0 / elapsed);
+    fflush(stdout);
+}
+
+}
+
+static void printUsage() {
+    printf("Usage: ./pipeline-benchmark [OPTION...]\n"
+           "Available options:\n"
+           "-t, --time\n"
+           "    The minimum time in milliseconds, that each stage is measured for (Default: 1000).\n"
+           "-p, --ports\n"
+           "    Only measure a fabric with the given amount of ports (Default: 1, 100 and 10000 ports).\n"
+           "-h, --help\n"
+           "    Show this help message.\n");
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t duration = 1000;
+    std::vector<uint32_t> portCounts = { 1, 100, 10000 };
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            printUsage();
+
+            exit(EXIT_SUCCESS);
+        }
+
+        if (i + 1 >= argc) {
+            printUsage();
+
+            printf("\n'%s' requires a parameter!\n", argv[i]);
+
+            exit(EXIT_FAILURE);
+        }
+
+        if (!strcmp(argv[i], "-t") || !strcmp(argv[i], "--time")) {
+            duration = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0));
+        } else if (!strcmp(argv[i], "-p") || !strcmp(argv[i], "--ports")) {
+            portCounts = { static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0)) };
+        } else {
+            printUsage();
+
+            printf("\nUnknown option '%s'!\n", argv[i]);
+
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("%8s  %-12s %12s %14s %16s\n", "Ports", "Stage", "ns/refresh", "allocs/refresh", "refreshes/s");
+
+    for (uint32_t portCount : portCounts) {
+        if (portCount > 0) {
+            Scanner::PipelineBenchmark(portCount).Run(duration);
+        }
+    }
+
+    Scanner::PipelineBenchmark::RunFormatValue(duration);
+
+    return EXIT_SUCCESS;
+}